@@ -0,0 +1,309 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "diagnostic_msgs/DiagnosticArray.h"
+#include "std_msgs/Float64.h"
+#include "std_msgs/Header.h"
+#include "std_msgs/String.h"
+#include "std_msgs/UInt8MultiArray.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+
+#include "diagnostic_msgs_factories.hpp"
+#include "std_msgs_factories.hpp"
+
+#include "benchmark_utils.hpp"
+#include "callback_harness.hpp"
+
+// Measure the time the message callbacks of the generic Factory take per message without any
+// middleware, i.e. the overhead of the bridge itself, for representative message types.
+// Every case can also be run alone for long enough to be profiled, e.g. with perf record.
+
+namespace
+{
+
+using ros1_bridge_benchmark::Callback1to2Driver;
+using ros1_bridge_benchmark::Callback2to1Driver;
+using ros1_bridge_benchmark::LatencySamples;
+
+struct Options
+{
+  size_t iterations;
+  size_t warm_up_iterations;
+  size_t size;
+  bool statistics;
+  bool gid_check;
+  std::vector<std::string> cases;
+  std::string csv_path;
+};
+
+struct CaseResult
+{
+  std::string name;
+  std::string direction;
+  uint32_t size;
+  double mean;
+  LatencySamples latencies;
+};
+
+bool
+is_selected(const Options & options, const std::string & name)
+{
+  return options.cases.empty() ||
+         std::find(options.cases.begin(), options.cases.end(), name) != options.cases.end();
+}
+
+/// Call a driver for the warm up and then measure it, in ns per message.
+template<typename DriverT>
+CaseResult
+measure(
+  const std::string & name, const std::string & direction, uint32_t size, DriverT & driver,
+  const Options & options)
+{
+  for (size_t i = 0; i < options.warm_up_iterations; ++i) {
+    driver();
+  }
+
+  CaseResult result;
+  result.name = name;
+  result.direction = direction;
+  result.size = size;
+
+  // the mean is taken over the whole loop, since reading the clock costs as much as the
+  // shortest callbacks
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < options.iterations; ++i) {
+    driver();
+  }
+  result.mean = std::chrono::duration<double, std::nano>(
+    std::chrono::steady_clock::now() - start).count() / options.iterations;
+
+  for (size_t i = 0; i < options.iterations; ++i) {
+    auto call_start = std::chrono::steady_clock::now();
+    driver();
+    result.latencies.add(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - call_start).count());
+  }
+
+  if (driver.get_published() != options.warm_up_iterations + 2 * options.iterations) {
+    throw std::runtime_error("not every message of '" + name + "' was published");
+  }
+  return result;
+}
+
+template<typename ROS1_T, typename ROS2_T>
+void
+run_case(
+  const std::string & name, const ROS1_T & ros1_msg, const ROS2_T & ros2_msg,
+  const Options & options, rclcpp::PublisherBase::SharedPtr ros2_pub,
+  std::vector<CaseResult> & results)
+{
+  if (!is_selected(options, name)) {
+    return;
+  }
+  uint32_t size = ros::serialization::serializationLength(ros1_msg);
+  std::string topic_name = "/benchmark/" + name;
+  std::string type_name = ros::message_traits::datatype<ROS1_T>();
+
+  std::shared_ptr<ros1_bridge::TopicStatistics> statistics_1to2;
+  std::shared_ptr<ros1_bridge::TopicStatistics> statistics_2to1;
+  if (options.statistics) {
+    statistics_1to2 = std::make_shared<ros1_bridge::TopicStatistics>(
+      "1to2", topic_name, type_name);
+    statistics_2to1 = std::make_shared<ros1_bridge::TopicStatistics>(
+      "2to1", topic_name, type_name);
+  }
+
+  Callback1to2Driver<ROS1_T, ROS2_T> driver_1to2(ros1_msg, statistics_1to2);
+  results.push_back(measure(name, "1to2", size, driver_1to2, options));
+  Callback2to1Driver<ROS1_T, ROS2_T> driver_2to1(ros2_msg, statistics_2to1, ros2_pub);
+  results.push_back(measure(name, "2to1", size, driver_2to1, options));
+}
+
+void
+print_results(std::vector<CaseResult> & results, const Options & options)
+{
+  printf(
+    "%zu iterations, statistics %s, GID check %s\n\n", options.iterations,
+    options.statistics ? "on" : "off", options.gid_check ? "on" : "off");
+  printf(
+    "%-12s %-9s %9s %9s %9s %9s %9s %9s\n",
+    "case", "direction", "bytes", "mean ns", "p50 ns", "p99 ns", "p99.9 ns", "max ns");
+  for (auto & result : results) {
+    printf(
+      "%-12s %-9s %9u %9.1f %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 "\n",
+      result.name.c_str(), result.direction.c_str(), result.size, result.mean,
+      result.latencies.get_percentile(0.5), result.latencies.get_percentile(0.99),
+      result.latencies.get_percentile(0.999), result.latencies.get_max());
+  }
+
+  if (options.csv_path.empty()) {
+    return;
+  }
+  FILE * csv = fopen(options.csv_path.c_str(), "w");
+  if (!csv) {
+    fprintf(stderr, "failed to open '%s'\n", options.csv_path.c_str());
+    return;
+  }
+  fprintf(csv, "case,direction,size_bytes,statistics,gid_check,mean_ns,p50_ns,p99_ns,max_ns\n");
+  for (auto & result : results) {
+    fprintf(
+      csv, "%s,%s,%u,%d,%d,%.1f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+      result.name.c_str(), result.direction.c_str(), result.size, options.statistics,
+      options.gid_check, result.mean, result.latencies.get_percentile(0.5),
+      result.latencies.get_percentile(0.99), result.latencies.get_max());
+  }
+  fclose(csv);
+}
+
+bool
+parse_command_options(int argc, char ** argv, Options & options)
+{
+  using ros1_bridge_benchmark::find_command_option;
+  using ros1_bridge_benchmark::get_command_option_value;
+  std::vector<std::string> args(argv, argv + argc);
+
+  if (find_command_option(args, "-h") || find_command_option(args, "--help")) {
+    std::stringstream ss;
+    ss << "Usage:" << std::endl;
+    ss << " -h, --help: This message." << std::endl;
+    ss << " --iterations <n>: Measured messages per case and direction (default: 100000)";
+    ss << std::endl;
+    ss << " --warm-up-iterations <n>: Messages before measuring (default: 1000)" << std::endl;
+    ss << " --size <bytes>: Size of the strings and arrays (default: 256)" << std::endl;
+    ss << " --cases <list>: Comma separated cases to run out of float64, string, header, ";
+    ss << "bytes and diagnostics (default: all)" << std::endl;
+    ss << " --no-statistics: Pass no statistics to the callbacks" << std::endl;
+    ss << " --no-gid-check: Pass no ROS 2 publisher to compare the GID of the messages ";
+    ss << "with, which doesn't initialize ROS 2 at all" << std::endl;
+    ss << " --csv <file>: Also write the results to a CSV file" << std::endl;
+    std::cout << ss.str();
+    return false;
+  }
+
+  options.iterations = std::stoul(get_command_option_value(args, "--iterations", "100000"));
+  options.warm_up_iterations = std::stoul(
+    get_command_option_value(args, "--warm-up-iterations", "1000"));
+  options.size = std::stoul(get_command_option_value(args, "--size", "256"));
+  options.statistics = !find_command_option(args, "--no-statistics");
+  options.gid_check = !find_command_option(args, "--no-gid-check");
+  options.csv_path = get_command_option_value(args, "--csv", "");
+
+  std::stringstream cases(get_command_option_value(args, "--cases", ""));
+  std::string name;
+  while (std::getline(cases, name, ',')) {
+    options.cases.push_back(name);
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  Options options;
+  if (!parse_command_options(argc, argv, options)) {
+    return 0;
+  }
+
+  // the publisher only provides the GID to compare with, nothing is published
+  rclcpp::Node::SharedPtr ros2_node;
+  rclcpp::PublisherBase::SharedPtr ros2_pub;
+  if (options.gid_check) {
+    rclcpp::init(argc, argv);
+    ros2_node = rclcpp::Node::make_shared("benchmark_callbacks");
+    ros2_pub = ros2_node->create_publisher<std_msgs::msg::String>("benchmark_callbacks_gid");
+  }
+
+  const std::string payload(options.size, 'x');
+  std::vector<CaseResult> results;
+  try {
+    {
+      std_msgs::Float64 ros1_msg;
+      std_msgs::msg::Float64 ros2_msg;
+      ros1_msg.data = ros2_msg.data = 1.0;
+      run_case("float64", ros1_msg, ros2_msg, options, ros2_pub, results);
+    }
+    {
+      std_msgs::String ros1_msg;
+      std_msgs::msg::String ros2_msg;
+      ros1_msg.data = ros2_msg.data = payload;
+      run_case("string", ros1_msg, ros2_msg, options, ros2_pub, results);
+    }
+    {
+      std_msgs::Header ros1_msg;
+      std_msgs::msg::Header ros2_msg;
+      ros1_msg.stamp.sec = ros2_msg.stamp.sec = 1;
+      ros1_msg.frame_id = ros2_msg.frame_id = payload;
+      run_case("header", ros1_msg, ros2_msg, options, ros2_pub, results);
+    }
+    {
+      std_msgs::UInt8MultiArray ros1_msg;
+      std_msgs::msg::UInt8MultiArray ros2_msg;
+      ros1_msg.data.assign(options.size, 42);
+      ros2_msg.data.assign(options.size, 42);
+      run_case("bytes", ros1_msg, ros2_msg, options, ros2_pub, results);
+    }
+    {
+      // nested arrays of messages with many short strings
+      diagnostic_msgs::DiagnosticArray ros1_msg;
+      diagnostic_msgs::msg::DiagnosticArray ros2_msg;
+      ros1_msg.status.resize(4);
+      ros2_msg.status.resize(4);
+      for (size_t i = 0; i < 4; ++i) {
+        ros1_msg.status[i].name = ros2_msg.status[i].name = "status " + std::to_string(i);
+        ros1_msg.status[i].values.resize(8);
+        ros2_msg.status[i].values.resize(8);
+        for (size_t j = 0; j < 8; ++j) {
+          ros1_msg.status[i].values[j].key = ros2_msg.status[i].values[j].key =
+            "key " + std::to_string(j);
+          ros1_msg.status[i].values[j].value = ros2_msg.status[i].values[j].value =
+            std::to_string(i * j);
+        }
+      }
+      run_case("diagnostics", ros1_msg, ros2_msg, options, ros2_pub, results);
+    }
+  } catch (const std::exception & e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  print_results(results, options);
+
+  if (options.gid_check) {
+    ros2_pub.reset();
+    ros2_node.reset();
+    rclcpp::shutdown();
+  }
+  return 0;
+}
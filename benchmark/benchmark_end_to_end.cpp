@@ -0,0 +1,605 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "ros/ros.h"
+#include "std_msgs/Header.h"
+#include "std_msgs/String.h"
+#include "std_msgs/UInt8MultiArray.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+#include "std_msgs/msg/header.hpp"
+#include "std_msgs/msg/string.hpp"
+#include "std_msgs/msg/u_int8_multi_array.hpp"
+
+#include "ros1_bridge/bridge.hpp"
+
+#include "benchmark_utils.hpp"
+
+// Measure the throughput and the latency of messages passing the bridge.
+// A roscore and the bridge run in child processes, the benchmark publishes timestamped
+// messages at a fixed rate into one side and receives them on the other side, so the
+// measured latency includes the transports of both middlewares like in a real deployment.
+// The round trip passes a message from ROS 1 to ROS 2, where the benchmark echoes it back.
+
+namespace
+{
+
+using ros1_bridge_benchmark::LatencySamples;
+using ros1_bridge_benchmark::get_steady_time;
+
+const char * const topic_1to2 = "benchmark_1to2";
+const char * const topic_2to1 = "benchmark_2to1";
+const char * const topic_roundtrip_out = "benchmark_roundtrip_out";
+const char * const topic_roundtrip_back = "benchmark_roundtrip_back";
+
+struct Options
+{
+  std::string type;
+  std::string type_name;
+  size_t size;
+  double rate;
+  double duration;
+  double warm_up;
+  size_t queue_size;
+  uint16_t master_port;
+  bool use_running_master;
+  std::vector<std::string> paths;
+  std::string csv_path;
+};
+
+// the stamp is the time of the steady clock when the message was published in ns
+
+// a fixed width number at the start of the string, padded to the requested size
+constexpr size_t stamp_digits = 20;
+
+void
+set_string_stamp(std::string & data, uint64_t stamp, size_t size)
+{
+  char buffer[stamp_digits + 1];
+  snprintf(buffer, sizeof(buffer), "%020" PRIu64, stamp);
+  data.assign(buffer, stamp_digits);
+  if (size > stamp_digits) {
+    data.resize(size, 'x');
+  }
+}
+
+uint64_t
+get_string_stamp(const std::string & data)
+{
+  return strtoull(data.substr(0, stamp_digits).c_str(), nullptr, 10);
+}
+
+void
+set_stamp(std_msgs::String & msg, uint64_t stamp, size_t size)
+{
+  set_string_stamp(msg.data, stamp, size);
+}
+
+void
+set_stamp(std_msgs::msg::String & msg, uint64_t stamp, size_t size)
+{
+  set_string_stamp(msg.data, stamp, size);
+}
+
+uint64_t
+get_stamp(const std_msgs::String & msg)
+{
+  return get_string_stamp(msg.data);
+}
+
+uint64_t
+get_stamp(const std_msgs::msg::String & msg)
+{
+  return get_string_stamp(msg.data);
+}
+
+// the stamp of the header and a frame id of the requested size
+void
+set_stamp(std_msgs::Header & msg, uint64_t stamp, size_t size)
+{
+  msg.stamp.sec = static_cast<uint32_t>(stamp / 1000000000);
+  msg.stamp.nsec = static_cast<uint32_t>(stamp % 1000000000);
+  msg.frame_id.resize(size, 'x');
+}
+
+void
+set_stamp(std_msgs::msg::Header & msg, uint64_t stamp, size_t size)
+{
+  msg.stamp.sec = static_cast<int32_t>(stamp / 1000000000);
+  msg.stamp.nanosec = static_cast<uint32_t>(stamp % 1000000000);
+  msg.frame_id.resize(size, 'x');
+}
+
+uint64_t
+get_stamp(const std_msgs::Header & msg)
+{
+  return static_cast<uint64_t>(msg.stamp.sec) * 1000000000 + msg.stamp.nsec;
+}
+
+uint64_t
+get_stamp(const std_msgs::msg::Header & msg)
+{
+  return static_cast<uint64_t>(msg.stamp.sec) * 1000000000 + msg.stamp.nanosec;
+}
+
+// the first bytes of the array, which has the requested size
+void
+set_bytes_stamp(std::vector<uint8_t> & data, uint64_t stamp, size_t size)
+{
+  data.resize(size > sizeof(stamp) ? size : sizeof(stamp));
+  memcpy(data.data(), &stamp, sizeof(stamp));
+}
+
+uint64_t
+get_bytes_stamp(const std::vector<uint8_t> & data)
+{
+  uint64_t stamp = 0;
+  if (data.size() >= sizeof(stamp)) {
+    memcpy(&stamp, data.data(), sizeof(stamp));
+  }
+  return stamp;
+}
+
+void
+set_stamp(std_msgs::UInt8MultiArray & msg, uint64_t stamp, size_t size)
+{
+  set_bytes_stamp(msg.data, stamp, size);
+}
+
+void
+set_stamp(std_msgs::msg::UInt8MultiArray & msg, uint64_t stamp, size_t size)
+{
+  set_bytes_stamp(msg.data, stamp, size);
+}
+
+uint64_t
+get_stamp(const std_msgs::UInt8MultiArray & msg)
+{
+  return get_bytes_stamp(msg.data);
+}
+
+uint64_t
+get_stamp(const std_msgs::msg::UInt8MultiArray & msg)
+{
+  return get_bytes_stamp(msg.data);
+}
+
+/// The messages received on one path, only the ones published while measuring are counted.
+class PathReceiver
+{
+public:
+  void
+  receive(uint64_t stamp)
+  {
+    uint64_t now = get_steady_time();
+    received_any_.store(true);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stamp >= measure_start_ && stamp < measure_end_) {
+      latencies_.add(now - stamp);
+    }
+  }
+
+  bool
+  received_any() const
+  {
+    return received_any_.load();
+  }
+
+  void
+  start_measurement(uint64_t start)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    latencies_.clear();
+    measure_start_ = start;
+    measure_end_ = UINT64_MAX;
+  }
+
+  void
+  end_measurement(uint64_t end)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    measure_end_ = end;
+  }
+
+  LatencySamples
+  get_latencies()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latencies_;
+  }
+
+private:
+  std::atomic<bool> received_any_ {false};
+  std::mutex mutex_;
+  uint64_t measure_start_ = UINT64_MAX;
+  uint64_t measure_end_ = UINT64_MAX;
+  LatencySamples latencies_;
+};
+
+struct PathResult
+{
+  std::string path;
+  uint64_t sent;
+  double duration;
+  LatencySamples latencies;
+};
+
+/// Publish at the requested rate into a path until it delivers, then warm up and measure it.
+PathResult
+measure_path(
+  const std::string & path, const std::function<void(uint64_t)> & publish,
+  PathReceiver & receiver, const Options & options)
+{
+  // the bridge and the middlewares need a while to discover each other
+  auto connect_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (!receiver.received_any()) {
+    if (std::chrono::steady_clock::now() > connect_deadline || !rclcpp::ok() || !ros::ok()) {
+      throw std::runtime_error("no message passed the bridge on path " + path);
+    }
+    publish(get_steady_time());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  auto period = std::chrono::nanoseconds(
+    options.rate > 0 ? static_cast<int64_t>(1e9 / options.rate) : 0);
+  auto publish_until = [&](std::chrono::steady_clock::time_point end) -> uint64_t
+    {
+      uint64_t sent = 0;
+      auto next = std::chrono::steady_clock::now();
+      while (next < end && rclcpp::ok() && ros::ok()) {
+        publish(get_steady_time());
+        ++sent;
+        if (period.count() > 0) {
+          next += period;
+          std::this_thread::sleep_until(next);
+        } else {
+          next = std::chrono::steady_clock::now();
+        }
+      }
+      return sent;
+    };
+
+  publish_until(
+    std::chrono::steady_clock::now() +
+    std::chrono::nanoseconds(static_cast<int64_t>(options.warm_up * 1e9)));
+
+  PathResult result;
+  result.path = path;
+  auto start = std::chrono::steady_clock::now();
+  receiver.start_measurement(get_steady_time());
+  result.sent = publish_until(
+    start + std::chrono::nanoseconds(static_cast<int64_t>(options.duration * 1e9)));
+  receiver.end_measurement(get_steady_time());
+  result.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // let the messages still in flight arrive
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  result.latencies = receiver.get_latencies();
+  return result;
+}
+
+void
+print_results(
+  std::vector<PathResult> & results, uint32_t message_size, const Options & options)
+{
+  printf(
+    "type: %s, serialized size: %u bytes, rate: %.1f Hz, duration: %.1f s\n\n",
+    options.type_name.c_str(), message_size, options.rate, options.duration);
+  printf(
+    "%-10s %9s %9s %7s %10s %8s %9s %9s %9s %9s %9s\n",
+    "path", "sent", "received", "lost %", "msg/s", "MB/s",
+    "p50 us", "p90 us", "p99 us", "p99.9 us", "max us");
+  for (auto & result : results) {
+    size_t received = result.latencies.size();
+    double lost = result.sent ? 100.0 * (result.sent - std::min<uint64_t>(
+        received, result.sent)) / result.sent : 0.0;
+    double throughput = received / result.duration;
+    printf(
+      "%-10s %9" PRIu64 " %9zu %7.2f %10.1f %8.3f %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+      result.path.c_str(), result.sent, received, lost, throughput,
+      throughput * message_size / 1e6,
+      result.latencies.get_percentile(0.5) / 1e3, result.latencies.get_percentile(0.9) / 1e3,
+      result.latencies.get_percentile(0.99) / 1e3, result.latencies.get_percentile(0.999) / 1e3,
+      result.latencies.get_max() / 1e3);
+  }
+
+  if (options.csv_path.empty()) {
+    return;
+  }
+  FILE * csv = fopen(options.csv_path.c_str(), "w");
+  if (!csv) {
+    fprintf(stderr, "failed to open '%s'\n", options.csv_path.c_str());
+    return;
+  }
+  fprintf(
+    csv, "path,type,size_bytes,rate_hz,sent,received,throughput_msgs,"
+    "p50_us,p90_us,p99_us,p999_us,max_us,mean_us\n");
+  for (auto & result : results) {
+    fprintf(
+      csv, "%s,%s,%u,%.1f,%" PRIu64 ",%zu,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+      result.path.c_str(), options.type_name.c_str(), message_size, options.rate,
+      result.sent, result.latencies.size(), result.latencies.size() / result.duration,
+      result.latencies.get_percentile(0.5) / 1e3, result.latencies.get_percentile(0.9) / 1e3,
+      result.latencies.get_percentile(0.99) / 1e3, result.latencies.get_percentile(0.999) / 1e3,
+      result.latencies.get_max() / 1e3, result.latencies.get_mean() / 1e3);
+  }
+  fclose(csv);
+}
+
+/// Run the real bridges of the benchmarked topics until interrupted.
+int
+run_bridge(int argc, char * argv[], const Options & options)
+{
+  ros::init(argc, argv, "benchmark_bridge");
+  ros::NodeHandle ros1_node;
+
+  rclcpp::init(argc, argv);
+  auto ros2_node = rclcpp::Node::make_shared("benchmark_bridge");
+
+  const std::string & type_name = options.type_name;
+  size_t queue_size = options.queue_size;
+  std::vector<ros1_bridge::Bridge1to2Handles> bridges_1to2;
+  std::vector<ros1_bridge::Bridge2to1Handles> bridges_2to1;
+  for (const char * topic_name : {topic_1to2, topic_roundtrip_out}) {
+    bridges_1to2.push_back(
+      ros1_bridge::create_bridge_from_1_to_2(
+        ros1_node, ros2_node, type_name, topic_name, queue_size,
+        type_name, topic_name, queue_size));
+  }
+  for (const char * topic_name : {topic_2to1, topic_roundtrip_back}) {
+    bridges_2to1.push_back(
+      ros1_bridge::create_bridge_from_2_to_1(
+        ros2_node, ros1_node, type_name, topic_name, queue_size,
+        type_name, topic_name, queue_size));
+  }
+
+  ros::AsyncSpinner async_spinner(1);
+  async_spinner.start();
+  rclcpp::spin(ros2_node);
+  ros::shutdown();
+  return 0;
+}
+
+/// Publish and receive the messages of all paths and report the results.
+template<typename ROS1_T, typename ROS2_T>
+int
+run_endpoints(int argc, char * argv[], const Options & options)
+{
+  ros::init(argc, argv, "benchmark_endpoints");
+  ros::NodeHandle ros1_node;
+
+  rclcpp::init(argc, argv);
+  auto ros2_node = rclcpp::Node::make_shared("benchmark_endpoints");
+  // the same QoS as the bridge uses
+  rmw_qos_profile_t qos = rmw_qos_profile_sensor_data;
+  qos.depth = options.queue_size;
+
+  using ROS1ConstPtr = boost::shared_ptr<ROS1_T const>;
+  using ROS2Callback = std::function<void(const typename ROS2_T::SharedPtr)>;
+  uint32_t queue_size = static_cast<uint32_t>(options.queue_size);
+
+  // 1to2: ROS 1 publisher -> bridge -> ROS 2 subscriber
+  PathReceiver receiver_1to2;
+  auto ros1_pub_1to2 = ros1_node.advertise<ROS1_T>(topic_1to2, queue_size);
+  ROS2Callback callback_1to2 = [&receiver_1to2](const typename ROS2_T::SharedPtr msg)
+    {
+      receiver_1to2.receive(get_stamp(*msg));
+    };
+  auto ros2_sub_1to2 = ros2_node->create_subscription<ROS2_T>(topic_1to2, callback_1to2, qos);
+
+  // 2to1: ROS 2 publisher -> bridge -> ROS 1 subscriber
+  PathReceiver receiver_2to1;
+  auto ros2_pub_2to1 = ros2_node->create_publisher<ROS2_T>(topic_2to1, qos);
+  auto ros1_sub_2to1 = ros1_node.subscribe<ROS1_T>(
+    topic_2to1, queue_size, boost::function<void(const ROS1ConstPtr &)>(
+      [&receiver_2to1](const ROS1ConstPtr & msg)
+      {
+        receiver_2to1.receive(get_stamp(*msg));
+      }));
+
+  // round trip: ROS 1 publisher -> bridge -> ROS 2 echo -> bridge -> ROS 1 subscriber
+  PathReceiver receiver_roundtrip;
+  auto ros1_pub_roundtrip = ros1_node.advertise<ROS1_T>(topic_roundtrip_out, queue_size);
+  auto ros2_pub_roundtrip = ros2_node->create_publisher<ROS2_T>(topic_roundtrip_back, qos);
+  ROS2Callback echo_callback = [&ros2_pub_roundtrip](const typename ROS2_T::SharedPtr msg)
+    {
+      ros2_pub_roundtrip->publish(*msg);
+    };
+  auto ros2_sub_roundtrip = ros2_node->create_subscription<ROS2_T>(
+    topic_roundtrip_out, echo_callback, qos);
+  auto ros1_sub_roundtrip = ros1_node.subscribe<ROS1_T>(
+    topic_roundtrip_back, queue_size, boost::function<void(const ROS1ConstPtr &)>(
+      [&receiver_roundtrip](const ROS1ConstPtr & msg)
+      {
+        receiver_roundtrip.receive(get_stamp(*msg));
+      }));
+
+  ros::AsyncSpinner async_spinner(1);
+  async_spinner.start();
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(ros2_node);
+  std::thread ros2_spin_thread([&executor]() {executor.spin();});
+
+  ROS1_T ros1_msg;
+  ROS2_T ros2_msg;
+  set_stamp(ros1_msg, 0, options.size);
+  uint32_t message_size = ros::serialization::serializationLength(ros1_msg);
+
+  std::vector<PathResult> results;
+  int exit_code = 0;
+  try {
+    for (const auto & path : options.paths) {
+      std::function<void(uint64_t)> publish;
+      PathReceiver * receiver;
+      if (path == "1to2") {
+        publish = [&](uint64_t stamp) -> void
+          {
+            set_stamp(ros1_msg, stamp, options.size);
+            ros1_pub_1to2.publish(ros1_msg);
+          };
+        receiver = &receiver_1to2;
+      } else if (path == "2to1") {
+        publish = [&](uint64_t stamp) -> void
+          {
+            set_stamp(ros2_msg, stamp, options.size);
+            ros2_pub_2to1->publish(ros2_msg);
+          };
+        receiver = &receiver_2to1;
+      } else if (path == "roundtrip") {
+        publish = [&](uint64_t stamp) -> void
+          {
+            set_stamp(ros1_msg, stamp, options.size);
+            ros1_pub_roundtrip.publish(ros1_msg);
+          };
+        receiver = &receiver_roundtrip;
+      } else {
+        throw std::runtime_error("unknown path '" + path + "'");
+      }
+      results.push_back(measure_path(path, publish, *receiver, options));
+    }
+    print_results(results, message_size, options);
+  } catch (const std::exception & e) {
+    fprintf(stderr, "%s\n", e.what());
+    exit_code = 1;
+  }
+
+  rclcpp::shutdown();
+  ros2_spin_thread.join();
+  ros::shutdown();
+  return exit_code;
+}
+
+bool
+parse_command_options(int argc, char ** argv, Options & options)
+{
+  using ros1_bridge_benchmark::find_command_option;
+  using ros1_bridge_benchmark::get_command_option_value;
+  std::vector<std::string> args(argv, argv + argc);
+
+  if (find_command_option(args, "-h") || find_command_option(args, "--help")) {
+    std::stringstream ss;
+    ss << "Usage:" << std::endl;
+    ss << " -h, --help: This message." << std::endl;
+    ss << " --type <string|header|bytes>: Bridged message type, std_msgs/String, ";
+    ss << "std_msgs/Header or std_msgs/UInt8MultiArray (default: string)" << std::endl;
+    ss << " --size <bytes>: Size of the string, frame id or array (default: 256)" << std::endl;
+    ss << " --rate <hz>: Published messages per second, 0 for as fast as possible ";
+    ss << "(default: 1000)" << std::endl;
+    ss << " --duration <s>: Measured time per path (default: 10)" << std::endl;
+    ss << " --warm-up <s>: Time per path before measuring (default: 2)" << std::endl;
+    ss << " --queue-size <n>: Queue size of all publishers and subscribers ";
+    ss << "(default: 100)" << std::endl;
+    ss << " --paths <list>: Comma separated paths to measure ";
+    ss << "(default: 1to2,2to1,roundtrip)" << std::endl;
+    ss << " --master-port <port>: Port of the roscore started for the benchmark ";
+    ss << "(default: 11511)" << std::endl;
+    ss << " --use-running-master: Use the master of ROS_MASTER_URI instead of starting a ";
+    ss << "roscore" << std::endl;
+    ss << " --csv <file>: Also write the results to a CSV file" << std::endl;
+    std::cout << ss.str();
+    return false;
+  }
+
+  options.type = get_command_option_value(args, "--type", "string");
+  if (options.type == "string") {
+    options.type_name = "std_msgs/String";
+  } else if (options.type == "header") {
+    options.type_name = "std_msgs/Header";
+  } else if (options.type == "bytes") {
+    options.type_name = "std_msgs/UInt8MultiArray";
+  } else {
+    throw std::runtime_error("unknown message type '" + options.type + "'");
+  }
+  options.size = std::stoul(get_command_option_value(args, "--size", "256"));
+  options.rate = std::stod(get_command_option_value(args, "--rate", "1000"));
+  options.duration = std::stod(get_command_option_value(args, "--duration", "10"));
+  options.warm_up = std::stod(get_command_option_value(args, "--warm-up", "2"));
+  options.queue_size = std::stoul(get_command_option_value(args, "--queue-size", "100"));
+  options.master_port = static_cast<uint16_t>(
+    std::stoul(get_command_option_value(args, "--master-port", "11511")));
+  options.use_running_master = find_command_option(args, "--use-running-master");
+  options.csv_path = get_command_option_value(args, "--csv", "");
+
+  std::stringstream paths(get_command_option_value(args, "--paths", "1to2,2to1,roundtrip"));
+  std::string path;
+  while (std::getline(paths, path, ',')) {
+    options.paths.push_back(path);
+  }
+  return true;
+}
+
+template<typename ROS1_T, typename ROS2_T>
+int
+run(int argc, char * argv[], const Options & options)
+{
+  ros1_bridge_benchmark::ChildProcess roscore;
+  if (!options.use_running_master) {
+    roscore = ros1_bridge_benchmark::start_roscore(options.master_port);
+  }
+  // fork the bridge before any thread is started in this process
+  auto bridge = ros1_bridge_benchmark::ChildProcess::fork_function(
+    [argc, argv, &options]() -> int
+    {
+      return run_bridge(argc, argv, options);
+    });
+  int exit_code = run_endpoints<ROS1_T, ROS2_T>(argc, argv, options);
+  bridge.stop();
+  return exit_code;
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  Options options;
+  try {
+    if (!parse_command_options(argc, argv, options)) {
+      return 0;
+    }
+    if (options.type == "header") {
+      return run<std_msgs::Header, std_msgs::msg::Header>(argc, argv, options);
+    }
+    if (options.type == "bytes") {
+      return run<std_msgs::UInt8MultiArray, std_msgs::msg::UInt8MultiArray>(
+        argc, argv, options);
+    }
+    return run<std_msgs::String, std_msgs::msg::String>(argc, argv, options);
+  } catch (const std::exception & e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,339 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/make_shared.hpp>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "ros/message_event.h"
+#include "std_msgs/String.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+#include "std_msgs/msg/string.hpp"
+
+#include "std_msgs_factories.hpp"
+
+#include "benchmark_utils.hpp"
+#include "callback_harness.hpp"
+#include "simple_bridge.hpp"
+
+// Compare the callbacks of the hand-written std_msgs/String bridges in src/simple_bridge.hpp
+// with the callbacks of the generic Factory for the same types, without any middleware.
+// The difference is the overhead per message of the generic machinery: the lookup of the
+// connection header, the GID compare, the tracepoints, the phase timing, the memory accounting
+// and, unless disabled, the statistics.
+// Appending the results to a history file tracks the gap over time, e.g. once per commit.
+
+namespace
+{
+
+using ros1_bridge_benchmark::Callback1to2Driver;
+using ros1_bridge_benchmark::Callback2to1Driver;
+using ros1_bridge_benchmark::CountingRos1Publisher;
+using ros1_bridge_benchmark::CountingRos2Publisher;
+
+struct Options
+{
+  size_t iterations;
+  size_t repetitions;
+  std::vector<size_t> sizes;
+  bool gid_check;
+  std::string history_path;
+  std::string label;
+};
+
+/// The ROS 1 callback of simple_bridge, which skips the messages it published itself.
+class SimpleBridge1to2
+{
+public:
+  SimpleBridge1to2(const std_msgs::String & ros1_msg, bool check_caller)
+  : check_caller_(check_caller)
+  {
+    // the same connection header as the generic callback gets
+    auto connection_header = boost::make_shared<ros::M_string>();
+    (*connection_header)["callerid"] = "/benchmark_talker";
+    (*connection_header)["topic"] = "/benchmark";
+    (*connection_header)["type"] = "std_msgs/String";
+    event_ = ros::MessageEvent<std_msgs::String const>(
+      boost::make_shared<std_msgs::String const>(ros1_msg), connection_header, ros::Time());
+  }
+
+  void operator()()
+  {
+    if (check_caller_) {
+      const std::string * callerid = simple_bridge::get_callerid(event_);
+      if (callerid && *callerid == simple_bridge::bridge_callerid) {
+        return;
+      }
+    }
+
+    const boost::shared_ptr<std_msgs::String const> & ros1_msg = event_.getConstMessage();
+    ros2_pub_.publish(simple_bridge::convert_1_to_2(*ros1_msg));
+  }
+
+  size_t get_published() const
+  {
+    return ros2_pub_.count;
+  }
+
+private:
+  bool check_caller_;
+  ros::MessageEvent<std_msgs::String const> event_;
+  CountingRos2Publisher<std_msgs::msg::String> ros2_pub_;
+};
+
+/// The ROS 2 callback of simple_bridge and simple_bridge_2_to_1, which are the same.
+class SimpleBridge2to1
+{
+public:
+  explicit SimpleBridge2to1(const std_msgs::msg::String & ros2_msg)
+  : ros2_msg_(std::make_shared<std_msgs::msg::String>(ros2_msg))
+  {}
+
+  void operator()()
+  {
+    std_msgs::String ros1_msg;
+    simple_bridge::convert_2_to_1(*ros2_msg_, ros1_msg);
+    ros1_pub_.publish(ros1_msg);
+  }
+
+  size_t get_published() const
+  {
+    return ros1_pub_.count;
+  }
+
+private:
+  std_msgs::msg::String::SharedPtr ros2_msg_;
+  CountingRos1Publisher<std_msgs::String> ros1_pub_;
+};
+
+/// Get the mean time per message in ns, the fastest of the repetitions to reduce the noise.
+template<typename DriverT>
+double
+measure(DriverT & driver, const Options & options)
+{
+  size_t warm_up_iterations = options.iterations / 10;
+  for (size_t i = 0; i < warm_up_iterations; ++i) {
+    driver();
+  }
+
+  double fastest = 0.0;
+  for (size_t repetition = 0; repetition < options.repetitions; ++repetition) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < options.iterations; ++i) {
+      driver();
+    }
+    double mean = std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - start).count() / options.iterations;
+    fastest = repetition == 0 ? mean : std::min(fastest, mean);
+  }
+  if (driver.get_published() != warm_up_iterations + options.repetitions * options.iterations) {
+    throw std::runtime_error("not every message was published");
+  }
+  return fastest;
+}
+
+struct Comparison
+{
+  std::string baseline;
+  std::string direction;
+  size_t size;
+  double handwritten;
+  double generic;
+  double generic_with_statistics;
+};
+
+void
+print_comparisons(const std::vector<Comparison> & comparisons, const Options & options)
+{
+  printf(
+    "%zu iterations, fastest of %zu repetitions, GID check %s\n\n", options.iterations,
+    options.repetitions, options.gid_check ? "on" : "off");
+  printf(
+    "%-22s %-9s %7s %15s %11s %19s %12s %19s\n", "baseline", "direction", "bytes",
+    "hand-written ns", "generic ns", "with statistics ns", "overhead ns", "overhead stats ns");
+  for (const auto & comparison : comparisons) {
+    printf(
+      "%-22s %-9s %7zu %15.1f %11.1f %19.1f %12.1f %19.1f\n", comparison.baseline.c_str(),
+      comparison.direction.c_str(), comparison.size, comparison.handwritten, comparison.generic,
+      comparison.generic_with_statistics, comparison.generic - comparison.handwritten,
+      comparison.generic_with_statistics - comparison.handwritten);
+  }
+}
+
+/// Append the comparisons to a CSV file, writing the header only to a new file.
+void
+append_history(const std::vector<Comparison> & comparisons, const Options & options)
+{
+  FILE * existing = fopen(options.history_path.c_str(), "r");
+  bool is_new = existing == nullptr;
+  if (existing) {
+    fclose(existing);
+  }
+  FILE * history = fopen(options.history_path.c_str(), "a");
+  if (!history) {
+    fprintf(stderr, "failed to open '%s'\n", options.history_path.c_str());
+    return;
+  }
+  if (is_new) {
+    fprintf(
+      history, "time,label,baseline,direction,size_bytes,gid_check,handwritten_ns,generic_ns,"
+      "generic_with_statistics_ns,overhead_ns,overhead_with_statistics_ns\n");
+  }
+  char time_text[32];
+  time_t now = time(nullptr);
+  strftime(time_text, sizeof(time_text), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+  for (const auto & comparison : comparisons) {
+    fprintf(
+      history, "%s,%s,%s,%s,%zu,%d,%.1f,%.1f,%.1f,%.1f,%.1f\n", time_text,
+      options.label.c_str(), comparison.baseline.c_str(), comparison.direction.c_str(),
+      comparison.size, options.gid_check, comparison.handwritten, comparison.generic,
+      comparison.generic_with_statistics, comparison.generic - comparison.handwritten,
+      comparison.generic_with_statistics - comparison.handwritten);
+  }
+  fclose(history);
+}
+
+bool
+parse_command_options(int argc, char ** argv, Options & options)
+{
+  using ros1_bridge_benchmark::find_command_option;
+  using ros1_bridge_benchmark::get_command_option_value;
+  std::vector<std::string> args(argv, argv + argc);
+
+  if (find_command_option(args, "-h") || find_command_option(args, "--help")) {
+    std::stringstream ss;
+    ss << "Usage:" << std::endl;
+    ss << " -h, --help: This message." << std::endl;
+    ss << " --iterations <n>: Messages per repetition (default: 100000)" << std::endl;
+    ss << " --repetitions <n>: Repetitions of which the fastest is reported (default: 5)";
+    ss << std::endl;
+    ss << " --sizes <list>: Comma separated sizes of the strings (default: 16,256,4096)";
+    ss << std::endl;
+    ss << " --no-gid-check: Pass no ROS 2 publisher to compare the GID of the messages ";
+    ss << "with, which doesn't initialize ROS 2 at all" << std::endl;
+    ss << " --history <file>: Append the results to a CSV file to track them over time";
+    ss << std::endl;
+    ss << " --label <text>: Label of the results in the history, e.g. the commit" << std::endl;
+    std::cout << ss.str();
+    return false;
+  }
+
+  options.iterations = std::stoul(get_command_option_value(args, "--iterations", "100000"));
+  options.repetitions = std::max<size_t>(
+    1, std::stoul(get_command_option_value(args, "--repetitions", "5")));
+  options.gid_check = !find_command_option(args, "--no-gid-check");
+  options.history_path = get_command_option_value(args, "--history", "");
+  options.label = get_command_option_value(args, "--label", "");
+
+  std::stringstream sizes(get_command_option_value(args, "--sizes", "16,256,4096"));
+  std::string size;
+  while (std::getline(sizes, size, ',')) {
+    options.sizes.push_back(std::stoul(size));
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  Options options;
+  if (!parse_command_options(argc, argv, options)) {
+    return 0;
+  }
+
+  // the publisher only provides the GID to compare with, nothing is published
+  rclcpp::Node::SharedPtr ros2_node;
+  rclcpp::PublisherBase::SharedPtr ros2_pub;
+  if (options.gid_check) {
+    rclcpp::init(argc, argv);
+    ros2_node = rclcpp::Node::make_shared("benchmark_generic_overhead");
+    ros2_pub = ros2_node->create_publisher<std_msgs::msg::String>(
+      "benchmark_generic_overhead_gid");
+  }
+
+  std::vector<Comparison> comparisons;
+  try {
+    for (size_t size : options.sizes) {
+      std_msgs::String ros1_msg;
+      std_msgs::msg::String ros2_msg;
+      ros1_msg.data = ros2_msg.data = std::string(size, 'x');
+      auto statistics_1to2 = std::make_shared<ros1_bridge::TopicStatistics>(
+        "1to2", "/benchmark", "std_msgs/String");
+      auto statistics_2to1 = std::make_shared<ros1_bridge::TopicStatistics>(
+        "2to1", "/benchmark", "std_msgs/String");
+
+      Callback1to2Driver<std_msgs::String, std_msgs::msg::String> generic_1to2(
+        ros1_msg, nullptr);
+      Callback1to2Driver<std_msgs::String, std_msgs::msg::String> generic_1to2_statistics(
+        ros1_msg, statistics_1to2);
+      double generic = measure(generic_1to2, options);
+      double generic_with_statistics = measure(generic_1to2_statistics, options);
+      {
+        SimpleBridge1to2 handwritten(ros1_msg, true);
+        comparisons.push_back(
+          {"simple_bridge", "1to2", size, measure(handwritten, options), generic,
+            generic_with_statistics});
+      }
+      {
+        SimpleBridge1to2 handwritten(ros1_msg, false);
+        comparisons.push_back(
+          {"simple_bridge_1_to_2", "1to2", size, measure(handwritten, options), generic,
+            generic_with_statistics});
+      }
+
+      Callback2to1Driver<std_msgs::String, std_msgs::msg::String> generic_2to1(
+        ros2_msg, nullptr, ros2_pub);
+      Callback2to1Driver<std_msgs::String, std_msgs::msg::String> generic_2to1_statistics(
+        ros2_msg, statistics_2to1, ros2_pub);
+      SimpleBridge2to1 handwritten_2to1(ros2_msg);
+      comparisons.push_back(
+        {"simple_bridge_2_to_1", "2to1", size, measure(handwritten_2to1, options),
+          measure(generic_2to1, options), measure(generic_2to1_statistics, options)});
+    }
+  } catch (const std::exception & e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  print_comparisons(comparisons, options);
+  if (!options.history_path.empty()) {
+    append_history(comparisons, options);
+  }
+
+  if (options.gid_check) {
+    ros2_pub.reset();
+    ros2_node.reset();
+    rclcpp::shutdown();
+  }
+  return 0;
+}
@@ -0,0 +1,609 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "diagnostic_msgs/SelfTest.h"
+#include "ros/ros.h"
+#include "std_msgs/String.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+// include ROS 2
+#include "diagnostic_msgs/srv/self_test.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "std_msgs/msg/string.hpp"
+
+#include "benchmark_utils.hpp"
+
+// Run a dynamic bridge for a long time and check that the resources it uses don't grow.
+// Two topics carry timestamped messages at a fixed rate through the bridge in both directions
+// all the time, while the churn keeps creating and destroying publishers, subscribers,
+// servers and clients of a fixed set of topics and services on both sides, so the bridge
+// keeps creating and removing the bridges of them.
+// The resident memory, the file descriptors and the threads of the bridge and the latency of
+// the messages are sampled periodically and the test fails if the slope of a linear fit of
+// the samples after the warm up exceeds its bound.
+
+namespace
+{
+
+using ros1_bridge_benchmark::LatencySamples;
+using ros1_bridge_benchmark::get_steady_time;
+
+const char * const topic_1to2 = "soak_1to2";
+const char * const topic_2to1 = "soak_2to1";
+
+struct Options
+{
+  double duration;
+  double warm_up;
+  double sample_interval;
+  double rate;
+  size_t size;
+  double churn_interval;
+  size_t churn_slots;
+  unsigned int seed;
+  std::string bridge_directory;
+  std::vector<std::string> bridge_args;
+  double max_rss_growth;
+  double max_fd_growth;
+  double max_thread_growth;
+  double max_latency_growth;
+  uint16_t master_port;
+  bool use_running_master;
+  std::string csv_path;
+};
+
+// the data starts with the time of the steady clock when the message was published in ns
+void
+set_stamp(std::string & data, uint64_t stamp, size_t size)
+{
+  data = std::to_string(stamp) + " ";
+  if (size > data.size()) {
+    data.resize(size, 'x');
+  }
+}
+
+uint64_t
+get_stamp(const std::string & data)
+{
+  return strtoull(data.c_str(), nullptr, 10);
+}
+
+/// The latencies of the messages of one direction since the last sample.
+class LatencyReceiver
+{
+public:
+  void
+  receive(uint64_t stamp)
+  {
+    uint64_t now = get_steady_time();
+    std::lock_guard<std::mutex> lock(mutex_);
+    latencies_.add(now - stamp);
+  }
+
+  LatencySamples
+  take()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    LatencySamples latencies = latencies_;
+    latencies_.clear();
+    return latencies;
+  }
+
+private:
+  std::mutex mutex_;
+  LatencySamples latencies_;
+};
+
+bool
+handle_ros1_self_test(
+  diagnostic_msgs::SelfTest::Request &, diagnostic_msgs::SelfTest::Response & response)
+{
+  response.id = "ros1";
+  return true;
+}
+
+void
+handle_ros2_self_test(
+  const std::shared_ptr<rmw_request_id_t>,
+  const std::shared_ptr<diagnostic_msgs::srv::SelfTest::Request>,
+  std::shared_ptr<diagnostic_msgs::srv::SelfTest::Response> response)
+{
+  response->id = "ros2";
+}
+
+/// The endpoints of one topic or service of the churn, which only exist while it is active.
+/**
+ * The kind of a slot is chosen by its index: a topic from ROS 1 to ROS 2, a topic from
+ * ROS 2 to ROS 1, a ROS 1 service called from ROS 2 or a ROS 2 service called from ROS 1.
+ */
+struct ChurnSlot
+{
+  bool active = false;
+  ros::Publisher ros1_pub;
+  ros::Subscriber ros1_sub;
+  ros::ServiceServer ros1_server;
+  rclcpp::Publisher<std_msgs::msg::String>::SharedPtr ros2_pub;
+  rclcpp::Subscription<std_msgs::msg::String>::SharedPtr ros2_sub;
+  rclcpp::Service<diagnostic_msgs::srv::SelfTest>::SharedPtr ros2_server;
+  rclcpp::Client<diagnostic_msgs::srv::SelfTest>::SharedPtr ros2_client;
+};
+
+/// Create and destroy the endpoints of the churn and use the active ones.
+class Churn
+{
+public:
+  Churn(ros::NodeHandle & ros1_node, rclcpp::Node::SharedPtr ros2_node, const Options & options)
+  : ros1_node_(ros1_node), ros2_node_(ros2_node), slots_(options.churn_slots),
+    random_(options.seed)
+  {}
+
+  /// Toggle a random slot and then publish once and call once on every active slot.
+  void
+  step()
+  {
+    if (slots_.empty()) {
+      return;
+    }
+    size_t index = std::uniform_int_distribution<size_t>(0, slots_.size() - 1)(random_);
+    if (slots_[index].active) {
+      slots_[index] = ChurnSlot();
+      --active;
+    } else {
+      activate(index);
+      ++active;
+    }
+    ++toggles;
+
+    std_msgs::String ros1_msg;
+    std_msgs::msg::String ros2_msg;
+    ros1_msg.data = ros2_msg.data = "churn";
+    for (size_t i = 0; i < slots_.size(); ++i) {
+      auto & slot = slots_[i];
+      if (!slot.active) {
+        continue;
+      }
+      if (slot.ros1_pub) {
+        slot.ros1_pub.publish(ros1_msg);
+      }
+      if (slot.ros2_pub) {
+        slot.ros2_pub->publish(ros2_msg);
+      }
+      if (slot.ros2_client && slot.ros2_client->service_is_ready()) {
+        // the ROS 1 server is called through the bridge
+        auto future = slot.ros2_client->async_send_request(
+          std::make_shared<diagnostic_msgs::srv::SelfTest::Request>());
+        bool ok = future.wait_for(std::chrono::seconds(1)) == std::future_status::ready &&
+          future.get()->id == "ros1";
+        ++(ok ? service_calls : failed_service_calls);
+      }
+      if (slot.ros2_server && ros::service::exists(get_name(i), false)) {
+        // the ROS 2 server is called through the bridge
+        diagnostic_msgs::SelfTest service;
+        bool ok = ros::service::call(get_name(i), service) && service.response.id == "ros2";
+        ++(ok ? service_calls : failed_service_calls);
+      }
+    }
+  }
+
+  std::atomic<size_t> active {0};
+  std::atomic<uint64_t> toggles {0};
+  std::atomic<uint64_t> service_calls {0};
+  std::atomic<uint64_t> failed_service_calls {0};
+
+private:
+  std::string
+  get_name(size_t index) const
+  {
+    return "soak_churn_" + std::to_string(index);
+  }
+
+  void
+  activate(size_t index)
+  {
+    auto & slot = slots_[index];
+    std::string name = get_name(index);
+    switch (index % 4) {
+      case 0:
+        slot.ros1_pub = ros1_node_.advertise<std_msgs::String>(name, 10);
+        slot.ros2_sub = ros2_node_->create_subscription<std_msgs::msg::String>(
+          name, std::function<void(const std_msgs::msg::String::SharedPtr)>(
+            [](const std_msgs::msg::String::SharedPtr) {}));
+        break;
+      case 1:
+        slot.ros2_pub = ros2_node_->create_publisher<std_msgs::msg::String>(name);
+        slot.ros1_sub = ros1_node_.subscribe<std_msgs::String>(
+          name, 10, boost::function<void(const std_msgs::String::ConstPtr &)>(
+            [](const std_msgs::String::ConstPtr &) {}));
+        break;
+      case 2:
+        slot.ros1_server = ros1_node_.advertiseService(name, handle_ros1_self_test);
+        slot.ros2_client = ros2_node_->create_client<diagnostic_msgs::srv::SelfTest>(name);
+        break;
+      default:
+        slot.ros2_server = ros2_node_->create_service<diagnostic_msgs::srv::SelfTest>(
+          name, handle_ros2_self_test);
+        break;
+    }
+    slot.active = true;
+  }
+
+  ros::NodeHandle & ros1_node_;
+  rclcpp::Node::SharedPtr ros2_node_;
+  std::vector<ChurnSlot> slots_;
+  std::mt19937 random_;
+};
+
+struct Sample
+{
+  double time;
+  ros1_bridge_benchmark::ProcessUsage usage;
+  LatencySamples latencies_1to2;
+  LatencySamples latencies_2to1;
+  size_t active_slots;
+  uint64_t toggles;
+  uint64_t service_calls;
+  uint64_t failed_service_calls;
+
+  /// The 99th percentile of the latency of both directions in us.
+  double
+  get_p99_latency()
+  {
+    return std::max(
+      latencies_1to2.get_percentile(0.99), latencies_2to1.get_percentile(0.99)) / 1e3;
+  }
+};
+
+/// Get the slope of the least squares line through the points.
+double
+get_slope(const std::vector<double> & x, const std::vector<double> & y)
+{
+  double mean_x = 0.0;
+  double mean_y = 0.0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    mean_x += x[i] / x.size();
+    mean_y += y[i] / y.size();
+  }
+  double covariance = 0.0;
+  double variance = 0.0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    covariance += (x[i] - mean_x) * (y[i] - mean_y);
+    variance += (x[i] - mean_x) * (x[i] - mean_x);
+  }
+  return variance > 0.0 ? covariance / variance : 0.0;
+}
+
+/// Print the trends after the warm up and check them against the bounds.
+bool
+check_trends(std::vector<Sample> & samples, const Options & options)
+{
+  std::vector<double> hours, rss, fds, threads, latency;
+  for (auto & sample : samples) {
+    if (sample.time < options.warm_up) {
+      continue;
+    }
+    hours.push_back(sample.time / 3600.0);
+    rss.push_back(sample.usage.rss_bytes / 1e6);
+    fds.push_back(static_cast<double>(sample.usage.file_descriptors));
+    threads.push_back(static_cast<double>(sample.usage.threads));
+    latency.push_back(sample.get_p99_latency());
+  }
+  if (hours.size() < 3) {
+    fprintf(stderr, "fewer than 3 samples after the warm up, increase the duration\n");
+    return false;
+  }
+
+  struct Trend
+  {
+    const char * name;
+    double slope;
+    double bound;
+  };
+  std::vector<Trend> trends = {
+    {"resident memory (MB/h)", get_slope(hours, rss), options.max_rss_growth},
+    {"file descriptors (1/h)", get_slope(hours, fds), options.max_fd_growth},
+    {"threads (1/h)", get_slope(hours, threads), options.max_thread_growth},
+    {"p99 latency (us/h)", get_slope(hours, latency), options.max_latency_growth},
+  };
+  bool passed = true;
+  printf("\ntrends of %zu samples after the warm up:\n", hours.size());
+  for (const auto & trend : trends) {
+    bool exceeded = trend.slope > trend.bound;
+    printf(
+      "  %-24s %12.3f (bound %.3f)%s\n", trend.name, trend.slope, trend.bound,
+      exceeded ? " EXCEEDED" : "");
+    passed = passed && !exceeded;
+  }
+  return passed;
+}
+
+void
+print_sample(FILE * csv, Sample & sample)
+{
+  printf(
+    "%8.0f s  rss %8.1f MB  fds %4" PRIu64 "  threads %3" PRIu64 "  p99 %8.1f us  "
+    "active %3zu  calls %6" PRIu64 " (%" PRIu64 " failed)\n",
+    sample.time, sample.usage.rss_bytes / 1e6, sample.usage.file_descriptors,
+    sample.usage.threads, sample.get_p99_latency(), sample.active_slots, sample.service_calls,
+    sample.failed_service_calls);
+  if (!csv) {
+    return;
+  }
+  fprintf(
+    csv, "%.1f,%.3f,%" PRIu64 ",%" PRIu64 ",%zu,%.1f,%.1f,%zu,%.1f,%.1f,%zu,%" PRIu64 ",%" PRIu64
+    ",%" PRIu64 "\n",
+    sample.time, sample.usage.rss_bytes / 1e6, sample.usage.file_descriptors,
+    sample.usage.threads,
+    sample.latencies_1to2.size(), sample.latencies_1to2.get_percentile(0.5) / 1e3,
+    sample.latencies_1to2.get_percentile(0.99) / 1e3,
+    sample.latencies_2to1.size(), sample.latencies_2to1.get_percentile(0.5) / 1e3,
+    sample.latencies_2to1.get_percentile(0.99) / 1e3,
+    sample.active_slots, sample.toggles, sample.service_calls, sample.failed_service_calls);
+  fflush(csv);
+}
+
+std::string
+get_executable_directory()
+{
+  char path[PATH_MAX];
+  ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+  if (length <= 0) {
+    return ".";
+  }
+  std::string executable(path, length);
+  return executable.substr(0, executable.rfind('/'));
+}
+
+bool
+parse_command_options(int argc, char ** argv, Options & options)
+{
+  using ros1_bridge_benchmark::find_command_option;
+  using ros1_bridge_benchmark::get_command_option_value;
+  std::vector<std::string> args(argv, argv + argc);
+
+  if (find_command_option(args, "-h") || find_command_option(args, "--help")) {
+    std::stringstream ss;
+    ss << "Usage:" << std::endl;
+    ss << " -h, --help: This message." << std::endl;
+    ss << " --duration <s>: Time to run the bridge (default: 3600)" << std::endl;
+    ss << " --warm-up <s>: Time before the samples count for the trends (default: 300)";
+    ss << std::endl;
+    ss << " --sample-interval <s>: Time between the samples (default: 10)" << std::endl;
+    ss << " --rate <hz>: Messages per second of the steady topics (default: 100)" << std::endl;
+    ss << " --size <bytes>: Size of the messages of the steady topics (default: 256)";
+    ss << std::endl;
+    ss << " --churn-interval <s>: Time between toggling the topics and services of the churn ";
+    ss << "(default: 1)" << std::endl;
+    ss << " --churn-slots <n>: Topics and services of the churn (default: 16)" << std::endl;
+    ss << " --seed <n>: Seed of the order of the churn (default: 1)" << std::endl;
+    ss << " --bridge-directory <path>: Directory of the dynamic_bridge ";
+    ss << "(default: the one of this benchmark)" << std::endl;
+    ss << " --bridge-args <args>: Space separated arguments of the dynamic_bridge ";
+    ss << "(default: none)" << std::endl;
+    ss << " --max-rss-growth <MB/h>: Bound of the growth of the resident memory ";
+    ss << "(default: 5)" << std::endl;
+    ss << " --max-fd-growth <n/h>: Bound of the growth of the file descriptors (default: 2)";
+    ss << std::endl;
+    ss << " --max-thread-growth <n/h>: Bound of the growth of the threads (default: 1)";
+    ss << std::endl;
+    ss << " --max-latency-growth <us/h>: Bound of the growth of the 99th percentile of the ";
+    ss << "latency (default: 1000)" << std::endl;
+    ss << " --master-port <port>: Port of the roscore started for the test ";
+    ss << "(default: 11513)" << std::endl;
+    ss << " --use-running-master: Use the master of ROS_MASTER_URI instead of starting a ";
+    ss << "roscore" << std::endl;
+    ss << " --csv <file>: Also write the samples to a CSV file" << std::endl;
+    std::cout << ss.str();
+    return false;
+  }
+
+  options.duration = std::stod(get_command_option_value(args, "--duration", "3600"));
+  options.warm_up = std::stod(get_command_option_value(args, "--warm-up", "300"));
+  options.sample_interval = std::stod(get_command_option_value(args, "--sample-interval", "10"));
+  options.rate = std::stod(get_command_option_value(args, "--rate", "100"));
+  options.size = std::stoul(get_command_option_value(args, "--size", "256"));
+  options.churn_interval = std::stod(get_command_option_value(args, "--churn-interval", "1"));
+  options.churn_slots = std::stoul(get_command_option_value(args, "--churn-slots", "16"));
+  options.seed = static_cast<unsigned int>(
+    std::stoul(get_command_option_value(args, "--seed", "1")));
+  options.bridge_directory = get_command_option_value(
+    args, "--bridge-directory", get_executable_directory());
+  std::stringstream bridge_args(get_command_option_value(args, "--bridge-args", ""));
+  std::string bridge_arg;
+  while (bridge_args >> bridge_arg) {
+    options.bridge_args.push_back(bridge_arg);
+  }
+  options.max_rss_growth = std::stod(get_command_option_value(args, "--max-rss-growth", "5"));
+  options.max_fd_growth = std::stod(get_command_option_value(args, "--max-fd-growth", "2"));
+  options.max_thread_growth = std::stod(
+    get_command_option_value(args, "--max-thread-growth", "1"));
+  options.max_latency_growth = std::stod(
+    get_command_option_value(args, "--max-latency-growth", "1000"));
+  options.master_port = static_cast<uint16_t>(
+    std::stoul(get_command_option_value(args, "--master-port", "11513")));
+  options.use_running_master = find_command_option(args, "--use-running-master");
+  options.csv_path = get_command_option_value(args, "--csv", "");
+  return true;
+}
+
+/// Run the traffic and the churn and sample the bridge until the duration has passed.
+int
+run(int argc, char * argv[], pid_t bridge_pid, const Options & options)
+{
+  ros::init(argc, argv, "benchmark_soak");
+  ros::NodeHandle ros1_node;
+  rclcpp::init(argc, argv);
+  auto ros2_node = rclcpp::Node::make_shared("benchmark_soak");
+
+  LatencyReceiver receiver_1to2;
+  LatencyReceiver receiver_2to1;
+  auto ros1_pub = ros1_node.advertise<std_msgs::String>(topic_1to2, 100);
+  auto ros2_sub = ros2_node->create_subscription<std_msgs::msg::String>(
+    topic_1to2, std::function<void(const std_msgs::msg::String::SharedPtr)>(
+      [&receiver_1to2](const std_msgs::msg::String::SharedPtr msg)
+      {
+        receiver_1to2.receive(get_stamp(msg->data));
+      }));
+  auto ros2_pub = ros2_node->create_publisher<std_msgs::msg::String>(topic_2to1);
+  auto ros1_sub = ros1_node.subscribe<std_msgs::String>(
+    topic_2to1, 100, boost::function<void(const std_msgs::String::ConstPtr &)>(
+      [&receiver_2to1](const std_msgs::String::ConstPtr & msg)
+      {
+        receiver_2to1.receive(get_stamp(msg->data));
+      }));
+
+  // the service calls of the churn block until the other side responded
+  ros::AsyncSpinner async_spinner(2);
+  async_spinner.start();
+  rclcpp::executors::MultiThreadedExecutor executor;
+  executor.add_node(ros2_node);
+  std::thread ros2_spin_thread([&executor]() {executor.spin();});
+
+  std::atomic<bool> running(true);
+  std::thread traffic_thread([&]()
+    {
+      std_msgs::String ros1_msg;
+      std_msgs::msg::String ros2_msg;
+      auto period = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / options.rate));
+      auto next = std::chrono::steady_clock::now();
+      while (running.load()) {
+        set_stamp(ros1_msg.data, get_steady_time(), options.size);
+        ros1_pub.publish(ros1_msg);
+        set_stamp(ros2_msg.data, get_steady_time(), options.size);
+        ros2_pub->publish(ros2_msg);
+        next += period;
+        std::this_thread::sleep_until(next);
+      }
+    });
+
+  Churn churn(ros1_node, ros2_node, options);
+  std::thread churn_thread([&]()
+    {
+      auto period = std::chrono::nanoseconds(static_cast<int64_t>(options.churn_interval * 1e9));
+      auto next = std::chrono::steady_clock::now();
+      while (running.load()) {
+        churn.step();
+        next += period;
+        std::this_thread::sleep_until(next);
+      }
+    });
+
+  FILE * csv = nullptr;
+  if (!options.csv_path.empty()) {
+    csv = fopen(options.csv_path.c_str(), "w");
+    if (!csv) {
+      fprintf(stderr, "failed to open '%s'\n", options.csv_path.c_str());
+    } else {
+      fprintf(
+        csv, "time_s,rss_mb,file_descriptors,threads,received_1to2,p50_1to2_us,p99_1to2_us,"
+        "received_2to1,p50_2to1_us,p99_2to1_us,active_churn_slots,churn_toggles,"
+        "service_calls,failed_service_calls\n");
+    }
+  }
+
+  int exit_code = 0;
+  std::vector<Sample> samples;
+  auto start = std::chrono::steady_clock::now();
+  auto interval = std::chrono::nanoseconds(static_cast<int64_t>(options.sample_interval * 1e9));
+  auto end = start + std::chrono::nanoseconds(static_cast<int64_t>(options.duration * 1e9));
+  receiver_1to2.take();
+  receiver_2to1.take();
+  for (auto next = start + interval; next <= end && rclcpp::ok() && ros::ok(); next += interval) {
+    std::this_thread::sleep_until(next);
+    if (kill(bridge_pid, 0) != 0) {
+      fprintf(stderr, "the bridge exited during the test\n");
+      exit_code = 1;
+      break;
+    }
+    Sample sample;
+    sample.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    sample.usage = ros1_bridge_benchmark::read_process_usage(bridge_pid);
+    sample.latencies_1to2 = receiver_1to2.take();
+    sample.latencies_2to1 = receiver_2to1.take();
+    sample.active_slots = churn.active.load();
+    sample.toggles = churn.toggles.load();
+    sample.service_calls = churn.service_calls.load();
+    sample.failed_service_calls = churn.failed_service_calls.load();
+    print_sample(csv, sample);
+    samples.push_back(std::move(sample));
+  }
+  if (csv) {
+    fclose(csv);
+  }
+
+  running.store(false);
+  traffic_thread.join();
+  churn_thread.join();
+  if (exit_code == 0 && !check_trends(samples, options)) {
+    exit_code = 1;
+  }
+
+  rclcpp::shutdown();
+  ros2_spin_thread.join();
+  ros::shutdown();
+  return exit_code;
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  Options options;
+  ros1_bridge_benchmark::ChildProcess roscore;
+  ros1_bridge_benchmark::ChildProcess bridge;
+  try {
+    if (!parse_command_options(argc, argv, options)) {
+      return 0;
+    }
+    if (!options.use_running_master) {
+      roscore = ros1_bridge_benchmark::start_roscore(options.master_port);
+    }
+    std::vector<std::string> bridge_command = {options.bridge_directory + "/dynamic_bridge"};
+    bridge_command.insert(
+      bridge_command.end(), options.bridge_args.begin(), options.bridge_args.end());
+    bridge = ros1_bridge_benchmark::ChildProcess::spawn(bridge_command, true);
+    int exit_code = run(argc, argv, bridge.get_pid(), options);
+    printf("%s\n", exit_code == 0 ? "PASSED" : "FAILED");
+    return exit_code;
+  } catch (const std::exception & e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,367 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <limits.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "ros/ros.h"
+#include "std_msgs/String.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+#include "std_msgs/msg/string.hpp"
+
+#include "benchmark_utils.hpp"
+
+// Measure how long the bridge executables take to pass the first message and how much memory
+// they occupy afterwards.
+// Every bridge is started against a roscore with a ROS 1 publisher and a ROS 2 subscriber of
+// the topic chatter (the one the static_bridge bridges), and asked to append its startup
+// phases to a report file (see ros1_bridge/startup_timing.hpp), which breaks the time down
+// into loading the libraries, initializing the nodes (and for the dynamic bridges waiting for
+// the discovery), looking up the factory and creating the first bridge.
+
+namespace
+{
+
+using ros1_bridge_benchmark::get_steady_time;
+
+const char * const probe_topic = "chatter";
+
+struct Options
+{
+  std::vector<std::string> bridges;
+  std::string bridge_directory;
+  size_t repetitions;
+  double settle_time;
+  double timeout;
+  uint16_t master_port;
+  bool use_running_master;
+  std::string csv_path;
+};
+
+struct StartupResult
+{
+  std::string bridge;
+  size_t repetition;
+  std::map<std::string, uint64_t> phases;
+  uint64_t start;
+  uint64_t first_message;
+  uint64_t rss_bytes;
+};
+
+std::string
+get_executable_directory()
+{
+  char path[PATH_MAX];
+  ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+  if (length <= 0) {
+    return ".";
+  }
+  std::string executable(path, length);
+  return executable.substr(0, executable.rfind('/'));
+}
+
+/// Count the message type pairs the bridges were compiled with.
+size_t
+count_message_pairs(const std::string & dynamic_bridge)
+{
+  FILE * pipe = popen((dynamic_bridge + " --print-pairs").c_str(), "r");
+  if (!pipe) {
+    return 0;
+  }
+  size_t pairs = 0;
+  bool in_message_pairs = false;
+  char line[1024];
+  while (fgets(line, sizeof(line), pipe)) {
+    std::string text(line);
+    if (text.find("message type conversion pairs") != std::string::npos) {
+      in_message_pairs = true;
+    } else if (text.find("service type conversion pairs") != std::string::npos) {
+      in_message_pairs = false;
+    } else if (in_message_pairs && text.find("(ROS 2) <=>") != std::string::npos) {
+      ++pairs;
+    }
+  }
+  pclose(pipe);
+  return pairs;
+}
+
+std::map<std::string, uint64_t>
+read_startup_report(const std::string & path)
+{
+  std::map<std::string, uint64_t> phases;
+  std::ifstream report(path);
+  std::string phase;
+  uint64_t time;
+  while (report >> phase >> time) {
+    phases[phase] = time;
+  }
+  return phases;
+}
+
+/// Get the time in ms between two phases, or a negative value if one of them is missing.
+double
+get_phase_delta(
+  const std::map<std::string, uint64_t> & phases, const std::string & from, const std::string & to)
+{
+  auto from_it = phases.find(from);
+  auto to_it = phases.find(to);
+  if (from_it == phases.end() || to_it == phases.end()) {
+    return -1.0;
+  }
+  return (static_cast<double>(to_it->second) - static_cast<double>(from_it->second)) / 1e6;
+}
+
+/// Start a bridge, wait for the first probe message to pass it and sample its memory.
+StartupResult
+measure_startup(
+  const std::string & bridge, size_t repetition, std::atomic<uint64_t> & first_message,
+  const Options & options)
+{
+  char report_path[] = "/tmp/ros1_bridge_startup_XXXXXX";
+  int report_fd = mkstemp(report_path);
+  if (report_fd < 0) {
+    throw std::runtime_error("failed to create a startup report file");
+  }
+  close(report_fd);
+
+  StartupResult result;
+  result.bridge = bridge;
+  result.repetition = repetition;
+  result.first_message = 0;
+  result.rss_bytes = 0;
+
+  first_message.store(0);
+  setenv("ROS1_BRIDGE_STARTUP_REPORT", report_path, 1);
+  result.start = get_steady_time();
+  auto child = ros1_bridge_benchmark::ChildProcess::spawn(
+    {options.bridge_directory + "/" + bridge}, true);
+  unsetenv("ROS1_BRIDGE_STARTUP_REPORT");
+
+  auto deadline = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(static_cast<int64_t>(options.timeout * 1e3));
+  while (first_message.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+    if (!child.is_running()) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  result.first_message = first_message.load();
+
+  if (result.first_message != 0) {
+    std::this_thread::sleep_for(
+      std::chrono::milliseconds(static_cast<int64_t>(options.settle_time * 1e3)));
+    result.rss_bytes = ros1_bridge_benchmark::read_process_usage(child.get_pid()).rss_bytes;
+  }
+  child.stop();
+
+  result.phases = read_startup_report(report_path);
+  result.phases["start"] = result.start;
+  if (result.first_message) {
+    result.phases["first_message"] = result.first_message;
+  }
+  unlink(report_path);
+  return result;
+}
+
+void
+print_result(FILE * output, const StartupResult & result, size_t message_pairs)
+{
+  const auto & phases = result.phases;
+  // the dynamic bridges discover both sides before creating the first bridge
+  double first_discovery = get_phase_delta(phases, "start", "first_discovery_ros1");
+  double first_discovery_ros2 = get_phase_delta(phases, "start", "first_discovery_ros2");
+  if (first_discovery < 0 ||
+    (first_discovery_ros2 >= 0 && first_discovery_ros2 < first_discovery))
+  {
+    first_discovery = first_discovery_ros2;
+  }
+  fprintf(
+    output, "%s,%zu,%zu,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+    result.bridge.c_str(), result.repetition, message_pairs,
+    get_phase_delta(phases, "start", "library_loaded"),
+    get_phase_delta(phases, "library_loaded", "first_bridge_start"),
+    get_phase_delta(phases, "first_bridge_start", "first_factory_lookup"),
+    get_phase_delta(phases, "first_factory_lookup", "first_bridge_created"),
+    first_discovery,
+    get_phase_delta(phases, "start", "first_message"),
+    result.rss_bytes / 1e6);
+  fflush(output);
+}
+
+bool
+parse_command_options(int argc, char ** argv, Options & options)
+{
+  using ros1_bridge_benchmark::find_command_option;
+  using ros1_bridge_benchmark::get_command_option_value;
+  std::vector<std::string> args(argv, argv + argc);
+
+  if (find_command_option(args, "-h") || find_command_option(args, "--help")) {
+    std::stringstream ss;
+    ss << "Usage:" << std::endl;
+    ss << " -h, --help: This message." << std::endl;
+    ss << " --bridges <list>: Comma separated bridge executables to start ";
+    ss << "(default: dynamic_bridge,parameter_bridge,static_bridge)" << std::endl;
+    ss << " --bridge-directory <path>: Directory of the bridge executables ";
+    ss << "(default: the one of this benchmark)" << std::endl;
+    ss << " --repetitions <n>: Starts of every bridge (default: 3)" << std::endl;
+    ss << " --settle-time <s>: Time after the first message until the memory is sampled ";
+    ss << "(default: 5)" << std::endl;
+    ss << " --timeout <s>: Time to wait for the first message (default: 30)" << std::endl;
+    ss << " --master-port <port>: Port of the roscore started for the benchmark ";
+    ss << "(default: 11512)" << std::endl;
+    ss << " --use-running-master: Use the master of ROS_MASTER_URI instead of starting a ";
+    ss << "roscore" << std::endl;
+    ss << " --csv <file>: Write the results to a CSV file instead of the standard output";
+    ss << std::endl;
+    std::cout << ss.str();
+    return false;
+  }
+
+  std::stringstream bridges(
+    get_command_option_value(args, "--bridges", "dynamic_bridge,parameter_bridge,static_bridge"));
+  std::string bridge;
+  while (std::getline(bridges, bridge, ',')) {
+    options.bridges.push_back(bridge);
+  }
+  options.bridge_directory = get_command_option_value(
+    args, "--bridge-directory", get_executable_directory());
+  options.repetitions = std::stoul(get_command_option_value(args, "--repetitions", "3"));
+  options.settle_time = std::stod(get_command_option_value(args, "--settle-time", "5"));
+  options.timeout = std::stod(get_command_option_value(args, "--timeout", "30"));
+  options.master_port = static_cast<uint16_t>(
+    std::stoul(get_command_option_value(args, "--master-port", "11512")));
+  options.use_running_master = find_command_option(args, "--use-running-master");
+  options.csv_path = get_command_option_value(args, "--csv", "");
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  Options options;
+  ros1_bridge_benchmark::ChildProcess roscore;
+  try {
+    if (!parse_command_options(argc, argv, options)) {
+      return 0;
+    }
+    if (!options.use_running_master) {
+      roscore = ros1_bridge_benchmark::start_roscore(options.master_port);
+    }
+  } catch (const std::exception & e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  size_t message_pairs = count_message_pairs(options.bridge_directory + "/dynamic_bridge");
+
+  ros::init(argc, argv, "benchmark_startup");
+  ros::NodeHandle ros1_node;
+  rclcpp::init(argc, argv);
+  auto ros2_node = rclcpp::Node::make_shared("benchmark_startup");
+
+  // the topic for the parameter_bridge
+  XmlRpc::XmlRpcValue topics;
+  topics[0]["topic"] = probe_topic;
+  topics[0]["type"] = "std_msgs/String";
+  topics[0]["queue_size"] = 10;
+  ros1_node.setParam("topics", topics);
+
+  // the probe is published all the time, the time a bridge is ready is when it first arrives
+  std::atomic<uint64_t> first_message(0);
+  auto ros2_sub = ros2_node->create_subscription<std_msgs::msg::String>(
+    probe_topic, std::function<void(const std_msgs::msg::String::SharedPtr)>(
+      [&first_message](const std_msgs::msg::String::SharedPtr)
+      {
+        uint64_t expected = 0;
+        first_message.compare_exchange_strong(expected, get_steady_time());
+      }));
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(ros2_node);
+  std::thread ros2_spin_thread([&executor]() {executor.spin();});
+
+  auto ros1_pub = ros1_node.advertise<std_msgs::String>(probe_topic, 10);
+  std::atomic<bool> publishing(true);
+  std::thread probe_thread([&ros1_pub, &publishing]()
+    {
+      std_msgs::String msg;
+      msg.data = "startup probe";
+      while (publishing.load()) {
+        ros1_pub.publish(msg);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    });
+
+  FILE * output = stdout;
+  if (!options.csv_path.empty()) {
+    output = fopen(options.csv_path.c_str(), "w");
+    if (!output) {
+      fprintf(stderr, "failed to open '%s'\n", options.csv_path.c_str());
+      output = stdout;
+    }
+  }
+  fprintf(
+    output, "bridge,repetition,message_pairs,library_load_ms,init_until_first_bridge_ms,"
+    "factory_lookup_ms,bridge_creation_ms,first_discovery_ms,first_message_ms,rss_mb\n");
+
+  int exit_code = 0;
+  try {
+    for (const auto & bridge : options.bridges) {
+      for (size_t i = 0; i < options.repetitions && rclcpp::ok() && ros::ok(); ++i) {
+        auto result = measure_startup(bridge, i, first_message, options);
+        if (!result.first_message) {
+          fprintf(stderr, "no message passed %s within the timeout\n", bridge.c_str());
+          exit_code = 1;
+        }
+        print_result(output, result, message_pairs);
+      }
+    }
+  } catch (const std::exception & e) {
+    fprintf(stderr, "%s\n", e.what());
+    exit_code = 1;
+  }
+  if (output != stdout) {
+    fclose(output);
+  }
+
+  publishing.store(false);
+  probe_thread.join();
+  rclcpp::shutdown();
+  ros2_spin_thread.join();
+  ros::shutdown();
+  return exit_code;
+}
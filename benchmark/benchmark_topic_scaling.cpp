@@ -0,0 +1,429 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "std_msgs/UInt8MultiArray.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+
+#include "std_msgs_factories.hpp"
+
+#include "ros1_bridge/bridge.hpp"
+
+#include "benchmark_utils.hpp"
+#include "callback_harness.hpp"
+
+// Measure how the bridge scales with the number of bridged topics.
+// For every combination of topic count, rate per topic and message size the bridges of all
+// topics are set up and driven with local stand-ins for the middlewares for a while:
+// a generator delivers the messages of all topics evenly spread over time into the callback
+// queues, which drop messages of a topic when its queue is full like a ROS 1 subscriber,
+// and callback threads pass them to the callbacks of the bridge.
+// Every combination runs in a forked process, so its memory is measured from a clean start.
+
+namespace
+{
+
+using ros1_bridge_benchmark::LatencySamples;
+using ros1_bridge_benchmark::get_steady_time;
+
+using ROS1Message = std_msgs::UInt8MultiArray;
+using ROS2Message = std_msgs::msg::UInt8MultiArray;
+
+struct Options
+{
+  std::vector<size_t> topic_counts;
+  std::vector<double> rates;
+  std::vector<size_t> sizes;
+  std::string direction;
+  size_t threads;
+  size_t queue_size;
+  double duration;
+  double warm_up;
+  std::string csv_path;
+};
+
+struct Point
+{
+  size_t topics;
+  double rate;
+  size_t size;
+};
+
+/// A message of a topic which arrived at the given time.
+struct Arrival
+{
+  uint32_t topic;
+  uint64_t time;
+};
+
+/// Callback queue of one callback thread, which limits the queued messages per topic.
+class CallbackQueue
+{
+public:
+  CallbackQueue(size_t topic_count, size_t queue_size)
+  : queue_size_(queue_size),
+    queued_(topic_count, 0)
+  {}
+
+  /// Queue a message unless the queue of its topic is full.
+  bool
+  push(const Arrival & arrival)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (queued_[arrival.topic] >= queue_size_) {
+        return false;
+      }
+      ++queued_[arrival.topic];
+      arrivals_.push_back(arrival);
+    }
+    condition_.notify_one();
+    return true;
+  }
+
+  /// Wait for the next message, false when the queue is closed and empty.
+  bool
+  pop(Arrival & arrival)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this]() {return closed_ || !arrivals_.empty();});
+    if (arrivals_.empty()) {
+      return false;
+    }
+    arrival = arrivals_.front();
+    arrivals_.pop_front();
+    --queued_[arrival.topic];
+    return true;
+  }
+
+  void
+  close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    condition_.notify_all();
+  }
+
+private:
+  const size_t queue_size_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<Arrival> arrivals_;
+  std::vector<size_t> queued_;
+  bool closed_ = false;
+};
+
+struct WorkerResult
+{
+  uint64_t messages = 0;
+  std::chrono::nanoseconds cpu_time {0};
+  LatencySamples latencies;
+};
+
+std::chrono::nanoseconds
+get_thread_cpu_time()
+{
+  timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+}
+
+/// Pass the queued messages to the callbacks of their topics until the queue is closed.
+void
+run_worker(
+  CallbackQueue & queue, std::vector<std::function<void()>> & callbacks,
+  uint64_t measure_start, WorkerResult & result)
+{
+  auto cpu_start = get_thread_cpu_time();
+  Arrival arrival;
+  while (queue.pop(arrival)) {
+    callbacks[arrival.topic]();
+    if (arrival.time >= measure_start) {
+      result.latencies.add(get_steady_time() - arrival.time);
+      ++result.messages;
+    }
+  }
+  result.cpu_time = get_thread_cpu_time() - cpu_start;
+}
+
+/// Set up the bridges of a point, drive them and print the results as a line of CSV.
+int
+run_point(const Point & point, const Options & options, FILE * output)
+{
+  auto usage_before = ros1_bridge_benchmark::read_process_usage(getpid());
+
+  // all topics pass the same message, so only the memory of the bridges is measured
+  auto ros1_msg = boost::make_shared<ROS1Message>();
+  ros1_msg->data.assign(point.size, 42);
+  auto ros2_msg = std::make_shared<ROS2Message>();
+  ros2_msg->data.assign(point.size, 42);
+
+  // the share of the bridge in setting up a topic: looking up the factory, registering the
+  // statistics and binding the callback
+  std::vector<std::shared_ptr<ros1_bridge::TopicStatistics>> statistics;
+  std::vector<std::function<void()>> callbacks;
+  statistics.reserve(point.topics);
+  callbacks.reserve(point.topics);
+  const std::string type_name = "std_msgs/UInt8MultiArray";
+  auto setup_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < point.topics; ++i) {
+    auto factory = ros1_bridge::get_factory(type_name, type_name);
+    if (!factory) {
+      throw std::runtime_error("no factory for " + type_name);
+    }
+    std::string topic_name = "/benchmark/topic_" + std::to_string(i);
+    statistics.push_back(
+      ros1_bridge::register_topic_statistics(options.direction, topic_name, type_name));
+    if (options.direction == "1to2") {
+      callbacks.push_back(
+        ros1_bridge_benchmark::Callback1to2Driver<ROS1Message, ROS2Message>(
+          ros1_msg, statistics.back()));
+    } else {
+      callbacks.push_back(
+        ros1_bridge_benchmark::Callback2to1Driver<ROS1Message, ROS2Message>(
+          ros2_msg, statistics.back()));
+    }
+  }
+  double setup_time = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - setup_start).count();
+  auto usage_after = ros1_bridge_benchmark::read_process_usage(getpid());
+
+  // topics are assigned to the callback threads like to the shards of a sharded bridge,
+  // so the callbacks of a topic never run concurrently
+  std::vector<std::unique_ptr<CallbackQueue>> queues;
+  std::vector<WorkerResult> worker_results(options.threads);
+  std::vector<std::thread> workers;
+  uint64_t start = get_steady_time();
+  uint64_t measure_start = start + static_cast<uint64_t>(options.warm_up * 1e9);
+  uint64_t end = measure_start + static_cast<uint64_t>(options.duration * 1e9);
+  for (size_t i = 0; i < options.threads; ++i) {
+    queues.emplace_back(new CallbackQueue(point.topics, options.queue_size));
+  }
+  for (size_t i = 0; i < options.threads; ++i) {
+    workers.emplace_back(
+      run_worker, std::ref(*queues[i]), std::ref(callbacks), measure_start,
+      std::ref(worker_results[i]));
+  }
+
+  // deliver the messages at their scheduled time, in batches of one millisecond, and stamp
+  // them with the schedule, so a generator falling behind shows up as latency
+  double interval = 1e9 / (point.rate * point.topics);
+  uint64_t offered = 0;
+  uint64_t drops = 0;
+  uint64_t index = 0;
+  while (true) {
+    uint64_t now = get_steady_time();
+    uint64_t next = start + static_cast<uint64_t>(index * interval);
+    while (next <= now && next < end) {
+      uint32_t topic = static_cast<uint32_t>(index % point.topics);
+      bool queued = queues[topic % options.threads]->push({topic, next});
+      if (next >= measure_start) {
+        ++offered;
+        if (!queued) {
+          ++drops;
+        }
+      }
+      ++index;
+      next = start + static_cast<uint64_t>(index * interval);
+    }
+    if (next >= end) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  for (auto & queue : queues) {
+    queue->close();
+  }
+  for (auto & worker : workers) {
+    worker.join();
+  }
+  // includes the time to drain the queues
+  double measured_time = (get_steady_time() - measure_start) / 1e9;
+
+  uint64_t messages = 0;
+  std::chrono::nanoseconds cpu_time(0);
+  LatencySamples latencies;
+  for (auto & result : worker_results) {
+    messages += result.messages;
+    cpu_time += result.cpu_time;
+    latencies.merge(result.latencies);
+  }
+
+  // signed since the resident set may shrink e.g. when the allocator returns memory
+  int64_t memory_growth =
+    static_cast<int64_t>(usage_after.rss_bytes) - static_cast<int64_t>(usage_before.rss_bytes);
+  fprintf(
+    output, "%zu,%.1f,%zu,%s,%zu,%.1f,%.1f,%.4f,%.1f,%.1f,%.1f,%.1f,%.3f,%.0f,%.2f\n",
+    point.topics, point.rate, point.size, options.direction.c_str(), options.threads,
+    offered / options.duration, messages / measured_time,
+    offered ? 100.0 * drops / offered : 0.0,
+    latencies.get_percentile(0.5) / 1e3, latencies.get_percentile(0.99) / 1e3,
+    latencies.get_percentile(0.999) / 1e3, latencies.get_max() / 1e3,
+    messages ? cpu_time.count() / 1e3 / messages : 0.0,
+    static_cast<double>(memory_growth) / point.topics,
+    setup_time * 1e6 / point.topics);
+  fflush(output);
+  return 0;
+}
+
+const char * const csv_header =
+  "topics,rate_hz,size_bytes,direction,threads,offered_msgs_per_s,throughput_msgs_per_s,"
+  "drops_percent,p50_us,p99_us,p999_us,max_us,cpu_us_per_msg,memory_bytes_per_topic,"
+  "setup_us_per_topic\n";
+
+template<typename T>
+std::vector<T>
+parse_list(const std::string & list, const std::function<T(const std::string &)> & parse)
+{
+  std::vector<T> values;
+  std::stringstream stream(list);
+  std::string value;
+  while (std::getline(stream, value, ',')) {
+    values.push_back(parse(value));
+  }
+  return values;
+}
+
+bool
+parse_command_options(int argc, char ** argv, Options & options)
+{
+  using ros1_bridge_benchmark::find_command_option;
+  using ros1_bridge_benchmark::get_command_option_value;
+  std::vector<std::string> args(argv, argv + argc);
+
+  if (find_command_option(args, "-h") || find_command_option(args, "--help")) {
+    std::stringstream ss;
+    ss << "Usage:" << std::endl;
+    ss << " -h, --help: This message." << std::endl;
+    ss << " --topics <list>: Comma separated numbers of bridged topics ";
+    ss << "(default: 10,100,1000,10000)" << std::endl;
+    ss << " --rates <list>: Comma separated messages per second of each topic ";
+    ss << "(default: 1,10,100)" << std::endl;
+    ss << " --sizes <list>: Comma separated sizes of the std_msgs/UInt8MultiArray messages ";
+    ss << "in bytes (default: 64,4096)" << std::endl;
+    ss << " --direction <1to2|2to1>: Direction of the bridges (default: 1to2)" << std::endl;
+    ss << " --threads <n>: Callback threads (default: 1)" << std::endl;
+    ss << " --queue-size <n>: Queued messages per topic before dropping (default: 100)";
+    ss << std::endl;
+    ss << " --duration <s>: Measured time of every combination (default: 5)" << std::endl;
+    ss << " --warm-up <s>: Time of every combination before measuring (default: 1)";
+    ss << std::endl;
+    ss << " --csv <file>: Write the results to a CSV file instead of the standard output";
+    ss << std::endl;
+    std::cout << ss.str();
+    return false;
+  }
+
+  options.topic_counts = parse_list<size_t>(
+    get_command_option_value(args, "--topics", "10,100,1000,10000"),
+    [](const std::string & value) {return std::stoul(value);});
+  options.rates = parse_list<double>(
+    get_command_option_value(args, "--rates", "1,10,100"),
+    [](const std::string & value) {return std::stod(value);});
+  options.sizes = parse_list<size_t>(
+    get_command_option_value(args, "--sizes", "64,4096"),
+    [](const std::string & value) {return std::stoul(value);});
+  options.direction = get_command_option_value(args, "--direction", "1to2");
+  if (options.direction != "1to2" && options.direction != "2to1") {
+    throw std::runtime_error("unknown direction '" + options.direction + "'");
+  }
+  options.threads = std::stoul(get_command_option_value(args, "--threads", "1"));
+  options.queue_size = std::stoul(get_command_option_value(args, "--queue-size", "100"));
+  options.duration = std::stod(get_command_option_value(args, "--duration", "5"));
+  options.warm_up = std::stod(get_command_option_value(args, "--warm-up", "1"));
+  options.csv_path = get_command_option_value(args, "--csv", "");
+  if (options.threads == 0) {
+    throw std::runtime_error("at least one callback thread is needed");
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  Options options;
+  try {
+    if (!parse_command_options(argc, argv, options)) {
+      return 0;
+    }
+  } catch (const std::exception & e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+
+  FILE * output = stdout;
+  if (!options.csv_path.empty()) {
+    output = fopen(options.csv_path.c_str(), "w");
+    if (!output) {
+      fprintf(stderr, "failed to open '%s'\n", options.csv_path.c_str());
+      return 1;
+    }
+  }
+  fprintf(output, "%s", csv_header);
+  fflush(output);
+
+  int exit_code = 0;
+  for (size_t topics : options.topic_counts) {
+    for (double rate : options.rates) {
+      for (size_t size : options.sizes) {
+        Point point {topics, rate, size};
+        if (output != stdout) {
+          fprintf(stderr, "%zu topics at %.1f Hz with %zu bytes\n", topics, rate, size);
+        }
+        auto child = ros1_bridge_benchmark::ChildProcess::fork_function(
+          [&point, &options, output]() -> int
+          {
+            return run_point(point, options, output);
+          });
+        if (child.wait() != 0) {
+          fprintf(stderr, "%zu topics at %.1f Hz with %zu bytes failed\n", topics, rate, size);
+          exit_code = 1;
+        }
+      }
+    }
+  }
+  if (output != stdout) {
+    fclose(output);
+  }
+  return exit_code;
+}
@@ -0,0 +1,352 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BENCHMARK_UTILS_HPP_
+#define BENCHMARK_UTILS_HPP_
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ros1_bridge/command_options.hpp"
+
+// Helpers shared by the benchmarks of the bridge, which only need the standard library and
+// POSIX, so they can also be used before ROS is initialized, e.g. to start a roscore.
+
+namespace ros1_bridge_benchmark
+{
+
+using ros1_bridge::find_command_option;
+using ros1_bridge::get_command_option_value;
+
+/// Get the time of the steady clock, which is the same in all processes of the machine.
+inline uint64_t
+get_steady_time()
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/// Latencies of all measured messages of a path, to report exact percentiles.
+class LatencySamples
+{
+public:
+  void
+  add(uint64_t latency_ns)
+  {
+    samples_.push_back(latency_ns);
+    sorted_ = false;
+  }
+
+  size_t
+  size() const
+  {
+    return samples_.size();
+  }
+
+  /// Get the latency below which the given fraction (0 to 1) of the samples is, in ns.
+  uint64_t
+  get_percentile(double fraction)
+  {
+    if (samples_.empty()) {
+      return 0;
+    }
+    if (!sorted_) {
+      std::sort(samples_.begin(), samples_.end());
+      sorted_ = true;
+    }
+    size_t index = static_cast<size_t>(std::ceil(fraction * samples_.size()));
+    return samples_[index == 0 ? 0 : std::min(index, samples_.size()) - 1];
+  }
+
+  uint64_t
+  get_max()
+  {
+    return get_percentile(1.0);
+  }
+
+  double
+  get_mean() const
+  {
+    if (samples_.empty()) {
+      return 0.0;
+    }
+    double sum = 0.0;
+    for (auto sample : samples_) {
+      sum += static_cast<double>(sample);
+    }
+    return sum / samples_.size();
+  }
+
+  void
+  merge(const LatencySamples & other)
+  {
+    samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+    sorted_ = samples_.empty();
+  }
+
+  void
+  clear()
+  {
+    samples_.clear();
+    sorted_ = true;
+  }
+
+private:
+  std::vector<uint64_t> samples_;
+  bool sorted_ = true;
+};
+
+/// A child process which is stopped when going out of scope.
+class ChildProcess
+{
+public:
+  ChildProcess() = default;
+
+  ChildProcess(const ChildProcess &) = delete;
+  ChildProcess & operator=(const ChildProcess &) = delete;
+
+  ChildProcess(ChildProcess && other)
+  : pid_(other.pid_)
+  {
+    other.pid_ = -1;
+  }
+
+  ChildProcess & operator=(ChildProcess && other)
+  {
+    if (this != &other) {
+      stop();
+      pid_ = other.pid_;
+      other.pid_ = -1;
+    }
+    return *this;
+  }
+
+  ~ChildProcess()
+  {
+    stop();
+  }
+
+  /// Execute a program found in the PATH, optionally discarding its output.
+  static ChildProcess
+  spawn(const std::vector<std::string> & args, bool quiet = false)
+  {
+    ChildProcess child;
+    child.pid_ = fork();
+    if (child.pid_ < 0) {
+      throw std::runtime_error("failed to fork '" + args.front() + "'");
+    }
+    if (child.pid_ == 0) {
+      if (quiet) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        close(null_fd);
+      }
+      std::vector<char *> argv;
+      for (const auto & arg : args) {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+      }
+      argv.push_back(nullptr);
+      execvp(argv[0], argv.data());
+      fprintf(stderr, "failed to execute '%s'\n", argv[0]);
+      _exit(127);
+    }
+    return child;
+  }
+
+  /// Run a function in a forked process, which must happen before any thread is started.
+  static ChildProcess
+  fork_function(const std::function<int()> & function)
+  {
+    ChildProcess child;
+    child.pid_ = fork();
+    if (child.pid_ < 0) {
+      throw std::runtime_error("failed to fork");
+    }
+    if (child.pid_ == 0) {
+      int exit_code = 1;
+      try {
+        exit_code = function();
+      } catch (const std::exception & e) {
+        fprintf(stderr, "%s\n", e.what());
+      }
+      _exit(exit_code);
+    }
+    return child;
+  }
+
+  pid_t
+  get_pid() const
+  {
+    return pid_;
+  }
+
+  bool
+  is_running()
+  {
+    if (pid_ <= 0) {
+      return false;
+    }
+    if (waitpid(pid_, nullptr, WNOHANG) == pid_) {
+      pid_ = -1;
+      return false;
+    }
+    return true;
+  }
+
+  /// Wait for the process to exit and get its exit code, or -1 if it didn't exit normally.
+  int
+  wait()
+  {
+    if (pid_ <= 0) {
+      return -1;
+    }
+    int status = 0;
+    waitpid(pid_, &status, 0);
+    pid_ = -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  }
+
+  /// Interrupt the process like Ctrl-C and kill it if it doesn't exit within the grace period.
+  void
+  stop(std::chrono::milliseconds grace_period = std::chrono::seconds(10))
+  {
+    if (pid_ <= 0) {
+      return;
+    }
+    kill(pid_, SIGINT);
+    auto deadline = std::chrono::steady_clock::now() + grace_period;
+    while (waitpid(pid_, nullptr, WNOHANG) == 0) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        kill(pid_, SIGKILL);
+        waitpid(pid_, nullptr, 0);
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    pid_ = -1;
+  }
+
+private:
+  pid_t pid_ = -1;
+};
+
+/// Resources used by a process.
+struct ProcessUsage
+{
+  uint64_t rss_bytes;
+  uint64_t threads;
+  uint64_t file_descriptors;
+};
+
+/// Read the resident memory, the threads and the open file descriptors of a process.
+inline ProcessUsage
+read_process_usage(pid_t pid)
+{
+  ProcessUsage usage = {0, 0, 0};
+  std::string proc_path = "/proc/" + std::to_string(pid);
+  FILE * status = fopen((proc_path + "/status").c_str(), "r");
+  if (status) {
+    char line[256];
+    while (fgets(line, sizeof(line), status)) {
+      unsigned long long value;  // NOLINT(runtime/int)
+      if (sscanf(line, "VmRSS: %llu kB", &value) == 1) {
+        usage.rss_bytes = value * 1024;
+      } else if (sscanf(line, "Threads: %llu", &value) == 1) {
+        usage.threads = value;
+      }
+    }
+    fclose(status);
+  }
+  DIR * fds = opendir((proc_path + "/fd").c_str());
+  if (fds) {
+    while (dirent * entry = readdir(fds)) {
+      if (entry->d_name[0] != '.') {
+        ++usage.file_descriptors;
+      }
+    }
+    closedir(fds);
+  }
+  return usage;
+}
+
+/// Wait until a TCP port of the local machine accepts connections.
+inline bool
+wait_for_local_port(uint16_t port, std::chrono::milliseconds timeout)
+{
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (std::chrono::steady_clock::now() < deadline) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+      return false;
+    }
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bool connected = connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+    close(fd);
+    if (connected) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  return false;
+}
+
+/// Start a roscore on a port of the local machine and point ROS_MASTER_URI at it.
+/**
+ * The environment is changed before any process is forked, so all processes of the benchmark
+ * use the same master.
+ */
+inline ChildProcess
+start_roscore(uint16_t port)
+{
+  std::string master_uri = "http://localhost:" + std::to_string(port) + "/";
+  setenv("ROS_MASTER_URI", master_uri.c_str(), 1);
+  if (wait_for_local_port(port, std::chrono::milliseconds(0))) {
+    throw std::runtime_error(
+            "port " + std::to_string(port) + " is already in use, use another master port");
+  }
+  auto roscore = ChildProcess::spawn({"roscore", "-p", std::to_string(port)}, true);
+  if (!wait_for_local_port(port, std::chrono::seconds(30))) {
+    throw std::runtime_error("the roscore didn't start within 30 seconds");
+  }
+  return roscore;
+}
+
+}  // namespace ros1_bridge_benchmark
+
+#endif  // BENCHMARK_UTILS_HPP_
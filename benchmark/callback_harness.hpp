@@ -0,0 +1,201 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CALLBACK_HARNESS_HPP_
+#define CALLBACK_HARNESS_HPP_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/make_shared.hpp>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "ros/message_event.h"
+#include "ros/message_traits.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+#include "rmw/rmw.h"
+
+#include "ros1_bridge/factory.hpp"
+#include "ros1_bridge/topic_statistics.hpp"
+
+// Drive the message callbacks of the generic Factory without any middleware:
+// the inputs are constructed once like the middlewares would pass them and the converted
+// messages are handed to publishers which only count them.
+// Everything the bridge does per message is included (the connection header lookup, the GID
+// compare, the allocation and conversion of the message and the statistics), nothing else.
+
+namespace ros1_bridge_benchmark
+{
+
+template<typename ROS2_T>
+class CountingRos2Publisher
+{
+public:
+  void publish(std::unique_ptr<ROS2_T> & msg)
+  {
+    msg.reset();
+    ++count;
+  }
+
+  void publish(const std::shared_ptr<const ROS2_T> &)
+  {
+    ++count;
+  }
+
+  size_t count = 0;
+};
+
+template<typename ROS1_T>
+class CountingRos1Publisher
+{
+public:
+  void publish(const boost::shared_ptr<ROS1_T> &) const
+  {
+    ++count;
+  }
+
+  /// Publish a message by reference like the hand-written bridges do.
+  void publish(const ROS1_T &) const
+  {
+    ++count;
+  }
+
+  mutable size_t count = 0;
+};
+
+template<typename ROS1_T, typename ROS2_T>
+class FactoryHarness : public ros1_bridge::Factory<ROS1_T, ROS2_T>
+{
+public:
+  using ros1_bridge::Factory<ROS1_T, ROS2_T>::ros1_callback_impl;
+  using ros1_bridge::Factory<ROS1_T, ROS2_T>::ros2_callback_impl;
+};
+
+/// Pass the same ROS 1 message to the ROS 1 callback of a factory again and again.
+template<typename ROS1_T, typename ROS2_T>
+class Callback1to2Driver
+{
+public:
+  Callback1to2Driver(
+    const ROS1_T & ros1_msg, std::shared_ptr<ros1_bridge::TopicStatistics> statistics,
+    size_t publisher_count = 1)
+  : Callback1to2Driver(
+      boost::make_shared<ROS1_T const>(ros1_msg), std::move(statistics), publisher_count)
+  {}
+
+  /// Pass a message which can be shared by several drivers, e.g. to measure their memory.
+  Callback1to2Driver(
+    const boost::shared_ptr<ROS1_T const> & ros1_msg,
+    std::shared_ptr<ros1_bridge::TopicStatistics> statistics, size_t publisher_count = 1)
+  : statistics_(std::move(statistics)),
+    type_name_(ros::message_traits::datatype<ROS1_T>()),
+    logger_(rclcpp::get_logger("ros1_bridge_benchmark"))
+  {
+    // the connection header of a message from another node, which is looked up every time
+    auto connection_header = boost::make_shared<ros::M_string>();
+    (*connection_header)["callerid"] = "/benchmark_talker";
+    (*connection_header)["topic"] = "/benchmark";
+    (*connection_header)["type"] = type_name_;
+    event_ = ros::MessageEvent<ROS1_T const>(ros1_msg, connection_header, ros::Time());
+    for (size_t i = 0; i < publisher_count; ++i) {
+      ros2_pubs_.push_back(std::make_shared<CountingRos2Publisher<ROS2_T>>());
+    }
+  }
+
+  void operator()()
+  {
+    FactoryHarness<ROS1_T, ROS2_T>::ros1_callback_impl(
+      event_, ros2_pubs_, type_name_, type_name_, logger_, statistics_);
+  }
+
+  size_t get_published() const
+  {
+    return ros2_pubs_.front()->count;
+  }
+
+private:
+  std::shared_ptr<ros1_bridge::TopicStatistics> statistics_;
+  std::string type_name_;
+  rclcpp::Logger logger_;
+  ros::MessageEvent<ROS1_T const> event_;
+  std::vector<std::shared_ptr<CountingRos2Publisher<ROS2_T>>> ros2_pubs_;
+};
+
+/// Pass the same ROS 2 message to the ROS 2 callback of a factory again and again.
+/**
+ * With a ROS 2 publisher the GID of every message is compared to it like in the
+ * bidirectional bridges, the publisher itself is never used to publish.
+ */
+template<typename ROS1_T, typename ROS2_T>
+class Callback2to1Driver
+{
+public:
+  Callback2to1Driver(
+    const ROS2_T & ros2_msg, std::shared_ptr<ros1_bridge::TopicStatistics> statistics,
+    rclcpp::PublisherBase::SharedPtr ros2_pub = nullptr)
+  : Callback2to1Driver(
+      std::make_shared<ROS2_T>(ros2_msg), std::move(statistics), std::move(ros2_pub))
+  {}
+
+  /// Pass a message which can be shared by several drivers, e.g. to measure their memory.
+  Callback2to1Driver(
+    const typename ROS2_T::SharedPtr & ros2_msg,
+    std::shared_ptr<ros1_bridge::TopicStatistics> statistics,
+    rclcpp::PublisherBase::SharedPtr ros2_pub = nullptr)
+  : statistics_(std::move(statistics)),
+    type_name_(ros::message_traits::datatype<ROS1_T>()),
+    logger_(rclcpp::get_logger("ros1_bridge_benchmark")),
+    ros2_msg_(ros2_msg),
+    msg_info_(),
+    ros2_pub_(std::move(ros2_pub))
+  {
+    // a GID of the same rmw implementation, which differs from the one of any publisher
+    msg_info_.publisher_gid.implementation_identifier = rmw_get_implementation_identifier();
+  }
+
+  void operator()()
+  {
+    FactoryHarness<ROS1_T, ROS2_T>::ros2_callback_impl(
+      ros2_msg_, msg_info_, ros1_pub_, type_name_, type_name_, logger_, ros2_pub_, statistics_);
+  }
+
+  size_t get_published() const
+  {
+    return ros1_pub_.count;
+  }
+
+private:
+  std::shared_ptr<ros1_bridge::TopicStatistics> statistics_;
+  std::string type_name_;
+  rclcpp::Logger logger_;
+  typename ROS2_T::SharedPtr ros2_msg_;
+  rmw_message_info_t msg_info_;
+  rclcpp::PublisherBase::SharedPtr ros2_pub_;
+  CountingRos1Publisher<ROS1_T> ros1_pub_;
+};
+
+}  // namespace ros1_bridge_benchmark
+
+#endif  // CALLBACK_HARNESS_HPP_
@@ -0,0 +1,132 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__ALLOCATION_ACCOUNTING_HPP_
+#define ROS1_BRIDGE__ALLOCATION_ACCOUNTING_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Heap allocation accounting of the message callbacks.
+// When building with ROS1_BRIDGE_ENABLE_ALLOCATION_ACCOUNTING the library replaces the global
+// operator new and counts the allocations of every thread, and the callbacks of the bridges
+// add the allocations made while passing a message to the statistics of the topic.
+// Additionally every allocation is attributed to the memory account of the bridge whose
+// callback or creation made it, until it is freed by whichever thread.
+// Otherwise nothing is counted and an AllocationScope or MemoryAccountScope costs nothing.
+
+namespace ros1_bridge
+{
+
+#ifdef ROS1_BRIDGE_ENABLE_ALLOCATION_ACCOUNTING
+constexpr bool allocation_accounting_enabled = true;
+#else
+constexpr bool allocation_accounting_enabled = false;
+#endif
+
+struct AllocationCounts
+{
+  uint64_t allocations;
+  uint64_t bytes;
+};
+
+/// Get the number and size of the heap allocations of the calling thread so far.
+AllocationCounts
+get_thread_allocation_counts();
+
+/// Measure the heap allocations of the calling thread from construction on.
+class AllocationScope
+{
+public:
+  AllocationScope()
+  : start_(allocation_accounting_enabled ? get_thread_allocation_counts() : AllocationCounts {0, 0})
+  {}
+
+  AllocationCounts
+  get_counts() const
+  {
+    if (!allocation_accounting_enabled) {
+      return AllocationCounts {0, 0};
+    }
+    AllocationCounts now = get_thread_allocation_counts();
+    return AllocationCounts {now.allocations - start_.allocations, now.bytes - start_.bytes};
+  }
+
+private:
+  AllocationCounts start_;
+};
+
+/// Heap memory held by the allocations attributed to the bridges of one topic and direction.
+/**
+ * Accounts are never destroyed, so memory which outlives its bridge is still accounted,
+ * e.g. of a leaked bridge or of messages still queued when the bridge was destroyed.
+ */
+struct MemoryAccount
+{
+  std::string direction;
+  std::string topic_name;
+  std::atomic<int64_t> held_bytes;
+  std::atomic<int64_t> held_blocks;
+};
+
+struct MemoryUsage
+{
+  std::string direction;
+  std::string topic_name;
+  int64_t held_bytes;
+  int64_t held_blocks;
+};
+
+/// Get the account of a topic and direction, a null pointer unless accounting is enabled.
+MemoryAccount *
+get_memory_account(const std::string & direction, const std::string & topic_name);
+
+/// Get the memory held by all accounts, ordered by direction and topic.
+std::vector<MemoryUsage>
+get_memory_usage();
+
+/// Attribute the following allocations of the calling thread to an account (or none).
+/**
+ * \return the previous account of the thread
+ */
+MemoryAccount *
+set_thread_memory_account(MemoryAccount * account);
+
+/// Attribute the heap allocations of the calling thread to an account for a scope.
+class MemoryAccountScope
+{
+public:
+  explicit MemoryAccountScope(MemoryAccount * account)
+  : previous_(allocation_accounting_enabled ? set_thread_memory_account(account) : nullptr)
+  {}
+
+  ~MemoryAccountScope()
+  {
+    if (allocation_accounting_enabled) {
+      set_thread_memory_account(previous_);
+    }
+  }
+
+  MemoryAccountScope(const MemoryAccountScope &) = delete;
+  MemoryAccountScope & operator=(const MemoryAccountScope &) = delete;
+
+private:
+  MemoryAccount * previous_;
+};
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__ALLOCATION_ACCOUNTING_HPP_
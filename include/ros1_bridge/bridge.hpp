@@ -18,6 +18,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 // include ROS 1
 #include "ros/node_handle.h"
@@ -26,6 +27,7 @@
 #include "rclcpp/node.hpp"
 
 #include "ros1_bridge/factory_interface.hpp"
+#include "ros1_bridge/topic_statistics.hpp"
 
 namespace ros1_bridge
 {
@@ -34,12 +36,14 @@ struct Bridge1to2Handles
 {
   ros::Subscriber ros1_subscriber;
   rclcpp::PublisherBase::SharedPtr ros2_publisher;
+  std::shared_ptr<TopicStatistics> statistics;
 };
 
 struct Bridge2to1Handles
 {
   rclcpp::SubscriptionBase::SharedPtr ros2_subscriber;
   ros::Publisher ros1_publisher;
+  std::shared_ptr<TopicStatistics> statistics;
 };
 
 struct BridgeHandles
@@ -48,6 +52,19 @@ struct BridgeHandles
   Bridge2to1Handles bridge2to1;
 };
 
+struct Bridge1toNHandles
+{
+  ros::Subscriber ros1_subscriber;
+  std::vector<rclcpp::PublisherBase::SharedPtr> ros2_publishers;
+  std::shared_ptr<TopicStatistics> statistics;
+};
+
+struct FanOutBridgeHandles
+{
+  Bridge1toNHandles bridge1ton;
+  std::vector<Bridge2to1Handles> bridges2to1;
+};
+
 bool
 get_1to2_mapping(
   const std::string & ros1_type_name,
@@ -95,6 +112,22 @@ create_bridge_from_2_to_1(
   size_t publisher_queue_size,
   rclcpp::PublisherBase::SharedPtr ros2_pub = nullptr);
 
+/// Bridge a ROS 1 topic to a topic of every ROS 2 node and name.
+/**
+ * Each ROS 1 message is converted only once and then published to all ROS 2 topics,
+ * e.g. on nodes in different domains or with different names.
+ */
+Bridge1toNHandles
+create_bridge_from_1_to_n(
+  ros::NodeHandle ros1_node,
+  const std::vector<rclcpp::Node::SharedPtr> & ros2_nodes,
+  const std::string & ros1_type_name,
+  const std::string & ros1_topic_name,
+  size_t subscriber_queue_size,
+  const std::string & ros2_type_name,
+  const std::vector<std::string> & ros2_topic_names,
+  size_t publisher_queue_size);
+
 BridgeHandles
 create_bidirectional_bridge(
   ros::NodeHandle ros1_node,
@@ -104,6 +137,40 @@ create_bidirectional_bridge(
   const std::string & topic_name,
   size_t queue_size = 10);
 
+/// Bridge a topic between ROS 1 and every ROS 2 node and name in both directions.
+FanOutBridgeHandles
+create_fan_out_bridge(
+  ros::NodeHandle ros1_node,
+  const std::vector<rclcpp::Node::SharedPtr> & ros2_nodes,
+  const std::string & ros1_type_name,
+  const std::string & ros2_type_name,
+  const std::string & ros1_topic_name,
+  const std::vector<std::string> & ros2_topic_names,
+  size_t queue_size = 10);
+
+/// Create fan out bridges for all topics listed in a ROS 1 parameter.
+/**
+ * The parameter needs to be an array and each item needs to be a dictionary
+ * with the keys topic, type and optionally queue_size (default: 100) and ros2_topics,
+ * the ROS 2 topic names to use (default: topic).
+ * Bridges which can't be created are reported and skipped.
+ */
+std::vector<FanOutBridgeHandles>
+create_fan_out_bridges_from_parameter(
+  ros::NodeHandle ros1_node,
+  const std::vector<rclcpp::Node::SharedPtr> & ros2_nodes,
+  const std::string & parameter_name);
+
+/// Create bidirectional bridges to a single ROS 2 node for all topics listed in a parameter.
+/**
+ * The format is the same as for create_fan_out_bridges_from_parameter().
+ */
+std::vector<FanOutBridgeHandles>
+create_bridges_from_parameter(
+  ros::NodeHandle ros1_node,
+  rclcpp::Node::SharedPtr ros2_node,
+  const std::string & parameter_name);
+
 }  // namespace ros1_bridge
 
 #endif  // ROS1_BRIDGE__BRIDGE_HPP_
@@ -0,0 +1,100 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__BRIDGE_COMPONENT_HPP_
+#define ROS1_BRIDGE__BRIDGE_COMPONENT_HPP_
+
+#include <memory>
+#include <vector>
+
+// include ROS 1
+#include "ros/node_handle.h"
+#include "ros/spinner.h"
+#include "ros/timer.h"
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+
+#include "ros1_bridge/bridge.hpp"
+#include "ros1_bridge/bridge_discovery.hpp"
+#include "ros1_bridge/flight_recorder_service.hpp"
+#include "ros1_bridge/phase_timing_service.hpp"
+#include "ros1_bridge/statistics_publisher.hpp"
+
+namespace ros1_bridge
+{
+
+/// The parameter_bridge as a node which can be loaded into a ROS 2 container.
+/**
+ * The node uses intra process communication, so ROS 2 subscribers in the same
+ * container receive the converted ROS 1 messages without any copy or serialization.
+ * The bridged topics are read from the ROS 1 parameter named by the ROS 2 parameter
+ * `topics_parameter` (default: topics) in the format of the parameter_bridge.
+ * The node is named `ros_bridge`, further instances in the same process `ros_bridge_<n>`, and
+ * can be renamed by remapping `__node`. If ROS 1 hasn't been initialized in the process yet it
+ * is initialized with the name of the node and a unique suffix, otherwise the ROS 1 node of
+ * the process is shared.
+ */
+class BridgeComponent : public rclcpp::Node
+{
+public:
+  BridgeComponent();
+
+  virtual ~BridgeComponent();
+
+private:
+  void
+  create_bridges();
+
+  std::unique_ptr<ros::NodeHandle> ros1_node_;
+  std::unique_ptr<ros::AsyncSpinner> ros1_spinner_;
+  rclcpp::TimerBase::SharedPtr startup_timer_;
+  std::vector<FanOutBridgeHandles> all_handles_;
+  std::unique_ptr<StatisticsPublisher> statistics_publisher_;
+  std::unique_ptr<PhaseTimingService> phase_timing_service_;
+  std::unique_ptr<FlightRecorderService> flight_recorder_service_;
+};
+
+/// The dynamic_bridge as a node which can be loaded into a ROS 2 container.
+/**
+ * The node is named and initializes ROS 1 like the BridgeComponent. The ROS 2 parameters
+ * `bridge_all_1to2_topics`, `bridge_all_2to1_topics` and `show_introspection` correspond to
+ * the options of the dynamic_bridge. Since the ROS 1 node is shared by the whole process, the
+ * ROS 1 publishers and subscribers of other nodes in it are taken for those of the bridge.
+ */
+class DynamicBridgeComponent : public rclcpp::Node
+{
+public:
+  DynamicBridgeComponent();
+
+  virtual ~DynamicBridgeComponent();
+
+private:
+  void
+  start_discovery();
+
+  std::unique_ptr<ros::NodeHandle> ros1_node_;
+  std::unique_ptr<ros::AsyncSpinner> ros1_spinner_;
+  rclcpp::TimerBase::SharedPtr startup_timer_;
+  std::unique_ptr<BridgeDiscovery> discovery_;
+  ros::Timer ros1_poll_timer_;
+  rclcpp::TimerBase::SharedPtr ros2_poll_timer_;
+  std::unique_ptr<StatisticsPublisher> statistics_publisher_;
+  std::unique_ptr<PhaseTimingService> phase_timing_service_;
+  std::unique_ptr<FlightRecorderService> flight_recorder_service_;
+};
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__BRIDGE_COMPONENT_HPP_
@@ -0,0 +1,100 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__BRIDGE_DISCOVERY_HPP_
+#define ROS1_BRIDGE__BRIDGE_DISCOVERY_HPP_
+
+#include <map>
+#include <set>
+#include <string>
+
+// include ROS 1
+#include "ros/node_handle.h"
+#include "ros/timer.h"
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+
+#include "ros1_bridge/bridge.hpp"
+#include "ros1_bridge/instrumented_mutex.hpp"
+
+namespace ros1_bridge
+{
+
+/// The discovery of the dynamic_bridge, bridging the topics and services used on both sides.
+/**
+ * poll_ros1() and poll_ros2() query the ROS 1 master and the ROS 2 graph and create and
+ * remove the bridges accordingly. They are meant to be called by a timer of the ROS 1 and
+ * the ROS 2 node, both take the same mutex, so they may be called from different threads.
+ * All endpoints of the ROS 1 node of the process are regarded as endpoints of the bridge.
+ */
+class BridgeDiscovery
+{
+public:
+  BridgeDiscovery(
+    ros::NodeHandle ros1_node, rclcpp::Node::SharedPtr ros2_node,
+    bool output_topic_introspection, bool bridge_all_1to2_topics, bool bridge_all_2to1_topics);
+
+  void
+  poll_ros1(const ros::TimerEvent &);
+
+  void
+  poll_ros2();
+
+private:
+  struct Bridge1to2HandlesAndMessageTypes
+  {
+    Bridge1to2Handles bridge_handles;
+    std::string ros1_type_name;
+    std::string ros2_type_name;
+  };
+
+  struct Bridge2to1HandlesAndMessageTypes
+  {
+    Bridge2to1Handles bridge_handles;
+    std::string ros1_type_name;
+    std::string ros2_type_name;
+  };
+
+  void
+  update_bridge();
+
+  ros::NodeHandle ros1_node_;
+  rclcpp::Node::SharedPtr ros2_node_;
+  const bool output_topic_introspection_;
+  const bool bridge_all_1to2_topics_;
+  const bool bridge_all_2to1_topics_;
+
+  InstrumentedMutex bridge_mutex_;
+  // mapping of available topic names to type names
+  std::map<std::string, std::string> ros1_publishers_;
+  std::map<std::string, std::string> ros1_subscribers_;
+  std::map<std::string, std::string> ros2_publishers_;
+  std::map<std::string, std::string> ros2_subscribers_;
+  std::map<std::string, std::map<std::string, std::string>> ros1_services_;
+  std::map<std::string, std::map<std::string, std::string>> ros2_services_;
+
+  std::map<std::string, Bridge1to2HandlesAndMessageTypes> bridges_1to2_;
+  std::map<std::string, Bridge2to1HandlesAndMessageTypes> bridges_2to1_;
+  std::map<std::string, ServiceBridge1to2> service_bridges_1_to_2_;
+  std::map<std::string, ServiceBridge2to1> service_bridges_2_to_1_;
+
+  // only accessed by poll_ros2()
+  std::set<std::string> already_ignored_topics_;
+  std::set<std::string> already_ignored_services_;
+};
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__BRIDGE_DISCOVERY_HPP_
@@ -0,0 +1,71 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__BRIDGE_NODELET_HPP_
+#define ROS1_BRIDGE__BRIDGE_NODELET_HPP_
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "nodelet/nodelet.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+
+#include "ros1_bridge/bridge.hpp"
+#include "ros1_bridge/flight_recorder_service.hpp"
+#include "ros1_bridge/phase_timing_service.hpp"
+#include "ros1_bridge/statistics_publisher.hpp"
+
+namespace ros1_bridge
+{
+
+/// The parameter_bridge as a nodelet which can be loaded into a ROS 1 nodelet manager.
+/**
+ * Messages from ROS 2 are published as shared pointers and reach other nodelets in the
+ * same manager without serialization, as do messages which those nodelets publish as
+ * shared pointers for ROS 2.
+ * The bridged topics are read from the private parameter `topics` in the format of the
+ * parameter_bridge. The ROS 2 node is spun by a thread owned by the nodelet.
+ */
+class BridgeNodelet : public nodelet::Nodelet
+{
+public:
+  ~BridgeNodelet();
+
+private:
+  void onInit() override;
+
+  rclcpp::Node::SharedPtr ros2_node_;
+  std::vector<FanOutBridgeHandles> all_handles_;
+  std::unique_ptr<StatisticsPublisher> statistics_publisher_;
+  std::unique_ptr<PhaseTimingService> phase_timing_service_;
+  std::unique_ptr<FlightRecorderService> flight_recorder_service_;
+  std::atomic<bool> running_{false};
+  std::thread ros2_thread_;
+};
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__BRIDGE_NODELET_HPP_
@@ -0,0 +1,45 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__BRIDGE_SERVICES_HPP_
+#define ROS1_BRIDGE__BRIDGE_SERVICES_HPP_
+
+#include <string>
+
+namespace ros1_bridge
+{
+
+/// The services every bridge offers below its node name.
+extern const char * const phase_timing_service_name;
+extern const char * const flight_recorder_service_name;
+
+/// Remember a service offered by a bridge of this process by its fully qualified name.
+void
+register_bridge_service(const std::string & service_name);
+
+/// Forget a service registered before, e.g. when the bridge is unloaded from a container.
+void
+unregister_bridge_service(const std::string & service_name);
+
+/// Check if a service is offered by a bridge of this process, which must never be bridged.
+/**
+ * Services of other nodes with the same name, e.g. a phase_timing service of an application,
+ * are bridged like any other service.
+ */
+bool
+is_bridge_service(const std::string & service_name);
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__BRIDGE_SERVICES_HPP_
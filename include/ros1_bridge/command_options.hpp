@@ -0,0 +1,134 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__COMMAND_OPTIONS_HPP_
+#define ROS1_BRIDGE__COMMAND_OPTIONS_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Parsing of the "--option value" style command line options of the bridge executables,
+// the tools and the benchmarks, which is header only since not all of them link the library.
+
+namespace ros1_bridge
+{
+
+inline bool
+find_command_option(const std::vector<std::string> & args, const std::string & option)
+{
+  return std::find(args.begin(), args.end(), option) != args.end();
+}
+
+inline std::string
+get_command_option_value(
+  const std::vector<std::string> & args, const std::string & option,
+  const std::string & default_value)
+{
+  auto it = std::find(args.begin(), args.end(), option);
+  if (it == args.end() || std::next(it) == args.end()) {
+    return default_value;
+  }
+  return *std::next(it);
+}
+
+/// Parse a number, false unless the whole text is a number in the range of the type.
+inline bool
+parse_number(const std::string & text, double & value)
+{
+  size_t end = 0;
+  try {
+    value = std::stod(text, &end);
+  } catch (std::logic_error &) {
+    return false;
+  }
+  return end == text.size();
+}
+
+inline bool
+parse_number(const std::string & text, int & value)
+{
+  size_t end = 0;
+  try {
+    value = std::stoi(text, &end);
+  } catch (std::logic_error &) {
+    return false;
+  }
+  return end == text.size();
+}
+
+inline bool
+parse_number(const std::string & text, size_t & value)
+{
+  // std::stoull silently negates a leading minus
+  if (text.find('-') != std::string::npos) {
+    return false;
+  }
+  size_t end = 0;
+  unsigned long long number;  // NOLINT(runtime/int)
+  try {
+    number = std::stoull(text, &end);
+  } catch (std::logic_error &) {
+    return false;
+  }
+  if (end != text.size() || number > std::numeric_limits<size_t>::max()) {
+    return false;
+  }
+  value = static_cast<size_t>(number);
+  return true;
+}
+
+/// Parse a port number, e.g. of --metrics-port, which must be in [0, 65535].
+inline bool
+parse_number(const std::string & text, uint16_t & value)
+{
+  size_t number;
+  if (!parse_number(text, number) || number > std::numeric_limits<uint16_t>::max()) {
+    return false;
+  }
+  value = static_cast<uint16_t>(number);
+  return true;
+}
+
+/// Get the number following an option or the default value if the option isn't given.
+/**
+ * \return false after printing an error if the value isn't a number of the type
+ */
+template<typename T>
+bool
+get_command_option_number(
+  const std::vector<std::string> & args, const std::string & option, T default_value,
+  T & value)
+{
+  auto it = std::find(args.begin(), args.end(), option);
+  if (it == args.end() || std::next(it) == args.end()) {
+    value = default_value;
+    return true;
+  }
+  if (!parse_number(*std::next(it), value)) {
+    fprintf(stderr, "Invalid value of %s: '%s'\n", option.c_str(), std::next(it)->c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__COMMAND_OPTIONS_HPP_
@@ -0,0 +1,122 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__DISCOVERY_STATISTICS_HPP_
+#define ROS1_BRIDGE__DISCOVERY_STATISTICS_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ros1_bridge/duration_histogram.hpp"
+
+namespace ros1_bridge
+{
+
+/// Timing of the polls of the ROS 1 master or the ROS 2 graph by the dynamic bridges.
+struct DiscoveryStatistics
+{
+  std::string side;
+  uint64_t cycles;
+  DurationHistogram::Buckets cycle_time;
+  std::chrono::nanoseconds cycle_time_sum;
+};
+
+/// Record the duration of a discovery cycle of the given side ("ros1" or "ros2").
+void
+add_discovery_cycle(const std::string & side, std::chrono::nanoseconds cycle_time);
+
+/// Get the discovery timings of both sides.
+std::vector<DiscoveryStatistics>
+get_discovery_statistics();
+
+/// Timing of a single kind of call made by the discovery, e.g. of the ROS 1 master.
+struct DiscoveryCallStatistics
+{
+  std::string call;
+  uint64_t calls;
+  DurationHistogram::Buckets call_time;
+  std::chrono::nanoseconds call_time_sum;
+};
+
+/// Record the duration of a call made by the discovery.
+void
+add_discovery_call(const std::string & call, std::chrono::nanoseconds call_time);
+
+/// Get the timings of all calls made by the discovery so far.
+std::vector<DiscoveryCallStatistics>
+get_discovery_call_statistics();
+
+/// Measure the time from construction to destruction as a call made by the discovery.
+class DiscoveryCallTimer
+{
+public:
+  explicit DiscoveryCallTimer(const char * call)
+  : call_(call),
+    start_(std::chrono::steady_clock::now())
+  {}
+
+  ~DiscoveryCallTimer()
+  {
+    add_discovery_call(call_, std::chrono::steady_clock::now() - start_);
+  }
+
+private:
+  const char * call_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/// Outcomes of the dynamic bridges managing a bridge.
+enum class BridgeLifecycleEvent
+{
+  CREATED,
+  REPLACED,
+  FAILED,
+  REMOVED,
+  EVENT_COUNT
+};
+
+const char *
+get_bridge_lifecycle_event_name(BridgeLifecycleEvent event);
+
+/// Counts of the lifecycle events of the bridges of one kind ("topic" or "service") and direction.
+struct BridgeLifecycleStatistics
+{
+  std::string kind;
+  std::string direction;
+  std::array<uint64_t, static_cast<size_t>(BridgeLifecycleEvent::EVENT_COUNT)> events;
+  DurationHistogram::Buckets creation_time;
+  std::chrono::nanoseconds creation_time_sum;
+};
+
+/// Count a lifecycle event of a bridge.
+/**
+ * The creation time, including the creation of the ROS 1 and ROS 2 entities, is recorded for
+ * created, replaced and failed bridges.
+ */
+void
+add_bridge_lifecycle_event(
+  const std::string & kind, const std::string & direction, BridgeLifecycleEvent event,
+  std::chrono::nanoseconds creation_time = std::chrono::nanoseconds(0));
+
+/// Get the lifecycle events of all kinds and directions of bridges so far.
+std::vector<BridgeLifecycleStatistics>
+get_bridge_lifecycle_statistics();
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__DISCOVERY_STATISTICS_HPP_
@@ -0,0 +1,68 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__DURATION_HISTOGRAM_HPP_
+#define ROS1_BRIDGE__DURATION_HISTOGRAM_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ros1_bridge
+{
+
+/// Histogram of durations with one bucket per power of two nanoseconds.
+/**
+ * Adding a sample is lock-free and wait-free, so it can be used in the message callbacks.
+ */
+class DurationHistogram
+{
+public:
+  static constexpr size_t bucket_count = 40;
+
+  using Buckets = std::array<uint64_t, bucket_count>;
+
+  DurationHistogram();
+
+  void
+  add(std::chrono::nanoseconds duration);
+
+  void
+  reset();
+
+  Buckets
+  get_buckets() const;
+
+  /// Get the sum of all added durations.
+  std::chrono::nanoseconds
+  get_sum() const;
+
+  /// Get the upper bound of the bucket containing the given quantile (0..1) of the samples.
+  static std::chrono::nanoseconds
+  get_quantile(const Buckets & buckets, double quantile);
+
+  /// Get the upper bound of the highest non empty bucket.
+  static std::chrono::nanoseconds
+  get_max(const Buckets & buckets);
+
+private:
+  std::array<std::atomic<uint64_t>, bucket_count> buckets_;
+  std::atomic<uint64_t> sum_;
+};
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__DURATION_HISTOGRAM_HPP_
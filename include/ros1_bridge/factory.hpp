@@ -15,25 +15,115 @@
 #ifndef  ROS1_BRIDGE__FACTORY_HPP_
 #define  ROS1_BRIDGE__FACTORY_HPP_
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include <boost/make_shared.hpp>
 
+#include "rcutils/time.h"
 #include "rmw/rmw.h"
 #include "rclcpp/rclcpp.hpp"
 
 // include ROS 1 message event
 #include "ros/message.h"
+#include "ros/subscription_callback_helper.h"
+#include "ros/serialization.h"
+#include "ros/service_traits.h"
 #include "ros/this_node.h"
+#include "ros/time.h"
 
 #include "rcutils/logging_macros.h"
 
+#include "ros1_bridge/allocation_accounting.hpp"
 #include "ros1_bridge/factory_interface.hpp"
+#include "ros1_bridge/loopback_filter.hpp"
+#include "ros1_bridge/tracepoints.hpp"
+#include "ros1_bridge/traffic_recorder.hpp"
 
 namespace ros1_bridge
 {
 
+/// Subscription callback helper which also times the deserialization of ROS 1 messages.
+/**
+ * Messages from publishers in the same process are passed without deserialization.
+ */
+template<typename ROS1_T>
+class TimedSubscriptionCallbackHelper
+  : public ros::SubscriptionCallbackHelperT<const ros::MessageEvent<ROS1_T const> &>
+{
+public:
+  using Base = ros::SubscriptionCallbackHelperT<const ros::MessageEvent<ROS1_T const> &>;
+
+  TimedSubscriptionCallbackHelper(
+    const typename Base::Callback & callback, std::shared_ptr<TopicStatistics> statistics)
+  : Base(callback),
+    statistics_(statistics)
+  {}
+
+  ros::VoidConstPtr
+  deserialize(const ros::SubscriptionCallbackHelperDeserializeParams & params) override
+  {
+    PhaseTimer phase_timer(statistics_.get());
+    MemoryAccountScope memory_account_scope(
+      statistics_ ? statistics_->get_memory_account() : nullptr);
+    ros::VoidConstPtr msg = Base::deserialize(params);
+    phase_timer.end_phase(TopicStatistics::DESERIALIZATION);
+    return msg;
+  }
+
+private:
+  std::shared_ptr<TopicStatistics> statistics_;
+};
+
+/// Get the time since roscpp received a ROS 1 message, including its deserialization.
+/**
+ * The receipt time is stamped with the ROS time, so nothing is measured with simulated time.
+ */
+template<typename ROS1_T>
+bool
+get_scheduling_delay(
+  const ros::MessageEvent<ROS1_T const> & ros1_msg_event, std::chrono::nanoseconds & delay)
+{
+  const ros::Time & receipt_time = ros1_msg_event.getReceiptTime();
+  if (receipt_time.isZero() || ros::Time::isSimTime()) {
+    return false;
+  }
+  delay = std::chrono::nanoseconds((ros::Time::now() - receipt_time).toNSec());
+  return true;
+}
+
+// only newer rmw versions stamp the message info with the time the message was received
+template<typename MessageInfoT>
+auto
+get_ros2_scheduling_delay(const MessageInfoT & msg_info, std::chrono::nanoseconds & delay, int)
+-> decltype(msg_info.received_timestamp, bool())
+{
+  rcutils_time_point_value_t now;
+  if (msg_info.received_timestamp == 0 || rcutils_system_time_now(&now) != RCUTILS_RET_OK) {
+    return false;
+  }
+  delay = std::chrono::nanoseconds(now - msg_info.received_timestamp);
+  return true;
+}
+
+template<typename MessageInfoT>
+bool
+get_ros2_scheduling_delay(const MessageInfoT &, std::chrono::nanoseconds &, long)
+{
+  return false;
+}
+
+/// Get the time since the rmw received a ROS 2 message, if the rmw provides the time.
+inline
+bool
+get_scheduling_delay(const rmw_message_info_t & msg_info, std::chrono::nanoseconds & delay)
+{
+  return get_ros2_scheduling_delay(msg_info, delay, 0);
+}
+
 template<typename ROS1_T, typename ROS2_T>
 class Factory : public FactoryInterface
 {
@@ -80,19 +170,49 @@ public:
     const std::string & topic_name,
     size_t queue_size,
     rclcpp::PublisherBase::SharedPtr ros2_pub,
-    rclcpp::Logger logger)
+    rclcpp::Logger logger,
+    std::shared_ptr<TopicStatistics> statistics = nullptr)
   {
+    return create_ros1_subscriber(
+      node, topic_name, queue_size, std::vector<rclcpp::PublisherBase::SharedPtr>{ros2_pub},
+      logger, statistics);
+  }
+
+  ros::Subscriber
+  create_ros1_subscriber(
+    ros::NodeHandle node,
+    const std::string & topic_name,
+    size_t queue_size,
+    const std::vector<rclcpp::PublisherBase::SharedPtr> & ros2_pubs,
+    rclcpp::Logger logger,
+    std::shared_ptr<TopicStatistics> statistics = nullptr)
+  {
+    std::vector<typename rclcpp::Publisher<ROS2_T>::SharedPtr> typed_ros2_pubs;
+    for (const auto & ros2_pub : ros2_pubs) {
+      auto typed_ros2_pub =
+        std::dynamic_pointer_cast<typename rclcpp::Publisher<ROS2_T>>(ros2_pub);
+      if (!typed_ros2_pub) {
+        throw std::runtime_error(
+                "Invalid type " + ros2_type_name_ + " for ROS 2 publisher " +
+                ros2_pub->get_topic_name());
+      }
+      typed_ros2_pubs.push_back(typed_ros2_pub);
+    }
+
     // workaround for https://github.com/ros/roscpp_core/issues/22 to get the connection header
     ros::SubscribeOptions ops;
     ops.topic = topic_name;
     ops.queue_size = queue_size;
     ops.md5sum = ros::message_traits::md5sum<ROS1_T>();
     ops.datatype = ros::message_traits::datatype<ROS1_T>();
+    auto loopback_filter = get_ros1_loopback_filter(node.resolveName(topic_name));
     ops.helper = ros::SubscriptionCallbackHelperPtr(
-      new ros::SubscriptionCallbackHelperT<const ros::MessageEvent<ROS1_T const> &>(
+      new TimedSubscriptionCallbackHelper<ROS1_T>(
         boost::bind(
           &Factory<ROS1_T, ROS2_T>::ros1_callback,
-          _1, ros2_pub, ros1_type_name_, ros2_type_name_, logger)));
+          _1, typed_ros2_pubs, ros1_type_name_, ros2_type_name_, logger, statistics,
+          loopback_filter),
+        statistics));
     return node.subscribe(ops);
   }
 
@@ -102,11 +222,13 @@ public:
     const std::string & topic_name,
     size_t queue_size,
     ros::Publisher ros1_pub,
-    rclcpp::PublisherBase::SharedPtr ros2_pub = nullptr)
+    rclcpp::PublisherBase::SharedPtr ros2_pub = nullptr,
+    std::shared_ptr<TopicStatistics> statistics = nullptr)
   {
     rmw_qos_profile_t custom_qos_profile = rmw_qos_profile_sensor_data;
     custom_qos_profile.depth = queue_size;
-    return create_ros2_subscriber(node, topic_name, custom_qos_profile, ros1_pub, ros2_pub);
+    return create_ros2_subscriber(
+      node, topic_name, custom_qos_profile, ros1_pub, ros2_pub, statistics);
   }
 
   rclcpp::SubscriptionBase::SharedPtr
@@ -115,13 +237,15 @@ public:
     const std::string & topic_name,
     const rmw_qos_profile_t & qos,
     ros::Publisher ros1_pub,
-    rclcpp::PublisherBase::SharedPtr ros2_pub = nullptr)
+    rclcpp::PublisherBase::SharedPtr ros2_pub = nullptr,
+    std::shared_ptr<TopicStatistics> statistics = nullptr)
   {
     std::function<
       void(const typename ROS2_T::SharedPtr msg, const rmw_message_info_t & msg_info)> callback;
     callback = std::bind(
       &Factory<ROS1_T, ROS2_T>::ros2_callback, std::placeholders::_1, std::placeholders::_2,
-      ros1_pub, ros1_type_name_, ros2_type_name_, node->get_logger(), ros2_pub);
+      ros1_pub, ros1_type_name_, ros2_type_name_, node->get_logger(), ros2_pub, statistics,
+      get_ros1_loopback_filter(ros1_pub.getTopic()));
     return node->create_subscription<ROS2_T>(
       topic_name, callback, qos, nullptr, true);
   }
@@ -140,48 +264,163 @@ public:
     convert_2_to_1(*typed_ros2_msg, *typed_ros1_msg);
   }
 
+  void
+  publish_serialized_ros1(
+    const ros::Publisher & ros1_pub, const std::vector<uint8_t> & ros1_serialized) override
+  {
+    auto ros1_msg = boost::make_shared<ROS1_T>();
+    deserialize_ros1(ros1_serialized, *ros1_msg);
+    ros1_pub.publish(ros1_msg);
+  }
+
+  void
+  publish_serialized_ros1_to_ros2(
+    rclcpp::PublisherBase::SharedPtr ros2_pub,
+    const std::vector<uint8_t> & ros1_serialized) override
+  {
+    auto typed_ros2_pub = std::dynamic_pointer_cast<typename rclcpp::Publisher<ROS2_T>>(ros2_pub);
+    if (!typed_ros2_pub) {
+      throw std::runtime_error(
+              "Invalid type " + ros2_type_name_ + " for ROS 2 publisher " +
+              ros2_pub->get_topic_name());
+    }
+    ROS1_T ros1_msg;
+    deserialize_ros1(ros1_serialized, ros1_msg);
+    ROS2_T ros2_msg;
+    convert_1_to_2(ros1_msg, ros2_msg);
+    typed_ros2_pub->publish(ros2_msg);
+  }
+
 protected:
+  static
+  void
+  deserialize_ros1(const std::vector<uint8_t> & ros1_serialized, ROS1_T & ros1_msg)
+  {
+    ros::serialization::IStream stream(
+      const_cast<uint8_t *>(ros1_serialized.data()), static_cast<uint32_t>(ros1_serialized.size()));
+    ros::serialization::deserialize(stream, ros1_msg);
+  }
+
   static
   void ros1_callback(
     const ros::MessageEvent<ROS1_T const> & ros1_msg_event,
-    rclcpp::PublisherBase::SharedPtr ros2_pub,
+    const std::vector<typename rclcpp::Publisher<ROS2_T>::SharedPtr> & typed_ros2_pubs,
     const std::string & ros1_type_name,
     const std::string & ros2_type_name,
-    rclcpp::Logger logger)
+    rclcpp::Logger logger,
+    const std::shared_ptr<TopicStatistics> & statistics,
+    const std::shared_ptr<Ros1LoopbackFilter> & loopback_filter)
   {
-    typename rclcpp::Publisher<ROS2_T>::SharedPtr typed_ros2_pub;
-    typed_ros2_pub =
-      std::dynamic_pointer_cast<typename rclcpp::Publisher<ROS2_T>>(ros2_pub);
+    ros1_callback_impl(
+      ros1_msg_event, typed_ros2_pubs, ros1_type_name, ros2_type_name, logger, statistics,
+      loopback_filter.get());
+  }
 
-    if (!typed_ros2_pub) {
-      throw std::runtime_error(
-              "Invalid type " + ros2_type_name + " for ROS 2 publisher " +
-              ros2_pub->get_topic_name());
+  /// Pass a ROS 1 message to ROS 2 publishers.
+  /**
+   * The publishers only need to provide publish(std::unique_ptr<ROS2_T> &) and
+   * publish(const std::shared_ptr<const ROS2_T> &), so the callback can also be driven
+   * without a middleware, e.g. to measure its allocations.
+   * Without a loopback filter the messages of the bridge are recognized by the caller id.
+   */
+  template<typename ROS2PublisherPtrT>
+  static
+  void ros1_callback_impl(
+    const ros::MessageEvent<ROS1_T const> & ros1_msg_event,
+    const std::vector<ROS2PublisherPtrT> & typed_ros2_pubs,
+    const std::string & ros1_type_name,
+    const std::string & ros2_type_name,
+    rclcpp::Logger logger,
+    const std::shared_ptr<TopicStatistics> & statistics,
+    Ros1LoopbackFilter * loopback_filter = nullptr)
+  {
+    std::chrono::nanoseconds scheduling_delay;
+    if (statistics && get_scheduling_delay(ros1_msg_event, scheduling_delay)) {
+      statistics->add_scheduling_delay(scheduling_delay);
     }
+    const boost::shared_ptr<ROS1_T const> & ros1_msg = ros1_msg_event.getConstMessage();
+    const uint32_t ros1_msg_size = statistics || ROS1_BRIDGE_TRACEPOINT_SIZE_ENABLED() ?
+      ros::serialization::serializationLength(*ros1_msg) : 0;
+    ROS1_BRIDGE_TRACEPOINT_MESSAGE_RECEIVED(statistics.get(), ros1_msg_size);
+    PhaseTimer phase_timer(statistics.get());
+    AllocationScope allocation_scope;
+    MemoryAccountScope memory_account_scope(
+      statistics ? statistics->get_memory_account() : nullptr);
 
     const boost::shared_ptr<ros::M_string> & connection_header =
       ros1_msg_event.getConnectionHeaderPtr();
     if (!connection_header) {
       RCLCPP_WARN(logger, "Dropping ROS 1 message %s without connection header", ros1_type_name);
+      if (statistics) {
+        statistics->add_drop();
+      }
       return;
     }
 
-    const auto caller = connection_header->find("callerid");
-    const std::string& node_name = ros::this_node::getName();
-    if (caller != connection_header->end()) {
-      if (caller->second == node_name) {
-        return;
+    // the caller id can't be used when nodelets in the same manager share it with the bridge
+    bool is_loopback;
+    if (loopback_filter) {
+      is_loopback = loopback_filter->is_published(ros1_msg);
+    } else {
+      const auto caller = connection_header->find("callerid");
+      is_loopback =
+        caller != connection_header->end() && caller->second == ros::this_node::getName();
+    }
+    if (is_loopback) {
+      if (statistics) {
+        statistics->add_loopback();
       }
+      return;  // do not publish messages from bridge itself
     }
 
-    const boost::shared_ptr<ROS1_T const> & ros1_msg = ros1_msg_event.getConstMessage();
+    phase_timer.end_phase(TopicStatistics::HEADER_CHECK);
 
-    auto ros2_msg = std::make_shared<ROS2_T>();
-    convert_1_to_2(*ros1_msg, *ros2_msg);
     RCLCPP_INFO_ONCE(
       logger, "Passing message from ROS 1 %s to ROS 2 %s (showing msg only once per type)",
       ros1_type_name, ros2_type_name);
-    typed_ros2_pub->publish(ros2_msg);
+    auto conversion_start = std::chrono::steady_clock::now();
+    decltype(conversion_start) publish_start;
+    if (typed_ros2_pubs.size() == 1) {
+      // a unique message can be handed over to intra process subscriptions without a copy
+      std::unique_ptr<ROS2_T> ros2_msg(new ROS2_T());
+      phase_timer.end_phase(TopicStatistics::ALLOCATION);
+      ROS1_BRIDGE_TRACEPOINT_CONVERSION_START(statistics.get());
+      convert_1_to_2(*ros1_msg, *ros2_msg);
+      ROS1_BRIDGE_TRACEPOINT_CONVERSION_END(statistics.get(), ros1_msg_size);
+      phase_timer.end_phase(TopicStatistics::CONVERSION);
+      publish_start = std::chrono::steady_clock::now();
+      ROS1_BRIDGE_TRACEPOINT_PUBLISH_START(statistics.get(), ros1_msg_size);
+      typed_ros2_pubs.front()->publish(ros2_msg);
+    } else {
+      // convert only once for all publishers (e.g. in different domains)
+      auto ros2_msg = std::make_shared<ROS2_T>();
+      phase_timer.end_phase(TopicStatistics::ALLOCATION);
+      ROS1_BRIDGE_TRACEPOINT_CONVERSION_START(statistics.get());
+      convert_1_to_2(*ros1_msg, *ros2_msg);
+      ROS1_BRIDGE_TRACEPOINT_CONVERSION_END(statistics.get(), ros1_msg_size);
+      phase_timer.end_phase(TopicStatistics::CONVERSION);
+      publish_start = std::chrono::steady_clock::now();
+      ROS1_BRIDGE_TRACEPOINT_PUBLISH_START(statistics.get(), ros1_msg_size);
+      std::shared_ptr<const ROS2_T> const_ros2_msg = ros2_msg;
+      for (const auto & typed_ros2_pub : typed_ros2_pubs) {
+        typed_ros2_pub->publish(const_ros2_msg);
+      }
+    }
+    ROS1_BRIDGE_TRACEPOINT_PUBLISH_END(statistics.get());
+    phase_timer.end_phase(TopicStatistics::PUBLISH);
+    if (statistics) {
+      statistics->add_message(
+        ros1_msg_size,
+        publish_start - conversion_start, std::chrono::steady_clock::now() - publish_start);
+      if (allocation_accounting_enabled) {
+        AllocationCounts allocation_counts = allocation_scope.get_counts();
+        statistics->add_allocations(allocation_counts.allocations, allocation_counts.bytes);
+      }
+    }
+    if (is_traffic_recording()) {
+      record_traffic_message(
+        statistics.get(), ros1_type_name, ros2_type_name, *ros1_msg, ros1_msg_size);
+    }
   }
 
   static
@@ -192,13 +431,52 @@ protected:
     const std::string & ros1_type_name,
     const std::string & ros2_type_name,
     rclcpp::Logger logger,
-    rclcpp::PublisherBase::SharedPtr ros2_pub = nullptr)
+    rclcpp::PublisherBase::SharedPtr ros2_pub = nullptr,
+    std::shared_ptr<TopicStatistics> statistics = nullptr,
+    std::shared_ptr<Ros1LoopbackFilter> loopback_filter = nullptr)
+  {
+    ros2_callback_impl(
+      ros2_msg, msg_info, ros1_pub, ros1_type_name, ros2_type_name, logger, ros2_pub, statistics,
+      loopback_filter.get());
+  }
+
+  /// Pass a ROS 2 message to a ROS 1 publisher.
+  /**
+   * The publisher only needs to provide publish(const boost::shared_ptr<ROS1_T> &) const,
+   * so the callback can also be driven without a ROS 1 master.
+   */
+  template<typename ROS1PublisherT>
+  static
+  void ros2_callback_impl(
+    typename ROS2_T::SharedPtr ros2_msg,
+    const rmw_message_info_t & msg_info,
+    const ROS1PublisherT & ros1_pub,
+    const std::string & ros1_type_name,
+    const std::string & ros2_type_name,
+    rclcpp::Logger logger,
+    rclcpp::PublisherBase::SharedPtr ros2_pub,
+    const std::shared_ptr<TopicStatistics> & statistics,
+    Ros1LoopbackFilter * loopback_filter = nullptr)
   {
+    std::chrono::nanoseconds scheduling_delay;
+    if (statistics && get_scheduling_delay(msg_info, scheduling_delay)) {
+      statistics->add_scheduling_delay(scheduling_delay);
+    }
+    // the serialized size of ROS 2 messages isn't available
+    ROS1_BRIDGE_TRACEPOINT_MESSAGE_RECEIVED(statistics.get(), 0);
+    PhaseTimer phase_timer(statistics.get());
+    AllocationScope allocation_scope;
+    MemoryAccountScope memory_account_scope(
+      statistics ? statistics->get_memory_account() : nullptr);
+
     if (ros2_pub) {
       bool result = false;
       auto ret = rmw_compare_gids_equal(&msg_info.publisher_gid, &ros2_pub->get_gid(), &result);
       if (ret == RMW_RET_OK) {
         if (result) {  // message GID equals to bridge's ROS2 publisher GID
+          if (statistics) {
+            statistics->add_loopback();
+          }
           return;  // do not publish messages from bridge itself
         }
       } else {
@@ -207,13 +485,44 @@ protected:
         throw std::runtime_error(msg);
       }
     }
-
-    ROS1_T ros1_msg;
-    convert_2_to_1(*ros2_msg, ros1_msg);
+    phase_timer.end_phase(TopicStatistics::HEADER_CHECK);
+
+    // a shared message is passed to subscribers in the same process (e.g. nodelets)
+    // without being serialized
+    auto conversion_start = std::chrono::steady_clock::now();
+    boost::shared_ptr<ROS1_T> ros1_msg = boost::make_shared<ROS1_T>();
+    phase_timer.end_phase(TopicStatistics::ALLOCATION);
+    ROS1_BRIDGE_TRACEPOINT_CONVERSION_START(statistics.get());
+    convert_2_to_1(*ros2_msg, *ros1_msg);
+    const uint32_t ros1_msg_size = statistics || ROS1_BRIDGE_TRACEPOINT_SIZE_ENABLED() ?
+      ros::serialization::serializationLength(*ros1_msg) : 0;
+    ROS1_BRIDGE_TRACEPOINT_CONVERSION_END(statistics.get(), ros1_msg_size);
+    phase_timer.end_phase(TopicStatistics::CONVERSION);
     RCLCPP_INFO_ONCE(
       logger, "Passing message from ROS 2 %s to ROS 1 %s (showing msg only once per type)",
       ros2_type_name, ros1_type_name);
+    auto publish_start = std::chrono::steady_clock::now();
+    ROS1_BRIDGE_TRACEPOINT_PUBLISH_START(statistics.get(), ros1_msg_size);
+    if (loopback_filter) {
+      // the bridges of the topic in this process may receive it before publish returns
+      loopback_filter->add_published(ros1_msg);
+    }
     ros1_pub.publish(ros1_msg);
+    ROS1_BRIDGE_TRACEPOINT_PUBLISH_END(statistics.get());
+    phase_timer.end_phase(TopicStatistics::PUBLISH);
+    if (statistics) {
+      statistics->add_message(
+        ros1_msg_size,
+        publish_start - conversion_start, std::chrono::steady_clock::now() - publish_start);
+      if (allocation_accounting_enabled) {
+        AllocationCounts allocation_counts = allocation_scope.get_counts();
+        statistics->add_allocations(allocation_counts.allocations, allocation_counts.bytes);
+      }
+    }
+    if (is_traffic_recording()) {
+      record_traffic_message(
+        statistics.get(), ros1_type_name, ros2_type_name, *ros1_msg, ros1_msg_size);
+    }
   }
 
 public:
@@ -293,10 +602,17 @@ public:
   {
     ServiceBridge1to2 bridge;
     bridge.client = ros2_node->create_client<ROS2_T>(name);
-    auto m = &ServiceFactory<ROS1_T, ROS2_T>::forward_1_to_2;
-    auto f = std::bind(
-      m, this, bridge.client, ros2_node->get_logger(), std::placeholders::_1,
-      std::placeholders::_2);
+    bridge.statistics = register_service_statistics(
+      "1to2", name, ros::service_traits::datatype<ROS1_T>());
+    auto f = [this, client = bridge.client, logger = ros2_node->get_logger(),
+        statistics = bridge.statistics](
+      const ROS1Request & request1, ROS1Response & response1) -> bool
+      {
+        auto start = std::chrono::steady_clock::now();
+        bool success = forward_1_to_2(client, logger, request1, response1);
+        statistics->add_call(success, std::chrono::steady_clock::now() - start);
+        return success;
+      };
     bridge.server = ros1_node.advertiseService<ROS1Request, ROS1Response>(name, f);
     return bridge;
   }
@@ -306,15 +622,27 @@ public:
   {
     ServiceBridge2to1 bridge;
     bridge.client = ros1_node.serviceClient<ROS1_T>(name);
-    auto m = &ServiceFactory<ROS1_T, ROS2_T>::forward_2_to_1;
+    bridge.statistics = register_service_statistics(
+      "2to1", name, ros::service_traits::datatype<ROS1_T>());
     std::function<
       void(
         const std::shared_ptr<rmw_request_id_t>,
         const std::shared_ptr<ROS2Request>,
         std::shared_ptr<ROS2Response>)> f;
-    f = std::bind(
-      m, this, bridge.client, ros2_node->get_logger(), std::placeholders::_1,
-      std::placeholders::_2, std::placeholders::_3);
+    f = [this, client = bridge.client, logger = ros2_node->get_logger(),
+        statistics = bridge.statistics](
+      const std::shared_ptr<rmw_request_id_t> request_header,
+      const std::shared_ptr<ROS2Request> request, std::shared_ptr<ROS2Response> response)
+      {
+        auto start = std::chrono::steady_clock::now();
+        try {
+          forward_2_to_1(client, logger, request_header, request, response);
+        } catch (...) {
+          statistics->add_call(false, std::chrono::steady_clock::now() - start);
+          throw;
+        }
+        statistics->add_call(true, std::chrono::steady_clock::now() - start);
+      };
     bridge.server = ros2_node->create_service<ROS2_T>(name, f);
     return bridge;
   }
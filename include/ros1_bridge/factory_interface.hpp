@@ -15,7 +15,10 @@
 #ifndef  ROS1_BRIDGE__FACTORY_INTERFACE_HPP_
 #define  ROS1_BRIDGE__FACTORY_INTERFACE_HPP_
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 // include ROS 1
 #include "ros/node_handle.h"
@@ -27,6 +30,9 @@
 #include "rclcpp/publisher.hpp"
 #include "rclcpp/subscription.hpp"
 
+#include "ros1_bridge/service_statistics.hpp"
+#include "ros1_bridge/topic_statistics.hpp"
+
 namespace ros1_bridge
 {
 
@@ -34,12 +40,14 @@ struct ServiceBridge1to2
 {
   ros::ServiceServer server;
   rclcpp::ClientBase::SharedPtr client;
+  std::shared_ptr<ServiceStatistics> statistics;
 };
 
 struct ServiceBridge2to1
 {
   rclcpp::ServiceBase::SharedPtr server;
   ros::ServiceClient client;
+  std::shared_ptr<ServiceStatistics> statistics;
 };
 
 class FactoryInterface
@@ -74,7 +82,18 @@ public:
     const std::string & topic_name,
     size_t queue_size,
     rclcpp::PublisherBase::SharedPtr ros2_pub,
-    rclcpp::Logger logger) = 0;
+    rclcpp::Logger logger,
+    std::shared_ptr<TopicStatistics> statistics = nullptr) = 0;
+
+  virtual
+  ros::Subscriber
+  create_ros1_subscriber(
+    ros::NodeHandle node,
+    const std::string & topic_name,
+    size_t queue_size,
+    const std::vector<rclcpp::PublisherBase::SharedPtr> & ros2_pubs,
+    rclcpp::Logger logger,
+    std::shared_ptr<TopicStatistics> statistics = nullptr) = 0;
 
   virtual
   rclcpp::SubscriptionBase::SharedPtr
@@ -83,7 +102,8 @@ public:
     const std::string & topic_name,
     size_t queue_size,
     ros::Publisher ros1_pub,
-    rclcpp::PublisherBase::SharedPtr ros2_pub = nullptr) = 0;
+    rclcpp::PublisherBase::SharedPtr ros2_pub = nullptr,
+    std::shared_ptr<TopicStatistics> statistics = nullptr) = 0;
 
   virtual
   rclcpp::SubscriptionBase::SharedPtr
@@ -92,7 +112,8 @@ public:
     const std::string & topic_name,
     const rmw_qos_profile_t & qos_profile,
     ros::Publisher ros1_pub,
-    rclcpp::PublisherBase::SharedPtr ros2_pub = nullptr) = 0;
+    rclcpp::PublisherBase::SharedPtr ros2_pub = nullptr,
+    std::shared_ptr<TopicStatistics> statistics = nullptr) = 0;
 
   virtual
   void
@@ -101,6 +122,18 @@ public:
   virtual
   void
   convert_2_to_1(const void * ros2_msg, void * ros1_msg) = 0;
+
+  /// Deserialize a ROS 1 message and publish it with a ROS 1 publisher of the type.
+  virtual
+  void
+  publish_serialized_ros1(
+    const ros::Publisher & ros1_pub, const std::vector<uint8_t> & ros1_serialized) = 0;
+
+  /// Deserialize a ROS 1 message, convert it and publish it with a ROS 2 publisher of the type.
+  virtual
+  void
+  publish_serialized_ros1_to_ros2(
+    rclcpp::PublisherBase::SharedPtr ros2_pub, const std::vector<uint8_t> & ros1_serialized) = 0;
 };
 
 class ServiceFactoryInterface
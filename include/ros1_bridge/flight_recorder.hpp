@@ -0,0 +1,140 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__FLIGHT_RECORDER_HPP_
+#define ROS1_BRIDGE__FLIGHT_RECORDER_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The flight recorder keeps the most recent events of the bridge in a fixed size ring buffer
+// which is always on. Recording an event is lock-free and doesn't allocate.
+// A dump is written on request (e.g. on SIGUSR1 or a service call) or when a message took
+// longer than a threshold and can be decoded offline with `decode_flight_record`.
+//
+// Dump file layout (native byte order):
+//   char[8]   magic "R1BFREC1"
+//   uint64    steady clock time of the dump in ns
+//   uint64    system clock time of the dump in ns since the epoch
+//   uint32    number of names, followed by each name as
+//             uint64 id, uint8 kind (0: topic, 1: service) and the length prefixed (uint16)
+//             strings direction, name and type
+//   uint32    number of events, followed by the events as four uint64 words each:
+//             steady clock time in ns, id, value0 << 32 | value1, value2 << 32 | type
+
+namespace ros1_bridge
+{
+
+constexpr char flight_record_magic[8] = {'R', '1', 'B', 'F', 'R', 'E', 'C', '1'};
+
+/// Maximum number of events kept by the flight recorder.
+constexpr size_t flight_recorder_capacity = 16384;
+
+/// Kinds of events kept by the flight recorder and the meaning of their values.
+enum class FlightEventType : uint8_t
+{
+  // value0: ROS 1 serialized size, value1: conversion time in ns, value2: publish time in ns
+  MESSAGE = 1,
+  DROP = 2,
+  LOOPBACK = 3,
+  BRIDGE_CREATED = 4,
+  BRIDGE_DESTROYED = 5,
+  // value0: 1 on success, value1: call time in us
+  SERVICE_CALL = 6,
+  // id: 1 for ROS 1, 2 for ROS 2, value1: cycle time in us
+  DISCOVERY = 7
+};
+
+const char *
+get_flight_event_type_name(FlightEventType type);
+
+struct FlightEvent
+{
+  uint64_t time;
+  uint64_t id;
+  FlightEventType type;
+  uint32_t value0;
+  uint32_t value1;
+  uint32_t value2;
+};
+
+/// Name of a bridge whose id appears in the events.
+struct FlightRecordName
+{
+  uint64_t id;
+  uint8_t kind;
+  std::string direction;
+  std::string name;
+  std::string type;
+};
+
+/// Record an event, the id of a bridge is the address of its statistics.
+void
+record_flight_event(
+  FlightEventType type, const void * id, uint32_t value0 = 0, uint32_t value1 = 0,
+  uint32_t value2 = 0);
+
+/// Convert a duration to the value of an event in the given unit.
+/**
+ * The durations saturate at about 4 seconds in ns or 71 minutes in us.
+ */
+template<typename DurationT>
+uint32_t
+to_flight_value(std::chrono::nanoseconds duration)
+{
+  auto count = std::chrono::duration_cast<DurationT>(duration).count();
+  if (count <= 0) {
+    return 0;
+  }
+  return count < UINT32_MAX ? static_cast<uint32_t>(count) : UINT32_MAX;
+}
+
+/// Record the creation of a bridge and remember its name for the dumps.
+void
+record_flight_bridge_created(
+  const void * id, uint8_t kind, const std::string & direction, const std::string & name,
+  const std::string & type);
+
+/// Get the recorded events, oldest first.
+std::vector<FlightEvent>
+get_flight_events();
+
+/// Request a dump when a message took longer than the threshold, zero (the default) disables it.
+void
+set_flight_recorder_latency_threshold(std::chrono::nanoseconds threshold);
+
+/// Request a dump, this is async-signal-safe.
+void
+request_flight_recorder_dump();
+
+/// Take a pending dump request, if any, and whether it was caused by the latency threshold.
+bool
+take_flight_recorder_dump_request(bool & latency_exceeded);
+
+/// Dump all events and the names of the bridges to a file.
+/**
+ * \throws std::runtime_error if the file can't be written
+ */
+void
+write_flight_recorder_dump(const std::string & path);
+
+/// Request a dump whenever the process receives the signal.
+void
+install_flight_recorder_signal_handler(int signal_number);
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__FLIGHT_RECORDER_HPP_
@@ -0,0 +1,70 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__FLIGHT_RECORDER_SERVICE_HPP_
+#define ROS1_BRIDGE__FLIGHT_RECORDER_SERVICE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// include ROS 2
+#include "diagnostic_msgs/srv/self_test.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+namespace ros1_bridge
+{
+
+/// Writes dumps of the flight recorder when they are requested.
+/**
+ * A dump is written on a call of the diagnostic_msgs/SelfTest service
+ * <bridge node name>/dump_flight_recorder, whose response contains the path of the file in `id`,
+ * on a request by the signal handler of the flight recorder, or when a message took longer
+ * than `flight_recorder_latency_threshold_ms` (default: 0, disabled), at most every 10 seconds.
+ * The files are written to the directory `flight_recorder_directory` (default: /tmp).
+ * Both parameters are read from the bridge node on construction.
+ */
+class FlightRecorderService
+{
+public:
+  explicit FlightRecorderService(rclcpp::Node::SharedPtr ros2_node);
+
+  ~FlightRecorderService();
+
+private:
+  void
+  handle_request(
+    const std::shared_ptr<diagnostic_msgs::srv::SelfTest::Request> request,
+    std::shared_ptr<diagnostic_msgs::srv::SelfTest::Response> response);
+
+  /// Write a dump and return its path, or an empty string if it failed.
+  std::string
+  dump(const char * reason);
+
+  std::string directory_;
+  std::string node_name_;
+  rclcpp::Logger logger_;
+  std::mutex dump_mutex_;
+  size_t dump_count_;
+  rclcpp::Service<diagnostic_msgs::srv::SelfTest>::SharedPtr service_;
+  std::atomic<bool> stopping_;
+  std::thread thread_;
+};
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__FLIGHT_RECORDER_SERVICE_HPP_
@@ -0,0 +1,127 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__INSTRUMENTED_MUTEX_HPP_
+#define ROS1_BRIDGE__INSTRUMENTED_MUTEX_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ros1_bridge/topic_statistics.hpp"
+
+namespace ros1_bridge
+{
+
+/// Wait and hold time of an instrumented mutex at one call site.
+struct LockStatistics
+{
+  std::string lock;
+  std::string site;
+  uint64_t acquisitions;
+  uint64_t contentions;
+  DurationHistogram::Buckets wait_time;
+  std::chrono::nanoseconds wait_time_sum;
+  DurationHistogram::Buckets hold_time;
+  std::chrono::nanoseconds hold_time_sum;
+};
+
+/// Mutex recording how long each call site waited for it and held it.
+/**
+ * The statistics of all instrumented mutexes of the process are reported together with the
+ * statistics of the bridged topics. Call sites are identified by a name given when locking,
+ * the first lock at a new site allocates its statistics, every further lock only reads the
+ * steady clock twice and updates lock-free histograms.
+ */
+class InstrumentedMutex
+{
+public:
+  explicit InstrumentedMutex(const std::string & name);
+
+  ~InstrumentedMutex();
+
+  InstrumentedMutex(const InstrumentedMutex &) = delete;
+  InstrumentedMutex & operator=(const InstrumentedMutex &) = delete;
+
+  /// Lock the mutex and attribute the wait and hold time to the call site.
+  void
+  lock(const char * site);
+
+  /// Lock the mutex at an unnamed call site, so it can be used with std::unique_lock.
+  void
+  lock();
+
+  void
+  unlock();
+
+  const std::string &
+  get_name() const;
+
+  std::vector<LockStatistics>
+  get_statistics() const;
+
+private:
+  struct Site
+  {
+    std::atomic<uint64_t> acquisitions {0};
+    std::atomic<uint64_t> contentions {0};
+    DurationHistogram wait_time;
+    DurationHistogram hold_time;
+  };
+
+  const std::string name_;
+  std::mutex mutex_;
+  // sites are only added while holding mutex_, so looking one up doesn't need another lock,
+  // but the reports read them concurrently
+  mutable std::mutex sites_mutex_;
+  std::map<std::string, std::unique_ptr<Site>, std::less<>> sites_;
+  // only accessed while holding mutex_
+  Site * holder_site_;
+  std::chrono::steady_clock::time_point holder_start_;
+};
+
+/// Lock an instrumented mutex for a scope at a named call site, like std::lock_guard.
+class InstrumentedLockGuard
+{
+public:
+  InstrumentedLockGuard(InstrumentedMutex & mutex, const char * site)
+  : mutex_(mutex)
+  {
+    mutex_.lock(site);
+  }
+
+  ~InstrumentedLockGuard()
+  {
+    mutex_.unlock();
+  }
+
+  InstrumentedLockGuard(const InstrumentedLockGuard &) = delete;
+  InstrumentedLockGuard & operator=(const InstrumentedLockGuard &) = delete;
+
+private:
+  InstrumentedMutex & mutex_;
+};
+
+/// Get the statistics of all call sites of all instrumented mutexes of the process.
+std::vector<LockStatistics>
+get_all_lock_statistics();
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__INSTRUMENTED_MUTEX_HPP_
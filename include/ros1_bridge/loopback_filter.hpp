@@ -0,0 +1,77 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__LOOPBACK_FILTER_HPP_
+#define ROS1_BRIDGE__LOOPBACK_FILTER_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+namespace ros1_bridge
+{
+
+/// Recognize the ROS 1 messages which have been published by the bridges of a topic.
+/**
+ * roscpp passes a message published as a shared pointer to the subscribers in the same
+ * process as the very same pointer, so a received message which shares the ownership of a
+ * published one has been published by a bridge.
+ * The caller id of the connection header can't tell them apart inside of a nodelet manager
+ * since all nodelets share the name of the manager.
+ * Messages received from other processes are always deserialized into new messages.
+ */
+class Ros1LoopbackFilter
+{
+public:
+  /// Remember a message, this must happen before it is published.
+  void
+  add_published(const boost::shared_ptr<void const> & ros1_msg);
+
+  /// Whether a received message has been published by a bridge of the topic.
+  bool
+  is_published(const boost::shared_ptr<void const> & ros1_msg);
+
+private:
+  std::mutex mutex_;
+  // by address, a weak pointer can't be mistaken for a new message at the same address since
+  // it keeps the ownership information of the released message
+  std::unordered_map<const void *, boost::weak_ptr<void const>> published_;
+  // the released messages are forgotten when the map has grown to this size
+  size_t compact_size_ = 0;
+};
+
+/// Recognize the messages of the bridges by pointer instead of the caller id.
+/**
+ * This is only needed when the bridge shares its process with other nodes, i.e. in a nodelet
+ * manager, and must be called before any bridge is created.
+ */
+void
+enable_ros1_loopback_filters();
+
+/// Get the filter shared by all bridges of a resolved ROS 1 topic in this process.
+/**
+ * \return nullptr unless enable_ros1_loopback_filters() has been called, then the bridges
+ *   compare the caller id with the name of this node
+ */
+std::shared_ptr<Ros1LoopbackFilter>
+get_ros1_loopback_filter(const std::string & ros1_topic_name);
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__LOOPBACK_FILTER_HPP_
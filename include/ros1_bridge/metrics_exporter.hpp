@@ -0,0 +1,113 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__METRICS_EXPORTER_HPP_
+#define ROS1_BRIDGE__METRICS_EXPORTER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ros1_bridge/allocation_accounting.hpp"
+#include "ros1_bridge/discovery_statistics.hpp"
+#include "ros1_bridge/instrumented_mutex.hpp"
+#include "ros1_bridge/service_statistics.hpp"
+#include "ros1_bridge/topic_statistics.hpp"
+
+namespace ros1_bridge
+{
+
+/// Copies of all statistics reported by the MetricsExporter, taken at one point in time.
+struct MetricsSnapshot
+{
+  std::vector<TopicStatistics::Snapshot> topics;
+  std::vector<ServiceStatistics::Snapshot> services;
+  std::vector<DiscoveryStatistics> discovery;
+  std::vector<DiscoveryCallStatistics> discovery_calls;
+  std::vector<BridgeLifecycleStatistics> lifecycles;
+  std::vector<LockStatistics> locks;
+  std::vector<MemoryUsage> memory_usage;
+};
+
+/// HTTP listener serving the statistics of the bridge in the OpenMetrics text format.
+/**
+ * Every request is answered with the current counters and histograms of all bridged topics
+ * and services as well as the discovery timings of the dynamic bridges.
+ * The listener runs on its own thread with the lowest scheduling priority to format and send
+ * the response. The statistics are copied by a second thread with the normal priority,
+ * since the copy briefly takes the mutexes of the registries, which the bridges take
+ * when creating and removing bridges, and a thread which only runs on an idle core must
+ * never hold them.
+ */
+class MetricsExporter
+{
+public:
+  /// Listen on the given TCP port of the loopback interface.
+  explicit MetricsExporter(uint16_t port);
+
+  /// Listen on a Unix domain socket at the given path, which is replaced if it exists.
+  explicit MetricsExporter(const std::string & socket_path);
+
+  ~MetricsExporter();
+
+  /// Copy all statistics, which takes the mutexes of their registries.
+  static MetricsSnapshot
+  take_snapshot();
+
+  /// Format the statistics as an OpenMetrics exposition.
+  static std::string
+  render_metrics(const MetricsSnapshot & snapshot);
+
+  /// Format the current statistics as an OpenMetrics exposition.
+  static std::string
+  render_metrics();
+
+private:
+  void
+  start();
+
+  void
+  serve();
+
+  /// Take the snapshots requested by the listener thread.
+  void
+  collect();
+
+  /// Get a snapshot from the collecting thread, called by the listener thread.
+  MetricsSnapshot
+  request_snapshot();
+
+  void
+  handle_connection(int fd);
+
+  int listen_fd_;
+  std::string socket_path_;
+  std::atomic<bool> stopping_;
+  std::thread thread_;
+
+  std::mutex snapshot_mutex_;
+  std::condition_variable snapshot_condition_;
+  bool snapshot_requested_;
+  bool snapshot_ready_;
+  MetricsSnapshot snapshot_;
+  std::thread snapshot_thread_;
+};
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__METRICS_EXPORTER_HPP_
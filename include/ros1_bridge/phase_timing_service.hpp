@@ -0,0 +1,62 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__PHASE_TIMING_SERVICE_HPP_
+#define ROS1_BRIDGE__PHASE_TIMING_SERVICE_HPP_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+// include ROS 2
+#include "diagnostic_msgs/srv/self_test.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+namespace ros1_bridge
+{
+
+/// Service which times the phases of the message callbacks of selected topics for a window.
+/**
+ * A call of the diagnostic_msgs/SelfTest service <bridge node name>/phase_timing enables the
+ * phase timing of all bridged topics matching the regular expression in the parameter
+ * `topics` (default: .*) for `window` seconds (default: 5) and responds with a status per
+ * topic and direction containing the percentiles of each phase.
+ * The parameters are read from the node of the service, named <bridge node name>_phase_timing.
+ * The service has its own node and thread since the call blocks for the whole window while
+ * the callbacks of the bridge keep running.
+ */
+class PhaseTimingService
+{
+public:
+  explicit PhaseTimingService(rclcpp::Node::SharedPtr ros2_node);
+
+  ~PhaseTimingService();
+
+private:
+  void
+  handle_request(
+    const std::shared_ptr<diagnostic_msgs::srv::SelfTest::Request> request,
+    std::shared_ptr<diagnostic_msgs::srv::SelfTest::Response> response);
+
+  rclcpp::Node::SharedPtr node_;
+  rclcpp::Service<diagnostic_msgs::srv::SelfTest>::SharedPtr service_;
+  rclcpp::executors::SingleThreadedExecutor executor_;
+  std::atomic<bool> stopping_;
+  std::thread thread_;
+};
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__PHASE_TIMING_SERVICE_HPP_
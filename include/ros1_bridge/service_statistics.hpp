@@ -0,0 +1,80 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__SERVICE_STATISTICS_HPP_
+#define ROS1_BRIDGE__SERVICE_STATISTICS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ros1_bridge/duration_histogram.hpp"
+
+namespace ros1_bridge
+{
+
+/// Counters and timings of a bridged service in one direction.
+class ServiceStatistics
+{
+public:
+  struct Snapshot
+  {
+    std::string direction;
+    std::string service_name;
+    std::string type_name;
+    uint64_t calls;
+    uint64_t failures;
+    DurationHistogram::Buckets call_time;
+    std::chrono::nanoseconds call_time_sum;
+  };
+
+  ServiceStatistics(
+    const std::string & direction, const std::string & service_name,
+    const std::string & type_name);
+
+  ~ServiceStatistics();
+
+  /// Count a forwarded call with the time until the response was available.
+  void
+  add_call(bool success, std::chrono::nanoseconds call_time);
+
+  Snapshot
+  get_snapshot() const;
+
+private:
+  const std::string direction_;
+  const std::string service_name_;
+  const std::string type_name_;
+
+  std::atomic<uint64_t> calls_;
+  std::atomic<uint64_t> failures_;
+  DurationHistogram call_time_;
+};
+
+/// Create the statistics of a service bridge and register them for reporting.
+std::shared_ptr<ServiceStatistics>
+register_service_statistics(
+  const std::string & direction, const std::string & service_name,
+  const std::string & type_name);
+
+/// Get snapshots of the statistics of all existing service bridges.
+std::vector<ServiceStatistics::Snapshot>
+get_all_service_statistics();
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__SERVICE_STATISTICS_HPP_
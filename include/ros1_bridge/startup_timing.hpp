@@ -0,0 +1,38 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__STARTUP_TIMING_HPP_
+#define ROS1_BRIDGE__STARTUP_TIMING_HPP_
+
+namespace ros1_bridge
+{
+
+/// The environment variable naming the file the startup phases are appended to.
+extern const char * const startup_report_variable;
+
+/// Record when the process reached a phase of its startup, only the first time per phase.
+/**
+ * The phases are only recorded if the environment variable ROS1_BRIDGE_STARTUP_REPORT names
+ * a file, e.g. when started by benchmark_startup, otherwise this returns right away.
+ * Every phase is appended to the file as a line with its name and the time of the steady
+ * clock in nanoseconds, which is the same for all processes of the machine.
+ * The phase library_loaded is recorded when the static objects of the library are
+ * initialized, i.e. after all libraries of the process have been loaded.
+ */
+void
+record_startup_phase(const char * phase);
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__STARTUP_TIMING_HPP_
@@ -0,0 +1,71 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__STATISTICS_PUBLISHER_HPP_
+#define ROS1_BRIDGE__STATISTICS_PUBLISHER_HPP_
+
+#include <chrono>
+#include <map>
+#include <string>
+
+// include ROS 1
+#include "ros/node_handle.h"
+#include "ros/publisher.h"
+
+// include ROS 2
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "ros1_bridge/discovery_statistics.hpp"
+#include "ros1_bridge/instrumented_mutex.hpp"
+#include "ros1_bridge/topic_statistics.hpp"
+
+namespace ros1_bridge
+{
+
+/// Periodically publish the statistics of all bridges of the process.
+/**
+ * The statistics are published as diagnostic_msgs/DiagnosticArray on the statistics
+ * topic in ROS 2 and, if anyone is subscribed, in ROS 1. Each bridged topic and direction
+ * is one status with the totals as well as the rates and timing percentiles of the last
+ * period. Each call site of an instrumented mutex is one status with its wait and hold times,
+ * each polled side of the dynamic bridges one status with its discovery cycle times.
+ * The timer runs in the executor of the ROS 2 node.
+ */
+class StatisticsPublisher
+{
+public:
+  StatisticsPublisher(
+    ros::NodeHandle ros1_node,
+    rclcpp::Node::SharedPtr ros2_node,
+    std::chrono::nanoseconds period = std::chrono::seconds(1));
+
+private:
+  void
+  publish();
+
+  std::string node_name_;
+  rclcpp::Clock::SharedPtr clock_;
+  ros::Publisher ros1_pub_;
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr ros2_pub_;
+  rclcpp::TimerBase::SharedPtr timer_;
+  std::map<std::string, TopicStatistics::Snapshot> previous_snapshots_;
+  std::map<std::string, LockStatistics> previous_locks_;
+  std::map<std::string, DiscoveryStatistics> previous_discovery_;
+  std::chrono::steady_clock::time_point previous_time_;
+};
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__STATISTICS_PUBLISHER_HPP_
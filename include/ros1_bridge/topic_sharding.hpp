@@ -0,0 +1,121 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__TOPIC_SHARDING_HPP_
+#define ROS1_BRIDGE__TOPIC_SHARDING_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ros1_bridge
+{
+
+/// 64 bit FNV-1a hash which is the same in every process and on every platform.
+uint64_t
+stable_hash(const std::string & value);
+
+/// Splits topic and service names deterministically between several bridge processes.
+/**
+ * Every bridge process of a group is configured with the same shard count and its own
+ * shard index. Names with an explicit weight (e.g. their bandwidth) are distributed
+ * greedily between all configured shards so that the weight per shard capacity is
+ * balanced, all other names are assigned by weighted rendezvous hashing between the live
+ * shards. Both only depend on the configuration and the set of live shards, so all
+ * processes agree on the assignment without talking to each other.
+ * The weighted names of a dead shard fall back to rendezvous hashing as well, so when a
+ * shard dies only the names it owned are moved to the other shards, and when it returns
+ * only those names move back.
+ */
+class TopicSharding
+{
+public:
+  explicit TopicSharding(size_t shard_count = 1, size_t shard_index = 0);
+
+  size_t
+  get_shard_count() const;
+
+  size_t
+  get_shard_index() const;
+
+  /// Set the relative capacity of each shard, missing entries default to 1.
+  void
+  set_shard_weights(const std::vector<double> & shard_weights);
+
+  /// Set the weight of names which should be balanced explicitly.
+  void
+  set_topic_weights(const std::map<std::string, double> & topic_weights);
+
+  /// Update the liveness of the shards.
+  /**
+   * A shard is only considered dead after it hasn't been seen for the timeout.
+   * Until then, as well as during the first timeout after construction, it keeps its names.
+   * The timeout is also the hold time of is_handed_over().
+   * \return true if the set of live shards changed
+   */
+  bool
+  update_live_shards(
+    const std::set<size_t> & seen_shards,
+    std::chrono::steady_clock::duration timeout);
+
+  std::set<size_t>
+  get_live_shards() const;
+
+  /// Get the index of the shard owning the name.
+  size_t
+  get_shard(const std::string & name) const;
+
+  /// Check if the name is owned by this shard.
+  bool
+  is_local(const std::string & name) const;
+
+  /// Check if the name is owned by another shard which has been live for the hold time.
+  /**
+   * A bridge of a name which moved away is only removed once its new owner is established,
+   * so a shard which flaps on an unreliable network doesn't make the other shards tear down
+   * and recreate its bridges over and over. Until then both shards bridge the name.
+   */
+  bool
+  is_handed_over(const std::string & name) const;
+
+private:
+  size_t
+  get_shard_locked(const std::string & name) const;
+
+  size_t
+  get_hashed_shard(const std::string & name) const;
+
+  void
+  assign_weighted_topics();
+
+  const size_t shard_count_;
+  const size_t shard_index_;
+
+  mutable std::mutex mutex_;
+  std::vector<double> shard_weights_;
+  std::map<std::string, double> topic_weights_;
+  std::map<std::string, size_t> weighted_assignment_;
+  std::vector<std::chrono::steady_clock::time_point> last_seen_;
+  std::vector<std::chrono::steady_clock::time_point> live_since_;
+  std::chrono::steady_clock::duration timeout_;
+  std::set<size_t> live_shards_;
+};
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__TOPIC_SHARDING_HPP_
@@ -0,0 +1,217 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__TOPIC_STATISTICS_HPP_
+#define ROS1_BRIDGE__TOPIC_STATISTICS_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ros1_bridge/allocation_accounting.hpp"
+#include "ros1_bridge/duration_histogram.hpp"
+
+namespace ros1_bridge
+{
+
+/// The topic the statistics of all bridged topics are published on in ROS 1 and ROS 2.
+extern const char * const statistics_topic_name;
+
+/// Check if a topic is the statistics topic, which must never be bridged itself.
+bool
+is_statistics_topic(const std::string & topic_name);
+
+/// Counters and timings of a single bridged topic in one direction.
+class TopicStatistics
+{
+public:
+  /// The stages of the message callbacks which can be timed on demand.
+  enum Phase
+  {
+    DESERIALIZATION,
+    HEADER_CHECK,
+    ALLOCATION,
+    CONVERSION,
+    PUBLISH,
+    PHASE_COUNT
+  };
+
+  static const char *
+  get_phase_name(Phase phase);
+
+  struct Snapshot
+  {
+    std::string direction;
+    std::string topic_name;
+    std::string type_name;
+    std::string domain;
+    uint64_t messages;
+    uint64_t bytes;
+    uint64_t drops;
+    uint64_t loopbacks;
+    DurationHistogram::Buckets conversion_time;
+    DurationHistogram::Buckets publish_time;
+    std::chrono::nanoseconds conversion_time_sum;
+    std::chrono::nanoseconds publish_time_sum;
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    DurationHistogram::Buckets scheduling_delay;
+    std::chrono::nanoseconds scheduling_delay_sum;
+  };
+
+  TopicStatistics(
+    const std::string & direction, const std::string & topic_name, const std::string & type_name,
+    const std::string & domain = "");
+
+  ~TopicStatistics();
+
+  /// Count a message passed to the other side with its ROS 1 serialized size.
+  void
+  add_message(
+    size_t bytes, std::chrono::nanoseconds conversion_time, std::chrono::nanoseconds publish_time);
+
+  /// Count a message which the bridge couldn't pass on.
+  void
+  add_drop();
+
+  /// Count a message which was published by the bridge itself and therefore skipped.
+  void
+  add_loopback();
+
+  /// Count the heap allocations made while passing a message.
+  void
+  add_allocations(uint64_t allocations, uint64_t bytes);
+
+  /// Record the time a message waited between its arrival and the start of the callback.
+  void
+  add_scheduling_delay(std::chrono::nanoseconds delay);
+
+  Snapshot
+  get_snapshot() const;
+
+  const std::string &
+  get_direction() const;
+
+  const std::string &
+  get_topic_name() const;
+
+  /// Get the account the memory allocated by the bridge is attributed to, if accounting is enabled.
+  MemoryAccount *
+  get_memory_account() const
+  {
+    return memory_account_;
+  }
+
+  /// Start or stop recording the duration of each phase, which starts out disabled.
+  /**
+   * Enabling the timing clears the previously recorded phases.
+   */
+  void
+  set_phase_timing_enabled(bool enabled);
+
+  bool
+  is_phase_timing_enabled() const
+  {
+    return phase_timing_enabled_.load(std::memory_order_relaxed);
+  }
+
+  void
+  add_phase_time(Phase phase, std::chrono::nanoseconds duration);
+
+  DurationHistogram::Buckets
+  get_phase_buckets(Phase phase) const;
+
+private:
+  const std::string direction_;
+  const std::string topic_name_;
+  const std::string type_name_;
+  const std::string domain_;
+
+  std::atomic<uint64_t> messages_;
+  std::atomic<uint64_t> bytes_;
+  std::atomic<uint64_t> drops_;
+  std::atomic<uint64_t> loopbacks_;
+  std::atomic<uint64_t> allocations_;
+  std::atomic<uint64_t> allocated_bytes_;
+  DurationHistogram conversion_time_;
+  DurationHistogram publish_time_;
+  DurationHistogram scheduling_delay_;
+  MemoryAccount * const memory_account_;
+
+  std::atomic<bool> phase_timing_enabled_;
+  std::array<DurationHistogram, PHASE_COUNT> phase_times_;
+};
+
+/// Measure consecutive phases of a callback if phase timing is enabled for the topic.
+/**
+ * When the timing is disabled every call only costs a branch.
+ */
+class PhaseTimer
+{
+public:
+  explicit PhaseTimer(TopicStatistics * statistics)
+  : statistics_(statistics && statistics->is_phase_timing_enabled() ? statistics : nullptr)
+  {
+    if (statistics_) {
+      phase_start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  /// Record the time since the end of the previous phase (or construction) for the phase.
+  void
+  end_phase(TopicStatistics::Phase phase)
+  {
+    if (statistics_) {
+      auto now = std::chrono::steady_clock::now();
+      statistics_->add_phase_time(phase, now - phase_start_);
+      phase_start_ = now;
+    }
+  }
+
+private:
+  TopicStatistics * statistics_;
+  std::chrono::steady_clock::time_point phase_start_;
+};
+
+/// Create the statistics of a bridge and register them for reporting.
+/**
+ * The registry only keeps a weak reference, the statistics are reported as long as the
+ * bridge holding the returned pointer exists.
+ * The ROS 2 domain (or comma separated domains) of the bridge tells the bridges of the same
+ * topic to several domains apart.
+ */
+std::shared_ptr<TopicStatistics>
+register_topic_statistics(
+  const std::string & direction, const std::string & topic_name, const std::string & type_name,
+  const std::string & domain = "");
+
+/// Get the name of a topic in the statistics, which includes the domain if there is one.
+std::string
+get_statistics_name(const TopicStatistics::Snapshot & snapshot);
+
+/// Get the statistics of all existing bridges.
+std::vector<std::shared_ptr<TopicStatistics>>
+get_registered_topic_statistics();
+
+/// Get snapshots of the statistics of all existing bridges.
+std::vector<TopicStatistics::Snapshot>
+get_all_topic_statistics();
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__TOPIC_STATISTICS_HPP_
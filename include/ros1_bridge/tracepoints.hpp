@@ -0,0 +1,96 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__TRACEPOINTS_HPP_
+#define ROS1_BRIDGE__TRACEPOINTS_HPP_
+
+// Static tracepoints of the provider ros1_bridge.
+// They are compiled in as USDT probes when building with ROS1_BRIDGE_ENABLE_TRACEPOINTS,
+// which only costs a nop instruction per probe as long as no tracer is attached
+// (perf, bpftrace or SystemTap).
+// Otherwise they expand to nothing.
+//
+// A bridge is identified by the address of its TopicStatistics, which is announced together
+// with the topic name and the rcl handle of the ROS 2 publisher / subscription by
+// bridge_created, to be correlated with the events of ros2_tracing.
+// Message sizes are the ROS 1 serialized length, 0 where it isn't known yet.
+//
+// The probes have semaphores which a tracer increments while it is attached, so the
+// serialized length is only computed for the tracepoints when somebody is listening
+// (see ROS1_BRIDGE_TRACEPOINT_SIZE_ENABLED).
+
+#ifdef ROS1_BRIDGE_ENABLE_TRACEPOINTS
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+// the semaphores are defined weak in every translation unit, so that each library and
+// executable has a single one per probe which the notes of its probes refer to
+#define ROS1_BRIDGE_TRACEPOINT_SEMAPHORE(name) \
+  __extension__ volatile unsigned short ros1_bridge_ ## name ## _semaphore /* NOLINT */ \
+  __attribute__((weak, visibility("hidden"), section(".probes")))
+
+extern "C" {
+ROS1_BRIDGE_TRACEPOINT_SEMAPHORE(bridge_created);
+ROS1_BRIDGE_TRACEPOINT_SEMAPHORE(bridge_destroyed);
+ROS1_BRIDGE_TRACEPOINT_SEMAPHORE(message_received);
+ROS1_BRIDGE_TRACEPOINT_SEMAPHORE(conversion_start);
+ROS1_BRIDGE_TRACEPOINT_SEMAPHORE(conversion_end);
+ROS1_BRIDGE_TRACEPOINT_SEMAPHORE(publish_start);
+ROS1_BRIDGE_TRACEPOINT_SEMAPHORE(publish_end);
+ROS1_BRIDGE_TRACEPOINT_SEMAPHORE(discovery_start);
+ROS1_BRIDGE_TRACEPOINT_SEMAPHORE(discovery_end);
+}
+
+// whether a tracer is attached to any of the probes which take a message size
+#define ROS1_BRIDGE_TRACEPOINT_SIZE_ENABLED() \
+  __builtin_expect( \
+    (ros1_bridge_message_received_semaphore | ros1_bridge_conversion_end_semaphore | \
+    ros1_bridge_publish_start_semaphore) != 0, 0)
+
+#define ROS1_BRIDGE_TRACEPOINT_BRIDGE_CREATED(id, direction, topic_name, ros2_handle) \
+  DTRACE_PROBE4(ros1_bridge, bridge_created, id, direction, topic_name, ros2_handle)
+#define ROS1_BRIDGE_TRACEPOINT_BRIDGE_DESTROYED(id) \
+  DTRACE_PROBE1(ros1_bridge, bridge_destroyed, id)
+#define ROS1_BRIDGE_TRACEPOINT_MESSAGE_RECEIVED(id, size) \
+  DTRACE_PROBE2(ros1_bridge, message_received, id, size)
+#define ROS1_BRIDGE_TRACEPOINT_CONVERSION_START(id) \
+  DTRACE_PROBE1(ros1_bridge, conversion_start, id)
+#define ROS1_BRIDGE_TRACEPOINT_CONVERSION_END(id, size) \
+  DTRACE_PROBE2(ros1_bridge, conversion_end, id, size)
+#define ROS1_BRIDGE_TRACEPOINT_PUBLISH_START(id, size) \
+  DTRACE_PROBE2(ros1_bridge, publish_start, id, size)
+#define ROS1_BRIDGE_TRACEPOINT_PUBLISH_END(id) \
+  DTRACE_PROBE1(ros1_bridge, publish_end, id)
+#define ROS1_BRIDGE_TRACEPOINT_DISCOVERY_START(side) \
+  DTRACE_PROBE1(ros1_bridge, discovery_start, side)
+#define ROS1_BRIDGE_TRACEPOINT_DISCOVERY_END(side, topic_count) \
+  DTRACE_PROBE2(ros1_bridge, discovery_end, side, topic_count)
+
+#else
+
+#define ROS1_BRIDGE_TRACEPOINT_SIZE_ENABLED() false
+#define ROS1_BRIDGE_TRACEPOINT_BRIDGE_CREATED(id, direction, topic_name, ros2_handle)
+#define ROS1_BRIDGE_TRACEPOINT_BRIDGE_DESTROYED(id)
+#define ROS1_BRIDGE_TRACEPOINT_MESSAGE_RECEIVED(id, size)
+#define ROS1_BRIDGE_TRACEPOINT_CONVERSION_START(id)
+#define ROS1_BRIDGE_TRACEPOINT_CONVERSION_END(id, size)
+#define ROS1_BRIDGE_TRACEPOINT_PUBLISH_START(id, size)
+#define ROS1_BRIDGE_TRACEPOINT_PUBLISH_END(id)
+#define ROS1_BRIDGE_TRACEPOINT_DISCOVERY_START(side)
+#define ROS1_BRIDGE_TRACEPOINT_DISCOVERY_END(side, topic_count)
+
+#endif
+
+#endif  // ROS1_BRIDGE__TRACEPOINTS_HPP_
@@ -0,0 +1,108 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS1_BRIDGE__TRAFFIC_RECORDER_HPP_
+#define ROS1_BRIDGE__TRAFFIC_RECORDER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ros/serialization.h"
+
+#include "ros1_bridge/topic_statistics.hpp"
+
+// The traffic recorder writes the shape of the traffic passed by the bridges to a trace file,
+// which `replay_traffic` publishes again with the same timing, e.g. against a local bridge.
+// It is off unless started (e.g. with the --record-traffic option of the bridges).
+// Every message is recorded with its topic, its ROS 1 serialized size and its time, the
+// payload only of the first message of every topic unless all payloads are requested.
+//
+// Trace file layout (native byte order):
+//   char[8]   magic "R1BTRAC1"
+//   uint64    system clock time of the start in ns since the epoch
+//   uint8     1 if every message has its payload, 0 if only the first one of every topic
+// followed by records until the end of the file, each starting with a uint8 kind:
+//   1 topic   uint32 id, the length prefixed (uint16) strings direction, topic name,
+//             ROS 1 type and ROS 2 type, and the length prefixed (uint32) ROS 1
+//             serialization of its first message
+//   2 message uint32 id of the topic, uint64 time since the start in ns, uint32 ROS 1
+//             serialized size and, if every message has its payload, the length prefixed
+//             (uint32) ROS 1 serialization of the message
+// The topic record is written before the first message record of the topic.
+
+namespace ros1_bridge
+{
+
+constexpr char traffic_trace_magic[8] = {'R', '1', 'B', 'T', 'R', 'A', 'C', '1'};
+
+enum class TrafficRecordKind : uint8_t
+{
+  TOPIC = 1,
+  MESSAGE = 2
+};
+
+/// Start writing the traffic to a trace file, replacing a previous recording.
+/**
+ * \throws std::runtime_error if the file can't be opened
+ */
+void
+start_traffic_recording(const std::string & path, bool payloads);
+
+/// Stop the recording and close the trace file, which also happens at exit.
+void
+stop_traffic_recording();
+
+bool
+is_traffic_recording();
+
+/// Whether the next message of a topic needs its payload, i.e. its first one or all.
+bool
+is_traffic_payload_needed(const TopicStatistics * statistics);
+
+/// Record a message passed by the bridge of a topic, the payload may be empty if not needed.
+void
+record_traffic(
+  const TopicStatistics * statistics, const std::string & ros1_type_name,
+  const std::string & ros2_type_name, uint32_t size, const std::vector<uint8_t> & payload);
+
+/// Record a message passed by the bridge of a topic, only serializing it if needed.
+/**
+ * Messages of bridges without statistics can't be attributed to a topic and are skipped.
+ */
+template<typename ROS1_T>
+void
+record_traffic_message(
+  const TopicStatistics * statistics, const std::string & ros1_type_name,
+  const std::string & ros2_type_name, const ROS1_T & ros1_msg, uint32_t size)
+{
+  if (!statistics) {
+    return;
+  }
+  std::vector<uint8_t> payload;
+  if (is_traffic_payload_needed(statistics)) {
+    payload.resize(ros::serialization::serializationLength(ros1_msg));
+    ros::serialization::OStream stream(payload.data(), static_cast<uint32_t>(payload.size()));
+    ros::serialization::serialize(stream, ros1_msg);
+  }
+  if (size == 0) {
+    size = payload.empty() ? ros::serialization::serializationLength(ros1_msg) :
+      static_cast<uint32_t>(payload.size());
+  }
+  record_traffic(statistics, ros1_type_name, ros2_type_name, size, payload);
+}
+
+}  // namespace ros1_bridge
+
+#endif  // ROS1_BRIDGE__TRAFFIC_RECORDER_HPP_
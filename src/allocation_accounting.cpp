@@ -0,0 +1,218 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ros1_bridge/allocation_accounting.hpp"
+
+namespace ros1_bridge
+{
+
+namespace
+{
+
+// plain counters since they are only accessed by their own thread,
+// constant initialized so they can be used before any constructor ran
+thread_local uint64_t g_thread_allocations = 0;
+thread_local uint64_t g_thread_allocated_bytes = 0;
+thread_local MemoryAccount * g_thread_memory_account = nullptr;
+
+using MemoryAccounts =
+  std::map<std::pair<std::string, std::string>, std::unique_ptr<MemoryAccount>>;
+
+std::mutex g_memory_accounts_mutex;
+
+// never destroyed, since blocks attributed to an account may be freed after static destruction
+MemoryAccounts &
+get_memory_accounts()
+{
+  static MemoryAccounts * accounts = new MemoryAccounts();
+  return *accounts;
+}
+
+}  // namespace
+
+AllocationCounts
+get_thread_allocation_counts()
+{
+  return AllocationCounts {g_thread_allocations, g_thread_allocated_bytes};
+}
+
+MemoryAccount *
+get_memory_account(const std::string & direction, const std::string & topic_name)
+{
+  if (!allocation_accounting_enabled) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(g_memory_accounts_mutex);
+  auto & account = get_memory_accounts()[std::make_pair(direction, topic_name)];
+  if (!account) {
+    account.reset(new MemoryAccount());
+    account->direction = direction;
+    account->topic_name = topic_name;
+    account->held_bytes.store(0);
+    account->held_blocks.store(0);
+  }
+  return account.get();
+}
+
+std::vector<MemoryUsage>
+get_memory_usage()
+{
+  std::vector<MemoryUsage> usage;
+  std::lock_guard<std::mutex> lock(g_memory_accounts_mutex);
+  for (const auto & account : get_memory_accounts()) {
+    usage.push_back(
+      MemoryUsage {
+        account.second->direction, account.second->topic_name,
+        account.second->held_bytes.load(std::memory_order_relaxed),
+        account.second->held_blocks.load(std::memory_order_relaxed)});
+  }
+  return usage;
+}
+
+MemoryAccount *
+set_thread_memory_account(MemoryAccount * account)
+{
+  MemoryAccount * previous = g_thread_memory_account;
+  g_thread_memory_account = account;
+  return previous;
+}
+
+#ifdef ROS1_BRIDGE_ENABLE_ALLOCATION_ACCOUNTING
+
+namespace
+{
+
+// every block is preceded by a header naming its account, so the account can be credited
+// by whichever thread frees the block
+struct alignas(alignof(std::max_align_t)) BlockHeader
+{
+  MemoryAccount * account;
+  std::size_t size;
+};
+
+void *
+counted_allocate(std::size_t size)
+{
+  ++g_thread_allocations;
+  g_thread_allocated_bytes += size;
+  auto header = static_cast<BlockHeader *>(std::malloc(sizeof(BlockHeader) + size));
+  if (!header) {
+    return nullptr;
+  }
+  header->account = g_thread_memory_account;
+  header->size = size;
+  if (header->account) {
+    header->account->held_bytes.fetch_add(size, std::memory_order_relaxed);
+    header->account->held_blocks.fetch_add(1, std::memory_order_relaxed);
+  }
+  return header + 1;
+}
+
+void
+counted_free(void * ptr)
+{
+  if (!ptr) {
+    return;
+  }
+  BlockHeader * header = static_cast<BlockHeader *>(ptr) - 1;
+  if (header->account) {
+    header->account->held_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+    header->account->held_blocks.fetch_sub(1, std::memory_order_relaxed);
+  }
+  std::free(header);
+}
+
+}  // namespace
+
+#endif
+
+}  // namespace ros1_bridge
+
+#ifdef ROS1_BRIDGE_ENABLE_ALLOCATION_ACCOUNTING
+
+void *
+operator new(std::size_t size)
+{
+  void * ptr = ros1_bridge::counted_allocate(size);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void *
+operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void *
+operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+  return ros1_bridge::counted_allocate(size);
+}
+
+void *
+operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+  return ros1_bridge::counted_allocate(size);
+}
+
+void
+operator delete(void * ptr) noexcept
+{
+  ros1_bridge::counted_free(ptr);
+}
+
+void
+operator delete[](void * ptr) noexcept
+{
+  ros1_bridge::counted_free(ptr);
+}
+
+void
+operator delete(void * ptr, const std::nothrow_t &) noexcept
+{
+  ros1_bridge::counted_free(ptr);
+}
+
+void
+operator delete[](void * ptr, const std::nothrow_t &) noexcept
+{
+  ros1_bridge::counted_free(ptr);
+}
+
+void
+operator delete(void * ptr, std::size_t) noexcept
+{
+  ros1_bridge::counted_free(ptr);
+}
+
+void
+operator delete[](void * ptr, std::size_t) noexcept
+{
+  ros1_bridge::counted_free(ptr);
+}
+
+#endif
@@ -12,14 +12,53 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
+#include "rcl/error_handling.h"
+#include "rcl/node.h"
+
+#include "ros1_bridge/allocation_accounting.hpp"
 #include "ros1_bridge/bridge.hpp"
+#include "ros1_bridge/startup_timing.hpp"
+#include "ros1_bridge/tracepoints.hpp"
 
 
 namespace ros1_bridge
 {
 
+namespace
+{
+
+// the domains tell the statistics of the bridges of a topic to several domains apart
+std::string
+get_domains(const std::vector<rclcpp::Node::SharedPtr> & ros2_nodes)
+{
+  std::vector<size_t> domain_ids;
+  for (const auto & ros2_node : ros2_nodes) {
+    size_t domain_id = 0;
+    if (
+      rcl_node_get_domain_id(
+        ros2_node->get_node_base_interface()->get_rcl_node_handle(), &domain_id) != RCL_RET_OK)
+    {
+      rcl_reset_error();
+      continue;
+    }
+    if (std::find(domain_ids.begin(), domain_ids.end(), domain_id) == domain_ids.end()) {
+      domain_ids.push_back(domain_id);
+    }
+  }
+  std::string domains;
+  for (size_t domain_id : domain_ids) {
+    domains += (domains.empty() ? "" : ",") + std::to_string(domain_id);
+  }
+  return domains;
+}
+
+}  // namespace
+
 Bridge1to2Handles
 create_bridge_from_1_to_2(
   ros::NodeHandle ros1_node,
@@ -31,16 +70,29 @@ create_bridge_from_1_to_2(
   const std::string & ros2_topic_name,
   size_t publisher_queue_size)
 {
+  record_startup_phase("first_bridge_start");
   auto factory = get_factory(ros1_type_name, ros2_type_name);
+  record_startup_phase("first_factory_lookup");
+  auto statistics = register_topic_statistics(
+    "1to2", ros1_topic_name, ros1_type_name, get_domains({ros2_node}));
+  // attribute the memory of the entities to the bridge as well
+  MemoryAccountScope memory_account_scope(statistics->get_memory_account());
+
   auto ros2_pub = factory->create_ros2_publisher(
     ros2_node, ros2_topic_name, publisher_queue_size);
 
   auto ros1_sub = factory->create_ros1_subscriber(
-    ros1_node, ros1_topic_name, subscriber_queue_size, ros2_pub, ros2_node->get_logger());
+    ros1_node, ros1_topic_name, subscriber_queue_size, ros2_pub, ros2_node->get_logger(),
+    statistics);
+
+  ROS1_BRIDGE_TRACEPOINT_BRIDGE_CREATED(
+    statistics.get(), "1to2", ros1_topic_name.c_str(), ros2_pub->get_publisher_handle());
 
   Bridge1to2Handles handles;
   handles.ros1_subscriber = ros1_sub;
   handles.ros2_publisher = ros2_pub;
+  handles.statistics = statistics;
+  record_startup_phase("first_bridge_created");
   return handles;
 }
 
@@ -56,16 +108,68 @@ create_bridge_from_2_to_1(
   size_t publisher_queue_size,
   rclcpp::PublisherBase::SharedPtr ros2_pub)
 {
+  record_startup_phase("first_bridge_start");
   auto factory = get_factory(ros1_type_name, ros2_type_name);
+  record_startup_phase("first_factory_lookup");
+  auto statistics = register_topic_statistics(
+    "2to1", ros2_topic_name, ros2_type_name, get_domains({ros2_node}));
+  // attribute the memory of the entities to the bridge as well
+  MemoryAccountScope memory_account_scope(statistics->get_memory_account());
+
   auto ros1_pub = factory->create_ros1_publisher(
     ros1_node, ros1_topic_name, publisher_queue_size);
 
   auto ros2_sub = factory->create_ros2_subscriber(
-    ros2_node, ros2_topic_name, subscriber_queue_size, ros1_pub, ros2_pub);
+    ros2_node, ros2_topic_name, subscriber_queue_size, ros1_pub, ros2_pub, statistics);
+
+  ROS1_BRIDGE_TRACEPOINT_BRIDGE_CREATED(
+    statistics.get(), "2to1", ros2_topic_name.c_str(), ros2_sub->get_subscription_handle().get());
 
   Bridge2to1Handles handles;
   handles.ros2_subscriber = ros2_sub;
   handles.ros1_publisher = ros1_pub;
+  handles.statistics = statistics;
+  record_startup_phase("first_bridge_created");
+  return handles;
+}
+
+Bridge1toNHandles
+create_bridge_from_1_to_n(
+  ros::NodeHandle ros1_node,
+  const std::vector<rclcpp::Node::SharedPtr> & ros2_nodes,
+  const std::string & ros1_type_name,
+  const std::string & ros1_topic_name,
+  size_t subscriber_queue_size,
+  const std::string & ros2_type_name,
+  const std::vector<std::string> & ros2_topic_names,
+  size_t publisher_queue_size)
+{
+  if (ros2_nodes.empty() || ros2_topic_names.empty()) {
+    throw std::runtime_error("No ROS 2 node or topic to bridge " + ros1_topic_name + " to");
+  }
+  record_startup_phase("first_bridge_start");
+  auto factory = get_factory(ros1_type_name, ros2_type_name);
+  record_startup_phase("first_factory_lookup");
+
+  Bridge1toNHandles handles;
+  handles.statistics = register_topic_statistics(
+    "1to2", ros1_topic_name, ros1_type_name, get_domains(ros2_nodes));
+  // attribute the memory of the entities to the bridge as well
+  MemoryAccountScope memory_account_scope(handles.statistics->get_memory_account());
+  for (const auto & ros2_node : ros2_nodes) {
+    for (const auto & ros2_topic_name : ros2_topic_names) {
+      handles.ros2_publishers.push_back(
+        factory->create_ros2_publisher(ros2_node, ros2_topic_name, publisher_queue_size));
+    }
+  }
+  handles.ros1_subscriber = factory->create_ros1_subscriber(
+    ros1_node, ros1_topic_name, subscriber_queue_size, handles.ros2_publishers,
+    ros2_nodes.front()->get_logger(), handles.statistics);
+  for (const auto & ros2_pub : handles.ros2_publishers) {
+    ROS1_BRIDGE_TRACEPOINT_BRIDGE_CREATED(
+      handles.statistics.get(), "1to2", ros1_topic_name.c_str(), ros2_pub->get_publisher_handle());
+  }
+  record_startup_phase("first_bridge_created");
   return handles;
 }
 
@@ -90,4 +194,103 @@ create_bidirectional_bridge(
   return handles;
 }
 
+FanOutBridgeHandles
+create_fan_out_bridge(
+  ros::NodeHandle ros1_node,
+  const std::vector<rclcpp::Node::SharedPtr> & ros2_nodes,
+  const std::string & ros1_type_name,
+  const std::string & ros2_type_name,
+  const std::string & ros1_topic_name,
+  const std::vector<std::string> & ros2_topic_names,
+  size_t queue_size)
+{
+  FanOutBridgeHandles handles;
+  handles.bridge1ton = create_bridge_from_1_to_n(
+    ros1_node, ros2_nodes,
+    ros1_type_name, ros1_topic_name, queue_size, ros2_type_name, ros2_topic_names, queue_size);
+
+  // the publishers are ordered by node and then by topic name
+  size_t index = 0;
+  for (const auto & ros2_node : ros2_nodes) {
+    for (const auto & ros2_topic_name : ros2_topic_names) {
+      handles.bridges2to1.push_back(
+        create_bridge_from_2_to_1(
+          ros2_node, ros1_node,
+          ros2_type_name, ros2_topic_name, queue_size, ros1_type_name, ros1_topic_name, queue_size,
+          handles.bridge1ton.ros2_publishers[index++]));
+    }
+  }
+  return handles;
+}
+
+std::vector<FanOutBridgeHandles>
+create_fan_out_bridges_from_parameter(
+  ros::NodeHandle ros1_node,
+  const std::vector<rclcpp::Node::SharedPtr> & ros2_nodes,
+  const std::string & parameter_name)
+{
+  std::vector<FanOutBridgeHandles> all_handles;
+  auto logger = ros2_nodes.front()->get_logger();
+
+  XmlRpc::XmlRpcValue topics;
+  if (
+    !ros1_node.getParam(parameter_name, topics) ||
+    topics.getType() != XmlRpc::XmlRpcValue::TypeArray)
+  {
+    RCLCPP_ERROR(
+      logger,
+      "The parameter '%s' either doesn't exist or isn't an array", parameter_name.c_str());
+    return all_handles;
+  }
+
+  for (size_t i = 0; i < static_cast<size_t>(topics.size()); ++i) {
+    std::string topic_name = static_cast<std::string>(topics[i]["topic"]);
+    std::string type_name = static_cast<std::string>(topics[i]["type"]);
+    size_t queue_size = 100;
+    if (topics[i].hasMember("queue_size") && static_cast<int>(topics[i]["queue_size"]) > 0) {
+      queue_size = static_cast<int>(topics[i]["queue_size"]);
+    }
+    std::vector<std::string> ros2_topic_names;
+    if (
+      topics[i].hasMember("ros2_topics") &&
+      topics[i]["ros2_topics"].getType() == XmlRpc::XmlRpcValue::TypeArray)
+    {
+      for (int j = 0; j < topics[i]["ros2_topics"].size(); ++j) {
+        ros2_topic_names.push_back(static_cast<std::string>(topics[i]["ros2_topics"][j]));
+      }
+    }
+    if (ros2_topic_names.empty()) {
+      ros2_topic_names.push_back(topic_name);
+    }
+    RCLCPP_INFO(
+      logger,
+      "Trying to create fan out bridge for topic '%s' to %zu ROS 2 topics on %zu nodes "
+      "with ROS 1 type '%s' and ROS 2 type '%s'",
+      topic_name.c_str(), ros2_topic_names.size(), ros2_nodes.size(),
+      type_name.c_str(), type_name.c_str());
+
+    try {
+      all_handles.push_back(
+        create_fan_out_bridge(
+          ros1_node, ros2_nodes, type_name, type_name, topic_name, ros2_topic_names, queue_size));
+    } catch (std::runtime_error & e) {
+      RCLCPP_ERROR(
+        logger,
+        "failed to create fan out bridge for topic '%s' "
+        "with ROS 1 type '%s' and ROS 2 type '%s': %s",
+        topic_name.c_str(), type_name.c_str(), type_name.c_str(), e.what());
+    }
+  }
+  return all_handles;
+}
+
+std::vector<FanOutBridgeHandles>
+create_bridges_from_parameter(
+  ros::NodeHandle ros1_node,
+  rclcpp::Node::SharedPtr ros2_node,
+  const std::string & parameter_name)
+{
+  return create_fan_out_bridges_from_parameter(ros1_node, {ros2_node}, parameter_name);
+}
+
 }  // namespace ros1_bridge
@@ -0,0 +1,164 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "ros/ros.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+#include "ros/this_node.h"
+
+#include "class_loader/register_macro.hpp"
+
+#include "ros1_bridge/bridge_component.hpp"
+
+namespace ros1_bridge
+{
+
+namespace
+{
+
+// a remapping of `__node` applies to every node of the given name in the process, so further
+// instances get a distinct name which can be remapped on its own
+std::string
+get_default_node_name()
+{
+  static std::atomic<size_t> instance_count(0);
+  size_t instance = ++instance_count;
+  if (instance == 1) {
+    return "ros_bridge";
+  }
+  return "ros_bridge_" + std::to_string(instance);
+}
+
+void
+init_ros1(const rclcpp::Node & node)
+{
+  if (ros::isInitialized()) {
+    RCLCPP_INFO(
+      node.get_logger(), "sharing the ROS 1 node '%s' of the process",
+      ros::this_node::getName().c_str());
+    return;
+  }
+  // the container owns the signal handling, and the unique name keeps the ROS 1 master from
+  // shutting down a running bridge of the same name
+  ros::init(
+    ros::M_string(), node.get_name(),
+    ros::init_options::NoSigintHandler | ros::init_options::AnonymousName);
+}
+
+}  // namespace
+
+BridgeComponent::BridgeComponent()
+: Node(get_default_node_name(), "", true)
+{
+  init_ros1(*this);
+  ros1_node_.reset(new ros::NodeHandle());
+  ros1_spinner_.reset(new ros::AsyncSpinner(1));
+  ros1_spinner_->start();
+
+  // the factories need a shared pointer to this node which isn't available
+  // before the construction has finished
+  startup_timer_ = create_wall_timer(
+    std::chrono::milliseconds(0),
+    [this]() -> void
+    {
+      startup_timer_->cancel();
+      create_bridges();
+    });
+}
+
+BridgeComponent::~BridgeComponent()
+{
+  all_handles_.clear();
+  ros1_spinner_->stop();
+}
+
+void
+BridgeComponent::create_bridges()
+{
+  std::string parameter_name;
+  get_parameter_or<std::string>("topics_parameter", parameter_name, "topics");
+  all_handles_ = create_bridges_from_parameter(*ros1_node_, shared_from_this(), parameter_name);
+  RCLCPP_INFO(get_logger(), "bridging %zu topics", all_handles_.size());
+  statistics_publisher_.reset(new StatisticsPublisher(*ros1_node_, shared_from_this()));
+  phase_timing_service_.reset(new PhaseTimingService(shared_from_this()));
+  flight_recorder_service_.reset(new FlightRecorderService(shared_from_this()));
+}
+
+DynamicBridgeComponent::DynamicBridgeComponent()
+: Node(get_default_node_name(), "", true)
+{
+  init_ros1(*this);
+  ros1_node_.reset(new ros::NodeHandle());
+  ros1_spinner_.reset(new ros::AsyncSpinner(1));
+  ros1_spinner_->start();
+
+  // the bridges need a shared pointer to this node which isn't available
+  // before the construction has finished
+  startup_timer_ = create_wall_timer(
+    std::chrono::milliseconds(0),
+    [this]() -> void
+    {
+      startup_timer_->cancel();
+      start_discovery();
+    });
+}
+
+DynamicBridgeComponent::~DynamicBridgeComponent()
+{
+  ros1_spinner_->stop();
+  ros1_poll_timer_.stop();
+}
+
+void
+DynamicBridgeComponent::start_discovery()
+{
+  bool bridge_all_1to2_topics;
+  bool bridge_all_2to1_topics;
+  bool output_topic_introspection;
+  get_parameter_or<bool>("bridge_all_1to2_topics", bridge_all_1to2_topics, false);
+  get_parameter_or<bool>("bridge_all_2to1_topics", bridge_all_2to1_topics, false);
+  get_parameter_or<bool>("show_introspection", output_topic_introspection, false);
+  discovery_.reset(
+    new BridgeDiscovery(
+      *ros1_node_, shared_from_this(),
+      output_topic_introspection, bridge_all_1to2_topics, bridge_all_2to1_topics));
+
+  ros1_poll_timer_ = ros1_node_->createTimer(
+    ros::Duration(1.0), &BridgeDiscovery::poll_ros1, discovery_.get());
+  ros2_poll_timer_ = create_wall_timer(
+    std::chrono::seconds(1),
+    [this]() -> void
+    {
+      discovery_->poll_ros2();
+    });
+
+  statistics_publisher_.reset(new StatisticsPublisher(*ros1_node_, shared_from_this()));
+  phase_timing_service_.reset(new PhaseTimingService(shared_from_this()));
+  flight_recorder_service_.reset(new FlightRecorderService(shared_from_this()));
+}
+
+}  // namespace ros1_bridge
+
+CLASS_LOADER_REGISTER_CLASS(ros1_bridge::BridgeComponent, rclcpp::Node)
+CLASS_LOADER_REGISTER_CLASS(ros1_bridge::DynamicBridgeComponent, rclcpp::Node)
@@ -0,0 +1,712 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "ros/ros.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+#include "ros/this_node.h"
+#include "ros/header.h"
+#include "ros/service_manager.h"
+#include "ros/transport/transport_tcp.h"
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/scope_exit.hpp"
+
+#include "ros1_bridge/bridge_discovery.hpp"
+#include "ros1_bridge/bridge_services.hpp"
+#include "ros1_bridge/discovery_statistics.hpp"
+#include "ros1_bridge/topic_statistics.hpp"
+#include "ros1_bridge/tracepoints.hpp"
+
+namespace ros1_bridge
+{
+
+namespace
+{
+
+void
+get_ros1_service_info(
+  const std::string name, std::map<std::string, std::map<std::string, std::string>> & ros1_services)
+{
+  // NOTE(rkozik):
+  // I tried to use Connection class but could not make it work
+  // auto callback = [](const ros::ConnectionPtr&, const ros::Header&)
+  //                 { printf("Callback\n"); return true; };
+  // ros::HeaderReceivedFunc f(callback);
+  // ros::ConnectionPtr connection(new ros::Connection);
+  // connection->initialize(transport, false, ros::HeaderReceivedFunc());
+  DiscoveryCallTimer call_timer("ros1_service_info");
+  ros::ServiceManager manager;
+  std::string host;
+  std::uint32_t port;
+  if (!manager.lookupService(name, host, port)) {
+    fprintf(stderr, "Failed to look up %s\n", name.data());
+    return;
+  }
+  ros::TransportTCPPtr transport(new ros::TransportTCP(nullptr, ros::TransportTCP::SYNCHRONOUS));
+  auto transport_exit = rclcpp::make_scope_exit([transport]() {
+        transport->close();
+      });
+  if (!transport->connect(host, port)) {
+    fprintf(stderr, "Failed to connect to %s:%d\n", host.data(), port);
+    return;
+  }
+  ros::M_string header_out;
+  header_out["probe"] = "1";
+  header_out["md5sum"] = "*";
+  header_out["service"] = name;
+  header_out["callerid"] = ros::this_node::getName();
+  boost::shared_array<uint8_t> buffer;
+  uint32_t len;
+  ros::Header::write(header_out, buffer, len);
+  std::vector<uint8_t> message(len + 4);
+  std::memcpy(&message[0], &len, 4);
+  std::memcpy(&message[4], buffer.get(), len);
+  transport->write(message.data(), message.size());
+  uint32_t length;
+  auto read = transport->read(reinterpret_cast<uint8_t *>(&length), 4);
+  if (read != 4) {
+    fprintf(stderr, "Failed to read a response from a service server\n");
+    return;
+  }
+  std::vector<uint8_t> response(length);
+  read = transport->read(response.data(), length);
+  if (read < 0 || static_cast<uint32_t>(read) != length) {
+    fprintf(stderr, "Failed to read a response from a service server\n");
+    return;
+  }
+  std::string key = name;
+  ros1_services[key] = std::map<std::string, std::string>();
+  ros::Header header_in;
+  std::string error;
+  auto success = header_in.parse(response.data(), length, error);
+  if (!success) {
+    fprintf(stderr, "%s\n", error.data());
+    return;
+  }
+  for (std::string field : {"type"}) {
+    std::string value;
+    auto success = header_in.getValue(field, value);
+    if (!success) {
+      fprintf(stderr, "Failed to read '%s' from a header for '%s'\n", field.data(), key.c_str());
+      ros1_services.erase(key);
+      return;
+    }
+    ros1_services[key][field] = value;
+  }
+  std::string t = ros1_services[key]["type"];
+  ros1_services[key]["package"] = std::string(t.begin(), t.begin() + t.find("/"));
+  ros1_services[key]["name"] = std::string(t.begin() + t.find("/") + 1, t.end());
+}
+
+}  // namespace
+
+BridgeDiscovery::BridgeDiscovery(
+  ros::NodeHandle ros1_node, rclcpp::Node::SharedPtr ros2_node,
+  bool output_topic_introspection, bool bridge_all_1to2_topics, bool bridge_all_2to1_topics)
+: ros1_node_(ros1_node),
+  ros2_node_(ros2_node),
+  output_topic_introspection_(output_topic_introspection),
+  bridge_all_1to2_topics_(bridge_all_1to2_topics),
+  bridge_all_2to1_topics_(bridge_all_2to1_topics),
+  bridge_mutex_("bridge_mutex")
+{
+}
+
+void
+BridgeDiscovery::poll_ros1(const ros::TimerEvent &)
+{
+  ROS1_BRIDGE_TRACEPOINT_DISCOVERY_START("ros1");
+  auto discovery_start = std::chrono::steady_clock::now();
+
+  // collect all topics names which have at least one publisher or subscriber beside this bridge
+  std::set<std::string> active_publishers;
+  std::set<std::string> active_subscribers;
+
+  XmlRpc::XmlRpcValue args, result, payload;
+  args[0] = ros::this_node::getName();
+  bool got_system_state;
+  {
+    DiscoveryCallTimer call_timer("ros1_get_system_state");
+    got_system_state = ros::master::execute("getSystemState", args, result, payload, true);
+  }
+  if (!got_system_state) {
+    fprintf(stderr, "failed to get system state from ROS 1 master\n");
+    return;
+  }
+  // check publishers
+  if (payload.size() >= 1) {
+    for (int j = 0; j < payload[0].size(); ++j) {
+      std::string topic_name = payload[0][j][0];
+      for (int k = 0; k < payload[0][j][1].size(); ++k) {
+        std::string node_name = payload[0][j][1][k];
+        // ignore publishers from the bridge itself
+        if (node_name == ros::this_node::getName()) {
+          continue;
+        }
+        active_publishers.insert(topic_name);
+        break;
+      }
+    }
+  }
+  // check subscribers
+  if (payload.size() >= 2) {
+    for (int j = 0; j < payload[1].size(); ++j) {
+      std::string topic_name = payload[1][j][0];
+      for (int k = 0; k < payload[1][j][1].size(); ++k) {
+        std::string node_name = payload[1][j][1][k];
+        // ignore subscribers from the bridge itself
+        if (node_name == ros::this_node::getName()) {
+          continue;
+        }
+        active_subscribers.insert(topic_name);
+        break;
+      }
+    }
+  }
+
+  // check services
+  std::map<std::string, std::map<std::string, std::string>> active_ros1_services;
+  if (payload.size() >= 3) {
+    for (int j = 0; j < payload[2].size(); ++j) {
+      if (payload[2][j][0].getType() == XmlRpc::XmlRpcValue::TypeString) {
+        std::string name = payload[2][j][0];
+        // the services of this bridge are never bridged
+        if (is_bridge_service(name)) {
+          continue;
+        }
+        get_ros1_service_info(name, active_ros1_services);
+      }
+    }
+  }
+  {
+    InstrumentedLockGuard lock(bridge_mutex_, "ros1_poll_services");
+    ros1_services_ = active_ros1_services;
+  }
+
+  // get message types for all topics
+  ros::master::V_TopicInfo topics;
+  bool success;
+  {
+    DiscoveryCallTimer call_timer("ros1_get_topics");
+    success = ros::master::getTopics(topics);
+  }
+  if (!success) {
+    fprintf(stderr, "failed to poll ROS 1 master\n");
+    return;
+  }
+
+  std::map<std::string, std::string> current_ros1_publishers;
+  std::map<std::string, std::string> current_ros1_subscribers;
+  for (auto topic : topics) {
+    auto topic_name = topic.name;
+    bool has_publisher = active_publishers.find(topic_name) != active_publishers.end();
+    bool has_subscriber = active_subscribers.find(topic_name) != active_subscribers.end();
+    if (!has_publisher && !has_subscriber) {
+      // skip inactive topics
+      continue;
+    }
+    if (has_publisher) {
+      current_ros1_publishers[topic_name] = topic.datatype;
+    }
+    if (has_subscriber) {
+      current_ros1_subscribers[topic_name] = topic.datatype;
+    }
+    if (output_topic_introspection_) {
+      printf("  ROS 1: %s (%s) [%s pubs, %s subs]\n",
+        topic_name.c_str(), topic.datatype.c_str(),
+        has_publisher ? ">0" : "0", has_subscriber ? ">0" : "0");
+    }
+  }
+
+  // since ROS 1 subscribers don't report their type they must be added anyway
+  for (auto active_subscriber : active_subscribers) {
+    if (current_ros1_subscribers.find(active_subscriber) == current_ros1_subscribers.end()) {
+      current_ros1_subscribers[active_subscriber] = "";
+      if (output_topic_introspection_) {
+        printf("  ROS 1: %s (<unknown>) sub++\n", active_subscriber.c_str());
+      }
+    }
+  }
+
+  if (output_topic_introspection_) {
+    printf("\n");
+  }
+
+  {
+    InstrumentedLockGuard lock(bridge_mutex_, "ros1_poll_topics");
+    ros1_publishers_ = current_ros1_publishers;
+    ros1_subscribers_ = current_ros1_subscribers;
+  }
+  ROS1_BRIDGE_TRACEPOINT_DISCOVERY_END(
+    "ros1", current_ros1_publishers.size() + current_ros1_subscribers.size());
+
+  update_bridge();
+  add_discovery_cycle("ros1", std::chrono::steady_clock::now() - discovery_start);
+}
+
+void
+BridgeDiscovery::poll_ros2()
+{
+  ROS1_BRIDGE_TRACEPOINT_DISCOVERY_START("ros2");
+  auto discovery_start = std::chrono::steady_clock::now();
+
+  std::map<std::string, std::vector<std::string>> ros2_topics;
+  {
+    DiscoveryCallTimer call_timer("ros2_get_topic_names_and_types");
+    ros2_topics = ros2_node_->get_topic_names_and_types();
+  }
+
+  std::set<std::string> ignored_topics;
+  ignored_topics.insert("parameter_events");
+
+  std::map<std::string, std::string> current_ros2_publishers;
+  std::map<std::string, std::string> current_ros2_subscribers;
+  for (auto topic_and_types : ros2_topics) {
+    // ignore some common ROS 2 specific topics
+    if (ignored_topics.find(topic_and_types.first) != ignored_topics.end()) {
+      continue;
+    }
+
+    auto & topic_name = topic_and_types.first;
+    auto & topic_type = topic_and_types.second[0];  // explicitly take the first
+
+    // explicitly avoid topics with more than one type
+    if (topic_and_types.second.size() > 1) {
+      if (already_ignored_topics_.count(topic_name) == 0) {
+        std::string types = "";
+        for (auto type : topic_and_types.second) {
+          types += type + ", ";
+        }
+        fprintf(
+          stderr,
+          "warning: ignoring topic '%s', which has more than one type: [%s]\n",
+          topic_name.c_str(),
+          types.substr(0, types.length() - 2).c_str()
+        );
+        already_ignored_topics_.insert(topic_name);
+      }
+      continue;
+    }
+
+    size_t publisher_count;
+    {
+      DiscoveryCallTimer call_timer("ros2_count_publishers");
+      publisher_count = ros2_node_->count_publishers(topic_name);
+    }
+    size_t subscriber_count;
+    {
+      DiscoveryCallTimer call_timer("ros2_count_subscribers");
+      subscriber_count = ros2_node_->count_subscribers(topic_name);
+    }
+
+    // ignore publishers from the bridge itself
+    if (bridges_1to2_.find(topic_name) != bridges_1to2_.end()) {
+      if (publisher_count > 0) {
+        --publisher_count;
+      }
+    }
+    // ignore subscribers from the bridge itself
+    if (bridges_2to1_.find(topic_name) != bridges_2to1_.end()) {
+      if (subscriber_count > 0) {
+        --subscriber_count;
+      }
+    }
+
+    if (publisher_count) {
+      current_ros2_publishers[topic_name] = topic_type;
+    }
+
+    if (subscriber_count) {
+      current_ros2_subscribers[topic_name] = topic_type;
+    }
+
+    if (output_topic_introspection_) {
+      printf("  ROS 2: %s (%s) [%ld pubs, %ld subs]\n",
+        topic_name.c_str(), topic_type.c_str(), publisher_count, subscriber_count);
+    }
+  }
+
+  std::map<std::string, std::vector<std::string>> ros2_services_and_types;
+  {
+    DiscoveryCallTimer call_timer("ros2_get_service_names_and_types");
+    ros2_services_and_types = ros2_node_->get_service_names_and_types();
+  }
+  std::map<std::string, std::map<std::string, std::string>> active_ros2_services;
+  for (const auto & service_and_types : ros2_services_and_types) {
+    auto & service_name = service_and_types.first;
+    auto & service_type = service_and_types.second[0];  // explicitly take the first
+
+    // the services of this bridge are never bridged
+    if (is_bridge_service(service_name)) {
+      continue;
+    }
+
+    // explicitly avoid services with more than one type
+    if (service_and_types.second.size() > 1) {
+      if (already_ignored_services_.count(service_name) == 0) {
+        std::string types = "";
+        for (auto type : service_and_types.second) {
+          types += type + ", ";
+        }
+        fprintf(
+          stderr,
+          "warning: ignoring service '%s', which has more than one type: [%s]\n",
+          service_name.c_str(),
+          types.substr(0, types.length() - 2).c_str()
+        );
+        already_ignored_services_.insert(service_name);
+      }
+      continue;
+    }
+
+    // TODO(wjwwood): this should be common functionality in the C++ rosidl package
+    size_t separator_position = service_type.find('/');
+    if (separator_position == std::string::npos) {
+      fprintf(stderr, "invalid service type '%s', skipping...\n", service_type.c_str());
+      continue;
+    }
+    auto service_type_package_name = service_type.substr(0, separator_position);
+    auto service_type_srv_name = service_type.substr(separator_position + 1);
+
+    // TODO(wjwwood): fix bug where just a ros2 client will cause a ros1 service to be made
+    active_ros2_services[service_name]["package"] = service_type_package_name;
+    active_ros2_services[service_name]["name"] = service_type_srv_name;
+  }
+
+  {
+    InstrumentedLockGuard lock(bridge_mutex_, "ros2_poll_services");
+    ros2_services_ = active_ros2_services;
+  }
+
+  if (output_topic_introspection_) {
+    printf("\n");
+  }
+
+  {
+    InstrumentedLockGuard lock(bridge_mutex_, "ros2_poll_topics");
+    ros2_publishers_ = current_ros2_publishers;
+    ros2_subscribers_ = current_ros2_subscribers;
+  }
+  ROS1_BRIDGE_TRACEPOINT_DISCOVERY_END(
+    "ros2", current_ros2_publishers.size() + current_ros2_subscribers.size());
+
+  update_bridge();
+  add_discovery_cycle("ros2", std::chrono::steady_clock::now() - discovery_start);
+}
+
+void
+BridgeDiscovery::update_bridge()
+{
+  InstrumentedLockGuard lock(bridge_mutex_, "update_bridge");
+
+  // create 1to2 bridges
+  for (auto ros1_publisher : ros1_publishers_) {
+    // identify topics available as ROS 1 publishers as well as ROS 2 subscribers
+    auto topic_name = ros1_publisher.first;
+    std::string ros1_type_name = ros1_publisher.second;
+    std::string ros2_type_name;
+
+    // the statistics of the bridges are never bridged
+    if (is_statistics_topic(topic_name)) {
+      continue;
+    }
+
+    auto ros2_subscriber = ros2_subscribers_.find(topic_name);
+    if (ros2_subscriber == ros2_subscribers_.end()) {
+      if (!bridge_all_1to2_topics_) {
+        continue;
+      }
+      // update the ROS 2 type name to be that of the anticipated bridged type
+      // TODO(dhood): support non 1-1 "bridge-all" mappings
+      bool mapping_found = get_1to2_mapping(ros1_type_name, ros2_type_name);
+      if (!mapping_found) {
+        // printf("No known mapping for ROS 1 type '%s'\n", ros1_type_name.c_str());
+        continue;
+      }
+      // printf("topic name '%s' has ROS 2 publishers\n", topic_name.c_str());
+    } else {
+      ros2_type_name = ros2_subscriber->second;
+      // printf("topic name '%s' has ROS 1 publishers and ROS 2 subscribers\n", topic_name.c_str());
+    }
+
+    // check if 1to2 bridge for the topic exists
+    auto lifecycle_event = BridgeLifecycleEvent::CREATED;
+    if (bridges_1to2_.find(topic_name) != bridges_1to2_.end()) {
+      auto bridge = bridges_1to2_.find(topic_name)->second;
+      if (bridge.ros1_type_name == ros1_type_name && bridge.ros2_type_name == ros2_type_name) {
+        // skip if bridge with correct types is already in place
+        continue;
+      }
+      // remove existing bridge with previous types
+      bridges_1to2_.erase(topic_name);
+      lifecycle_event = BridgeLifecycleEvent::REPLACED;
+      printf("replace 1to2 bridge for topic '%s'\n", topic_name.c_str());
+    }
+
+    Bridge1to2HandlesAndMessageTypes bridge;
+    bridge.ros1_type_name = ros1_type_name;
+    bridge.ros2_type_name = ros2_type_name;
+
+    auto creation_start = std::chrono::steady_clock::now();
+    try {
+      bridge.bridge_handles = create_bridge_from_1_to_2(
+        ros1_node_, ros2_node_,
+        bridge.ros1_type_name, topic_name, 10,
+        bridge.ros2_type_name, topic_name, 10);
+    } catch (std::runtime_error & e) {
+      add_bridge_lifecycle_event(
+        "topic", "1to2", BridgeLifecycleEvent::FAILED,
+        std::chrono::steady_clock::now() - creation_start);
+      fprintf(
+        stderr,
+        "failed to create 1to2 bridge for topic '%s' "
+        "with ROS 1 type '%s' and ROS 2 type '%s': %s\n",
+        topic_name.c_str(), bridge.ros1_type_name.c_str(), bridge.ros2_type_name.c_str(), e.what());
+      if (std::string(e.what()).find("No template specialization") != std::string::npos) {
+        fprintf(stderr, "check the list of supported pairs with the `--print-pairs` option\n");
+      }
+      continue;
+    }
+
+    add_bridge_lifecycle_event(
+      "topic", "1to2", lifecycle_event, std::chrono::steady_clock::now() - creation_start);
+    bridges_1to2_[topic_name] = bridge;
+    printf(
+      "created 1to2 bridge for topic '%s' with ROS 1 type '%s' and ROS 2 type '%s'\n",
+      topic_name.c_str(), bridge.ros1_type_name.c_str(), bridge.ros2_type_name.c_str());
+  }
+
+  // create 2to1 bridges
+  for (auto ros2_publisher : ros2_publishers_) {
+    // identify topics available as ROS 1 subscribers as well as ROS 2 publishers
+    auto topic_name = ros2_publisher.first;
+    std::string ros2_type_name = ros2_publisher.second;
+    std::string ros1_type_name;
+
+    // the statistics of the bridges are never bridged
+    if (is_statistics_topic(topic_name)) {
+      continue;
+    }
+
+    auto ros1_subscriber = ros1_subscribers_.find(topic_name);
+    if (ros1_subscriber == ros1_subscribers_.end()) {
+      if (!bridge_all_2to1_topics_) {
+        continue;
+      }
+      // update the ROS 1 type name to be that of the anticipated bridged type
+      // TODO(dhood): support non 1-1 "bridge-all" mappings
+      bool mapping_found = get_2to1_mapping(ros2_type_name, ros1_type_name);
+      if (!mapping_found) {
+        // printf("No known mapping for ROS 2 type '%s'\n", ros2_type_name.c_str());
+        continue;
+      }
+      // printf("topic name '%s' has ROS 2 publishers\n", topic_name.c_str());
+    } else {
+      ros1_type_name = ros1_subscriber->second;
+      // printf("topic name '%s' has ROS 1 subscribers and ROS 2 publishers\n", topic_name.c_str());
+    }
+
+    // check if 2to1 bridge for the topic exists
+    auto lifecycle_event = BridgeLifecycleEvent::CREATED;
+    if (bridges_2to1_.find(topic_name) != bridges_2to1_.end()) {
+      auto bridge = bridges_2to1_.find(topic_name)->second;
+      if ((bridge.ros1_type_name == ros1_type_name || bridge.ros1_type_name == "") &&
+        bridge.ros2_type_name == ros2_type_name)
+      {
+        // skip if bridge with correct types is already in place
+        continue;
+      }
+      // remove existing bridge with previous types
+      bridges_2to1_.erase(topic_name);
+      lifecycle_event = BridgeLifecycleEvent::REPLACED;
+      printf("replace 2to1 bridge for topic '%s'\n", topic_name.c_str());
+    }
+
+    Bridge2to1HandlesAndMessageTypes bridge;
+    bridge.ros1_type_name = ros1_type_name;
+    bridge.ros2_type_name = ros2_type_name;
+
+    auto creation_start = std::chrono::steady_clock::now();
+    try {
+      bridge.bridge_handles = create_bridge_from_2_to_1(
+        ros2_node_, ros1_node_,
+        bridge.ros2_type_name, topic_name, 10,
+        bridge.ros1_type_name, topic_name, 10);
+    } catch (std::runtime_error & e) {
+      add_bridge_lifecycle_event(
+        "topic", "2to1", BridgeLifecycleEvent::FAILED,
+        std::chrono::steady_clock::now() - creation_start);
+      fprintf(
+        stderr,
+        "failed to create 2to1 bridge for topic '%s' "
+        "with ROS 2 type '%s' and ROS 1 type '%s': %s\n",
+        topic_name.c_str(), bridge.ros2_type_name.c_str(), bridge.ros1_type_name.c_str(), e.what());
+      if (std::string(e.what()).find("No template specialization") != std::string::npos) {
+        fprintf(stderr, "check the list of supported pairs with the `--print-pairs` option\n");
+      }
+      continue;
+    }
+
+    add_bridge_lifecycle_event(
+      "topic", "2to1", lifecycle_event, std::chrono::steady_clock::now() - creation_start);
+    bridges_2to1_[topic_name] = bridge;
+    printf(
+      "created 2to1 bridge for topic '%s' with ROS 2 type '%s' and ROS 1 type '%s'\n",
+      topic_name.c_str(), bridge.ros2_type_name.c_str(), bridge.ros1_type_name.c_str());
+  }
+
+  // remove obsolete bridges
+  std::vector<std::string> to_be_removed_1to2;
+  for (auto it : bridges_1to2_) {
+    std::string topic_name = it.first;
+    if (
+      ros1_publishers_.find(topic_name) == ros1_publishers_.end() ||
+      (!bridge_all_1to2_topics_ && ros2_subscribers_.find(topic_name) == ros2_subscribers_.end()))
+    {
+      to_be_removed_1to2.push_back(topic_name);
+    }
+  }
+  for (auto topic_name : to_be_removed_1to2) {
+    bridges_1to2_.erase(topic_name);
+    add_bridge_lifecycle_event(
+      "topic", "1to2", BridgeLifecycleEvent::REMOVED);
+    printf("removed 1to2 bridge for topic '%s'\n", topic_name.c_str());
+  }
+
+  std::vector<std::string> to_be_removed_2to1;
+  for (auto it : bridges_2to1_) {
+    std::string topic_name = it.first;
+    if (
+      (!bridge_all_2to1_topics_ && ros1_subscribers_.find(topic_name) == ros1_subscribers_.end()) ||
+      ros2_publishers_.find(topic_name) == ros2_publishers_.end())
+    {
+      to_be_removed_2to1.push_back(topic_name);
+    }
+  }
+  for (auto topic_name : to_be_removed_2to1) {
+    bridges_2to1_.erase(topic_name);
+    add_bridge_lifecycle_event(
+      "topic", "2to1", BridgeLifecycleEvent::REMOVED);
+    printf("removed 2to1 bridge for topic '%s'\n", topic_name.c_str());
+  }
+
+  // create bridges for ros1 services
+  for (auto & service : ros1_services_) {
+    auto & name = service.first;
+    auto & details = service.second;
+    if (
+      service_bridges_2_to_1_.find(name) == service_bridges_2_to_1_.end() &&
+      service_bridges_1_to_2_.find(name) == service_bridges_1_to_2_.end())
+    {
+      auto factory = get_service_factory(
+        "ros1", details.at("package"), details.at("name"));
+      if (factory) {
+        auto creation_start = std::chrono::steady_clock::now();
+        try {
+          service_bridges_2_to_1_[name] = factory->service_bridge_2_to_1(
+            ros1_node_, ros2_node_, name);
+          add_bridge_lifecycle_event(
+            "service", "2to1", BridgeLifecycleEvent::CREATED,
+            std::chrono::steady_clock::now() - creation_start);
+          printf("Created 2 to 1 bridge for service %s\n", name.data());
+        } catch (std::runtime_error & e) {
+          add_bridge_lifecycle_event(
+            "service", "2to1", BridgeLifecycleEvent::FAILED,
+            std::chrono::steady_clock::now() - creation_start);
+          fprintf(stderr, "Failed to created a bridge: %s\n", e.what());
+        }
+      }
+    }
+  }
+
+  // create bridges for ros2 services
+  for (auto & service : ros2_services_) {
+    auto & name = service.first;
+    auto & details = service.second;
+    if (
+      service_bridges_1_to_2_.find(name) == service_bridges_1_to_2_.end() &&
+      service_bridges_2_to_1_.find(name) == service_bridges_2_to_1_.end())
+    {
+      auto factory = get_service_factory(
+        "ros2", details.at("package"), details.at("name"));
+      if (factory) {
+        auto creation_start = std::chrono::steady_clock::now();
+        try {
+          service_bridges_1_to_2_[name] = factory->service_bridge_1_to_2(
+            ros1_node_, ros2_node_, name);
+          add_bridge_lifecycle_event(
+            "service", "1to2", BridgeLifecycleEvent::CREATED,
+            std::chrono::steady_clock::now() - creation_start);
+          printf("Created 1 to 2 bridge for service %s\n", name.data());
+        } catch (std::runtime_error & e) {
+          add_bridge_lifecycle_event(
+            "service", "1to2", BridgeLifecycleEvent::FAILED,
+            std::chrono::steady_clock::now() - creation_start);
+          fprintf(stderr, "Failed to created a bridge: %s\n", e.what());
+        }
+      }
+    }
+  }
+
+  // remove obsolete ros1 services
+  for (auto it = service_bridges_2_to_1_.begin(); it != service_bridges_2_to_1_.end(); ) {
+    if (ros1_services_.find(it->first) == ros1_services_.end()) {
+      printf("Removed 2 to 1 bridge for service %s\n", it->first.data());
+      try {
+        it = service_bridges_2_to_1_.erase(it);
+        add_bridge_lifecycle_event(
+          "service", "2to1", BridgeLifecycleEvent::REMOVED);
+      } catch (std::runtime_error & e) {
+        fprintf(stderr, "There was an error while removing 2 to 1 bridge: %s\n", e.what());
+      }
+    } else {
+      ++it;
+    }
+  }
+
+  // remove obsolete ros2 services
+  for (auto it = service_bridges_1_to_2_.begin(); it != service_bridges_1_to_2_.end(); ) {
+    if (ros2_services_.find(it->first) == ros2_services_.end()) {
+      printf("Removed 1 to 2 bridge for service %s\n", it->first.data());
+      try {
+        it->second.server.shutdown();
+        it = service_bridges_1_to_2_.erase(it);
+        add_bridge_lifecycle_event(
+          "service", "1to2", BridgeLifecycleEvent::REMOVED);
+      } catch (std::runtime_error & e) {
+        fprintf(stderr, "There was an error while removing 1 to 2 bridge: %s\n", e.what());
+      }
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace ros1_bridge
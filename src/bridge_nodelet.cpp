@@ -0,0 +1,88 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <string>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "pluginlib/class_list_macros.h"
+#include "ros/ros.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+#include "ros1_bridge/bridge_nodelet.hpp"
+#include "ros1_bridge/loopback_filter.hpp"
+
+namespace ros1_bridge
+{
+
+BridgeNodelet::~BridgeNodelet()
+{
+  running_ = false;
+  if (ros2_thread_.joinable()) {
+    ros2_thread_.join();
+  }
+  flight_recorder_service_.reset();
+  phase_timing_service_.reset();
+  statistics_publisher_.reset();
+  all_handles_.clear();
+}
+
+void
+BridgeNodelet::onInit()
+{
+  if (!rclcpp::ok()) {
+    // rclcpp installs its own SIGINT handler, which shuts down ROS 2 and then calls
+    // the handler of the nodelet manager installed before, so both stop on Ctrl-C
+    rclcpp::init(0, nullptr);
+  }
+
+  std::string node_name = getName();
+  // ROS 2 node names must not contain slashes
+  for (auto & c : node_name) {
+    if (c == '/') {
+      c = '_';
+    }
+  }
+  ros2_node_ = rclcpp::Node::make_shared(node_name.substr(node_name.find_first_not_of('_')));
+
+  // the nodelets in the manager share the caller id with the bridge
+  enable_ros1_loopback_filters();
+  ros::NodeHandle & ros1_node = getNodeHandle();
+  std::string parameter_name = getPrivateNodeHandle().resolveName("topics");
+  all_handles_ = create_bridges_from_parameter(ros1_node, ros2_node_, parameter_name);
+  NODELET_INFO("bridging %zu topics", all_handles_.size());
+  statistics_publisher_.reset(new StatisticsPublisher(ros1_node, ros2_node_));
+  phase_timing_service_.reset(new PhaseTimingService(ros2_node_));
+  flight_recorder_service_.reset(new FlightRecorderService(ros2_node_));
+
+  running_ = true;
+  ros2_thread_ = std::thread(
+    [this]() -> void
+    {
+      rclcpp::executors::SingleThreadedExecutor executor;
+      while (running_ && rclcpp::ok()) {
+        executor.spin_node_once(ros2_node_, std::chrono::milliseconds(100));
+      }
+    });
+}
+
+}  // namespace ros1_bridge
+
+PLUGINLIB_EXPORT_CLASS(ros1_bridge::BridgeNodelet, nodelet::Nodelet)
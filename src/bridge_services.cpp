@@ -0,0 +1,60 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "ros1_bridge/bridge_services.hpp"
+
+namespace ros1_bridge
+{
+
+const char * const phase_timing_service_name = "phase_timing";
+const char * const flight_recorder_service_name = "dump_flight_recorder";
+
+namespace
+{
+
+std::mutex g_bridge_services_mutex;
+// a multiset since several bridges in a process may offer a service with the same name
+std::multiset<std::string> g_bridge_services;
+
+}  // namespace
+
+void
+register_bridge_service(const std::string & service_name)
+{
+  std::lock_guard<std::mutex> lock(g_bridge_services_mutex);
+  g_bridge_services.insert(service_name);
+}
+
+void
+unregister_bridge_service(const std::string & service_name)
+{
+  std::lock_guard<std::mutex> lock(g_bridge_services_mutex);
+  auto it = g_bridge_services.find(service_name);
+  if (it != g_bridge_services.end()) {
+    g_bridge_services.erase(it);
+  }
+}
+
+bool
+is_bridge_service(const std::string & service_name)
+{
+  std::lock_guard<std::mutex> lock(g_bridge_services_mutex);
+  return g_bridge_services.count(service_name) != 0;
+}
+
+}  // namespace ros1_bridge
@@ -0,0 +1,234 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "ros/ros.h"
+#include "rosgraph_msgs/Clock.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+#include "ros/callback_queue.h"
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+#include "rosgraph_msgs/msg/clock.hpp"
+
+#include "ros1_bridge/command_options.hpp"
+
+
+using ros1_bridge::find_command_option;
+using ros1_bridge::get_command_option_number;
+
+bool parse_command_options(
+  int argc, char ** argv, bool & conflate, double & report_period, int & exit_code)
+{
+  std::vector<std::string> args(argv, argv + argc);
+  exit_code = 0;
+
+  if (find_command_option(args, "-h") || find_command_option(args, "--help")) {
+    std::stringstream ss;
+    ss << "Usage:" << std::endl;
+    ss << " -h, --help: This message." << std::endl;
+    ss << " --conflate: Only pass the latest /clock message along if the bridge falls behind.";
+    ss << std::endl;
+    ss << " --report-period <sec>: Period of the sim time skew report, 0 disables it ";
+    ss << "(default: 10)." << std::endl;
+    std::cout << ss.str();
+    return false;
+  }
+
+  conflate = find_command_option(args, "--conflate");
+  if (!get_command_option_number(args, "--report-period", 10.0, report_period)) {
+    exit_code = 1;
+    return false;
+  }
+  return true;
+}
+
+// Bridges /clock with a fixed conversion on a dedicated thread.
+// All state is preallocated and only touched by the ROS 1 callback thread.
+class ClockBridge
+{
+public:
+  ClockBridge(
+    rclcpp::Publisher<rosgraph_msgs::msg::Clock>::SharedPtr ros2_pub,
+    rclcpp::Logger logger, double report_period)
+  : ros2_pub_(ros2_pub),
+    logger_(logger),
+    report_period_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(report_period)))
+  {
+    reset_report();
+  }
+
+  void
+  ros1_callback(const ros::MessageEvent<rosgraph_msgs::Clock const> & ros1_msg_event)
+  {
+    auto callback_start = std::chrono::steady_clock::now();
+    const auto & ros1_msg = ros1_msg_event.getConstMessage();
+
+    // the message is reused, publishing by reference doesn't allocate
+    ros2_msg_.clock.sec = ros1_msg->clock.sec;
+    ros2_msg_.clock.nanosec = ros1_msg->clock.nsec;
+    ros2_pub_->publish(ros2_msg_);
+
+    auto published = std::chrono::steady_clock::now();
+    if (report_period_.count() <= 0) {
+      return;
+    }
+
+    // time spent inside the bridge, including the ROS 1 callback queue if it can be measured
+    auto latency = published - callback_start;
+    if (!ros::Time::isSimTime()) {
+      ros::Duration queued = ros::Time::now() - ros1_msg_event.getReceiptTime();
+      if (queued > ros::Duration(0)) {
+        latency += std::chrono::nanoseconds(queued.toNSec());
+      }
+    }
+    ++message_count_;
+    latency_sum_ += latency;
+    latency_min_ = std::min(latency_min_, latency);
+    latency_max_ = std::max(latency_max_, latency);
+
+    double sim_time = ros1_msg->clock.toSec();
+    if (message_count_ == 1) {
+      first_sim_time_ = sim_time;
+      first_wall_time_ = published;
+    }
+    last_sim_time_ = sim_time;
+
+    if (published - report_start_ >= report_period_) {
+      report(published);
+    }
+  }
+
+private:
+  void
+  report(std::chrono::steady_clock::time_point now)
+  {
+    using std::chrono::duration;
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    double wall_elapsed = duration<double>(now - first_wall_time_).count();
+    double real_time_factor =
+      wall_elapsed > 0.0 ? (last_sim_time_ - first_sim_time_) / wall_elapsed : 0.0;
+    auto latency_avg = latency_sum_ / message_count_;
+    // the ROS 2 side lags behind the ROS 1 side by the bridge latency scaled to sim time
+    double skew_avg_us = duration_cast<microseconds>(latency_avg).count() * real_time_factor;
+    double skew_max_us = duration_cast<microseconds>(latency_max_).count() * real_time_factor;
+
+    RCLCPP_INFO(
+      logger_,
+      "/clock: %lu msgs, real time factor %.3f, bridge latency [us] min %ld avg %ld max %ld, "
+      "sim time skew [us] avg %.1f max %.1f",
+      message_count_, real_time_factor,
+      static_cast<int64_t>(duration_cast<microseconds>(latency_min_).count()),
+      static_cast<int64_t>(duration_cast<microseconds>(latency_avg).count()),
+      static_cast<int64_t>(duration_cast<microseconds>(latency_max_).count()),
+      skew_avg_us, skew_max_us);
+
+    reset_report();
+    report_start_ = now;
+  }
+
+  void
+  reset_report()
+  {
+    report_start_ = std::chrono::steady_clock::now();
+    message_count_ = 0;
+    latency_sum_ = std::chrono::steady_clock::duration::zero();
+    latency_min_ = std::chrono::steady_clock::duration::max();
+    latency_max_ = std::chrono::steady_clock::duration::zero();
+  }
+
+  rclcpp::Publisher<rosgraph_msgs::msg::Clock>::SharedPtr ros2_pub_;
+  rosgraph_msgs::msg::Clock ros2_msg_;
+  rclcpp::Logger logger_;
+
+  std::chrono::steady_clock::duration report_period_;
+  std::chrono::steady_clock::time_point report_start_;
+  uint64_t message_count_;
+  std::chrono::steady_clock::duration latency_sum_;
+  std::chrono::steady_clock::duration latency_min_;
+  std::chrono::steady_clock::duration latency_max_;
+  double first_sim_time_ = 0.0;
+  double last_sim_time_ = 0.0;
+  std::chrono::steady_clock::time_point first_wall_time_;
+};
+
+int main(int argc, char * argv[])
+{
+  bool conflate;
+  double report_period;
+  int exit_code;
+  if (!parse_command_options(argc, argv, conflate, report_period, exit_code)) {
+    return exit_code;
+  }
+
+  // ROS 1 node
+  ros::init(argc, argv, "ros_bridge_clock");
+  ros::NodeHandle ros1_node;
+
+  // ROS 2 node
+  rclcpp::init(argc, argv);
+  auto ros2_node = rclcpp::Node::make_shared("ros_bridge_clock");
+
+  rmw_qos_profile_t clock_qos_profile = rmw_qos_profile_default;
+  clock_qos_profile.depth = 1;
+  auto ros2_pub = ros2_node->create_publisher<rosgraph_msgs::msg::Clock>(
+    "/clock", clock_qos_profile);
+
+  ClockBridge clock_bridge(ros2_pub, ros2_node->get_logger(), report_period);
+
+  // the /clock subscription uses its own callback queue and thread
+  // so it is never delayed by other callbacks of this process
+  ros::CallbackQueue clock_queue;
+  ros::SubscribeOptions ops;
+  ops.initByFullCallbackType<const ros::MessageEvent<rosgraph_msgs::Clock const> &>(
+    "/clock",
+    // a queue size of one drops all but the latest message
+    conflate ? 1 : 10,
+    boost::bind(&ClockBridge::ros1_callback, &clock_bridge, _1));
+  ops.callback_queue = &clock_queue;
+  ops.transport_hints = ros::TransportHints().tcpNoDelay();
+  auto ros1_sub = ros1_node.subscribe(ops);
+
+  ros::AsyncSpinner clock_spinner(1, &clock_queue);
+  clock_spinner.start();
+
+  // ROS 1 asynchronous spinner
+  ros::AsyncSpinner async_spinner(1);
+  async_spinner.start();
+
+  // ROS 2 spinning loop
+  rclcpp::executors::SingleThreadedExecutor executor;
+  while (ros1_node.ok() && rclcpp::ok()) {
+    executor.spin_node_once(ros2_node, std::chrono::milliseconds(1000));
+  }
+
+  return 0;
+}
@@ -0,0 +1,160 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ros1_bridge/command_options.hpp"
+#include "ros1_bridge/flight_recorder.hpp"
+
+// Print the events of a dump of the flight recorder, one per line, with the time since the
+// epoch, the time relative to the dump, the event type, the bridge and the values of the event.
+
+namespace
+{
+
+template<typename T>
+bool read_value(std::ifstream & in, T & value)
+{
+  return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+bool read_string(std::ifstream & in, std::string & value)
+{
+  uint16_t length;
+  if (!read_value(in, length)) {
+    return false;
+  }
+  value.resize(length);
+  return length == 0 || static_cast<bool>(in.read(&value[0], length));
+}
+
+std::string get_bridge_name(
+  const std::map<uint64_t, ros1_bridge::FlightRecordName> & names, uint64_t id)
+{
+  auto it = names.find(id);
+  if (it == names.end()) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "0x%" PRIx64, id);
+    return buffer;
+  }
+  return it->second.direction + " " + it->second.name + " (" + it->second.type + ")";
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  using ros1_bridge::find_command_option;
+
+  std::vector<std::string> args(argv, argv + argc);
+  if (argc != 2 || find_command_option(args, "-h") || find_command_option(args, "--help")) {
+    printf("Usage: decode_flight_record <dump file>\n");
+    return argc == 2 ? 0 : 1;
+  }
+
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in) {
+    fprintf(stderr, "failed to open '%s'\n", argv[1]);
+    return 1;
+  }
+  char magic[sizeof(ros1_bridge::flight_record_magic)];
+  if (
+    !in.read(magic, sizeof(magic)) ||
+    memcmp(magic, ros1_bridge::flight_record_magic, sizeof(magic)) != 0)
+  {
+    fprintf(stderr, "'%s' isn't a flight record of the bridge\n", argv[1]);
+    return 1;
+  }
+
+  uint64_t dump_steady_time;
+  uint64_t dump_system_time;
+  uint32_t name_count;
+  if (
+    !read_value(in, dump_steady_time) || !read_value(in, dump_system_time) ||
+    !read_value(in, name_count))
+  {
+    fprintf(stderr, "truncated flight record\n");
+    return 1;
+  }
+
+  std::map<uint64_t, ros1_bridge::FlightRecordName> names;
+  for (uint32_t i = 0; i < name_count; ++i) {
+    ros1_bridge::FlightRecordName name;
+    if (
+      !read_value(in, name.id) || !read_value(in, name.kind) ||
+      !read_string(in, name.direction) || !read_string(in, name.name) ||
+      !read_string(in, name.type))
+    {
+      fprintf(stderr, "truncated flight record\n");
+      return 1;
+    }
+    names[name.id] = name;
+  }
+
+  uint32_t event_count;
+  if (!read_value(in, event_count)) {
+    fprintf(stderr, "truncated flight record\n");
+    return 1;
+  }
+  for (uint32_t i = 0; i < event_count; ++i) {
+    uint64_t words[4];
+    if (!read_value(in, words)) {
+      fprintf(stderr, "truncated flight record\n");
+      return 1;
+    }
+    ros1_bridge::FlightEvent event;
+    event.time = words[0];
+    event.id = words[1];
+    event.value0 = static_cast<uint32_t>(words[2] >> 32);
+    event.value1 = static_cast<uint32_t>(words[2]);
+    event.value2 = static_cast<uint32_t>(words[3] >> 32);
+    event.type = static_cast<ros1_bridge::FlightEventType>(words[3] & 0xff);
+
+    // the events are stamped with the steady clock which is mapped to the system clock
+    int64_t relative_time = static_cast<int64_t>(event.time - dump_steady_time);
+    uint64_t system_time = dump_system_time + relative_time;
+    printf(
+      "%" PRIu64 ".%09" PRIu64 " %+.6f %s ",
+      system_time / 1000000000, system_time % 1000000000, relative_time / 1e9,
+      ros1_bridge::get_flight_event_type_name(event.type));
+
+    switch (event.type) {
+      case ros1_bridge::FlightEventType::MESSAGE:
+        printf(
+          "%s size=%u conversion_us=%.3f publish_us=%.3f\n",
+          get_bridge_name(names, event.id).c_str(), event.value0,
+          event.value1 / 1e3, event.value2 / 1e3);
+        break;
+      case ros1_bridge::FlightEventType::SERVICE_CALL:
+        printf(
+          "%s success=%u call_us=%u\n",
+          get_bridge_name(names, event.id).c_str(), event.value0, event.value1);
+        break;
+      case ros1_bridge::FlightEventType::DISCOVERY:
+        printf(
+          "%s cycle_us=%u\n", event.id == 1 ? "ros1" : "ros2", event.value1);
+        break;
+      default:
+        printf("%s\n", get_bridge_name(names, event.id).c_str());
+        break;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,176 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ros1_bridge/discovery_statistics.hpp"
+#include "ros1_bridge/flight_recorder.hpp"
+#include "ros1_bridge/startup_timing.hpp"
+
+namespace ros1_bridge
+{
+
+namespace
+{
+
+struct DiscoveryHistogram
+{
+  std::atomic<uint64_t> cycles{0};
+  DurationHistogram cycle_time;
+};
+
+DiscoveryHistogram g_ros1_discovery;
+DiscoveryHistogram g_ros2_discovery;
+
+}  // namespace
+
+void
+add_discovery_cycle(const std::string & side, std::chrono::nanoseconds cycle_time)
+{
+  DiscoveryHistogram & discovery = side == "ros1" ? g_ros1_discovery : g_ros2_discovery;
+  discovery.cycles.fetch_add(1, std::memory_order_relaxed);
+  discovery.cycle_time.add(cycle_time);
+  // the sides are identified by 1 (ROS 1) and 2 (ROS 2) instead of an address
+  record_flight_event(
+    FlightEventType::DISCOVERY, reinterpret_cast<const void *>(side == "ros1" ? 1 : 2), 0,
+    to_flight_value<std::chrono::microseconds>(cycle_time));
+  record_startup_phase(side == "ros1" ? "first_discovery_ros1" : "first_discovery_ros2");
+}
+
+std::vector<DiscoveryStatistics>
+get_discovery_statistics()
+{
+  std::vector<DiscoveryStatistics> all_statistics;
+  for (auto side : {"ros1", "ros2"}) {
+    const DiscoveryHistogram & discovery =
+      std::string(side) == "ros1" ? g_ros1_discovery : g_ros2_discovery;
+    DiscoveryStatistics statistics;
+    statistics.side = side;
+    statistics.cycles = discovery.cycles.load(std::memory_order_relaxed);
+    statistics.cycle_time = discovery.cycle_time.get_buckets();
+    statistics.cycle_time_sum = discovery.cycle_time.get_sum();
+    all_statistics.push_back(statistics);
+  }
+  return all_statistics;
+}
+
+namespace
+{
+
+// the discovery is not on the hot path, so its statistics are simply guarded by a mutex
+struct DiscoveryCallHistogram
+{
+  uint64_t calls = 0;
+  DurationHistogram call_time;
+};
+
+struct BridgeLifecycleCounts
+{
+  std::array<uint64_t, static_cast<size_t>(BridgeLifecycleEvent::EVENT_COUNT)> events {};
+  DurationHistogram creation_time;
+};
+
+std::mutex g_discovery_mutex;
+std::map<std::string, std::unique_ptr<DiscoveryCallHistogram>> g_discovery_calls;
+std::map<std::pair<std::string, std::string>, std::unique_ptr<BridgeLifecycleCounts>>
+g_bridge_lifecycles;
+
+}  // namespace
+
+void
+add_discovery_call(const std::string & call, std::chrono::nanoseconds call_time)
+{
+  std::lock_guard<std::mutex> lock(g_discovery_mutex);
+  auto & histogram = g_discovery_calls[call];
+  if (!histogram) {
+    histogram.reset(new DiscoveryCallHistogram());
+  }
+  ++histogram->calls;
+  histogram->call_time.add(call_time);
+}
+
+std::vector<DiscoveryCallStatistics>
+get_discovery_call_statistics()
+{
+  std::vector<DiscoveryCallStatistics> all_statistics;
+  std::lock_guard<std::mutex> lock(g_discovery_mutex);
+  for (const auto & call : g_discovery_calls) {
+    DiscoveryCallStatistics statistics;
+    statistics.call = call.first;
+    statistics.calls = call.second->calls;
+    statistics.call_time = call.second->call_time.get_buckets();
+    statistics.call_time_sum = call.second->call_time.get_sum();
+    all_statistics.push_back(statistics);
+  }
+  return all_statistics;
+}
+
+const char *
+get_bridge_lifecycle_event_name(BridgeLifecycleEvent event)
+{
+  switch (event) {
+    case BridgeLifecycleEvent::CREATED:
+      return "created";
+    case BridgeLifecycleEvent::REPLACED:
+      return "replaced";
+    case BridgeLifecycleEvent::FAILED:
+      return "failed";
+    case BridgeLifecycleEvent::REMOVED:
+      return "removed";
+    default:
+      return "unknown";
+  }
+}
+
+void
+add_bridge_lifecycle_event(
+  const std::string & kind, const std::string & direction, BridgeLifecycleEvent event,
+  std::chrono::nanoseconds creation_time)
+{
+  std::lock_guard<std::mutex> lock(g_discovery_mutex);
+  auto & counts = g_bridge_lifecycles[std::make_pair(kind, direction)];
+  if (!counts) {
+    counts.reset(new BridgeLifecycleCounts());
+  }
+  ++counts->events[static_cast<size_t>(event)];
+  if (event != BridgeLifecycleEvent::REMOVED) {
+    counts->creation_time.add(creation_time);
+  }
+}
+
+std::vector<BridgeLifecycleStatistics>
+get_bridge_lifecycle_statistics()
+{
+  std::vector<BridgeLifecycleStatistics> all_statistics;
+  std::lock_guard<std::mutex> lock(g_discovery_mutex);
+  for (const auto & lifecycle : g_bridge_lifecycles) {
+    BridgeLifecycleStatistics statistics;
+    statistics.kind = lifecycle.first.first;
+    statistics.direction = lifecycle.first.second;
+    statistics.events = lifecycle.second->events;
+    statistics.creation_time = lifecycle.second->creation_time.get_buckets();
+    statistics.creation_time_sum = lifecycle.second->creation_time.get_sum();
+    all_statistics.push_back(statistics);
+  }
+  return all_statistics;
+}
+
+}  // namespace ros1_bridge
@@ -0,0 +1,105 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdint>
+
+#include "ros1_bridge/duration_histogram.hpp"
+
+namespace ros1_bridge
+{
+
+constexpr size_t DurationHistogram::bucket_count;
+
+DurationHistogram::DurationHistogram()
+{
+  reset();
+}
+
+void
+DurationHistogram::reset()
+{
+  for (auto & bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  sum_.store(0, std::memory_order_relaxed);
+}
+
+void
+DurationHistogram::add(std::chrono::nanoseconds duration)
+{
+  // bucket i counts durations in [2^i, 2^(i+1)) ns, the last one everything above
+  uint64_t value = duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0;
+  size_t index = 0;
+  while (value >>= 1) {
+    ++index;
+  }
+  if (index >= bucket_count) {
+    index = bucket_count - 1;
+  }
+  buckets_[index].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(
+    duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0,
+    std::memory_order_relaxed);
+}
+
+DurationHistogram::Buckets
+DurationHistogram::get_buckets() const
+{
+  Buckets buckets;
+  for (size_t i = 0; i < bucket_count; ++i) {
+    buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+  }
+  return buckets;
+}
+
+std::chrono::nanoseconds
+DurationHistogram::get_sum() const
+{
+  return std::chrono::nanoseconds(sum_.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds
+DurationHistogram::get_quantile(const Buckets & buckets, double quantile)
+{
+  uint64_t total = 0;
+  for (uint64_t count : buckets) {
+    total += count;
+  }
+  if (total == 0) {
+    return std::chrono::nanoseconds(0);
+  }
+  uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(total));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < bucket_count; ++i) {
+    seen += buckets[i];
+    if (seen > rank) {
+      return std::chrono::nanoseconds(static_cast<int64_t>(1) << (i + 1));
+    }
+  }
+  return get_max(buckets);
+}
+
+std::chrono::nanoseconds
+DurationHistogram::get_max(const Buckets & buckets)
+{
+  for (size_t i = bucket_count; i > 0; --i) {
+    if (buckets[i - 1]) {
+      return std::chrono::nanoseconds(static_cast<int64_t>(1) << i);
+    }
+  }
+  return std::chrono::nanoseconds(0);
+}
+
+}  // namespace ros1_bridge
@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
+#include <csignal>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <set>
@@ -43,9 +46,21 @@
 #include "rclcpp/scope_exit.hpp"
 
 #include "ros1_bridge/bridge.hpp"
-
-
-std::mutex g_bridge_mutex;
+#include "ros1_bridge/bridge_services.hpp"
+#include "ros1_bridge/command_options.hpp"
+#include "ros1_bridge/discovery_statistics.hpp"
+#include "ros1_bridge/flight_recorder.hpp"
+#include "ros1_bridge/flight_recorder_service.hpp"
+#include "ros1_bridge/instrumented_mutex.hpp"
+#include "ros1_bridge/metrics_exporter.hpp"
+#include "ros1_bridge/phase_timing_service.hpp"
+#include "ros1_bridge/statistics_publisher.hpp"
+#include "ros1_bridge/topic_sharding.hpp"
+#include "ros1_bridge/tracepoints.hpp"
+#include "ros1_bridge/traffic_recorder.hpp"
+
+
+ros1_bridge::InstrumentedMutex g_bridge_mutex("g_bridge_mutex");
 
 namespace ros1_bridge {
     std::unique_ptr <ros1_bridge::ServiceFactoryInterface>
@@ -80,35 +95,32 @@ bool check_inregex_list(const std::vector <std::regex> &regex_list, const std::s
   return false;
 }
 
-bool find_command_option(const std::vector <std::string> &args, const std::string &option) {
-  return std::find(args.begin(), args.end(), option) != args.end();
-}
-
-bool get_flag_option(const std::vector <std::string> &args, const std::string &option) {
-  auto it = std::find(args.begin(), args.end(), option);
-  return it != args.end();
-}
-
-std::string
-get_flag_val(const std::vector <std::string> &args, const std::string &option, const std::string &default_val) {
-  auto it = std::find(args.begin(), args.end(), option);
-  if (it == args.end()) {
-    return default_val;
-  } else {
-    auto next = std::next(it);
-    if (next == args.end()) {
-      return default_val;
+bool split_weights(const std::string &list, std::vector<double> &weights) {
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    double weight;
+    if (!ros1_bridge::parse_number(item, weight)) {
+      std::cerr << "Invalid shard weight: '" << item << "'" << std::endl;
+      return false;
     }
-    return *next;
+    weights.push_back(weight);
   }
+  return true;
 }
 
 bool parse_command_options(
         int argc, char **argv, bool &output_topic_introspection,
         bool &bridge_all_1to2_topics, bool &bridge_all_2to1_topics,
         std::string &topic_rgxp_list_param, std::string &srv_rgxp_list_param,
-        std::string &node_suffix) {
+        std::string &node_suffix, size_t &shard_count, size_t &shard_index,
+        std::vector<double> &shard_weights, std::string &shard_topic_weights_param,
+        double &shard_timeout, uint16_t &metrics_port, std::string &metrics_socket,
+        std::string &traffic_trace, bool &record_traffic_payloads, int &exit_code) {
+  using ros1_bridge::find_command_option;
+  using ros1_bridge::get_command_option_value;
   std::vector <std::string> args(argv, argv + argc);
+  exit_code = 0;
 
   if (find_command_option(args, "-h") || find_command_option(args, "--help")) {
     std::stringstream ss;
@@ -130,11 +142,29 @@ bool parse_command_options(
     ss << std::endl;
     ss << " --node-suffix: Suffix used to uniquely identify this node ros12_bridge_<suffix> (default: default)";
     ss << std::endl;
+    ss << " --shard-count: Number of bridge processes splitting the topics and services between them (default: 1)";
+    ss << std::endl;
+    ss << " --shard-index: Index of this bridge process in [0, shard-count), the node is named ";
+    ss << "ros12_bridge_<suffix>_shard_<index> (default: 0)" << std::endl;
+    ss << " --shard-weights: Comma separated relative capacity of each shard (default: 1 for every shard)";
+    ss << std::endl;
+    ss << " --shard-topic-weights: ROS1 param holding a list of {topic, weight} dictionaries, e.g. the ";
+    ss << "bandwidth, which are balanced explicitly (default: shard_topic_weights)" << std::endl;
+    ss << " --shard-timeout: Seconds after which the topics of a vanished shard are reassigned (default: 5)";
+    ss << std::endl;
+    ss << " --metrics-port: Serve OpenMetrics on this port of the loopback interface (default: disabled)";
+    ss << std::endl;
+    ss << " --metrics-socket: Serve OpenMetrics on a Unix domain socket at this path (default: disabled)";
+    ss << std::endl;
+    ss << " --record-traffic: Record the shape of the bridged traffic to a trace file for replay_traffic (default: disabled)";
+    ss << std::endl;
+    ss << " --record-traffic-payloads: Record the payload of every message, not only the first one of every topic";
+    ss << std::endl;
     std::cout << ss.str();
     return false;
   }
 
-  if (get_flag_option(args, "--print-pairs")) {
+  if (find_command_option(args, "--print-pairs")) {
     auto mappings_2to1 = ros1_bridge::get_all_message_mappings_2to1();
     if (mappings_2to1.size() > 0) {
       printf("Supported ROS 2 <=> ROS 1 message type conversion pairs:\n");
@@ -156,15 +186,42 @@ bool parse_command_options(
     return false;
   }
 
-  output_topic_introspection = get_flag_option(args, "--show-introspection");
+  output_topic_introspection = find_command_option(args, "--show-introspection");
 
-  bool bridge_all_topics = get_flag_option(args, "--bridge-all-topics");
-  bridge_all_1to2_topics = bridge_all_topics || get_flag_option(args, "--bridge-all-1to2-topics");
-  bridge_all_2to1_topics = bridge_all_topics || get_flag_option(args, "--bridge-all-2to1-topics");
+  bool bridge_all_topics = find_command_option(args, "--bridge-all-topics");
+  bridge_all_1to2_topics =
+          bridge_all_topics || find_command_option(args, "--bridge-all-1to2-topics");
+  bridge_all_2to1_topics =
+          bridge_all_topics || find_command_option(args, "--bridge-all-2to1-topics");
 
-  topic_rgxp_list_param = get_flag_val(args, "--topic-regex-list", "topics_re");
-  srv_rgxp_list_param = get_flag_val(args, "--service-regex-list", "services_re");
-  node_suffix = get_flag_val(args, "--node-suffix", "default");
+  topic_rgxp_list_param = get_command_option_value(args, "--topic-regex-list", "topics_re");
+  srv_rgxp_list_param = get_command_option_value(args, "--service-regex-list", "services_re");
+  node_suffix = get_command_option_value(args, "--node-suffix", "default");
+
+  // an invalid value of the options below exits with 1
+  exit_code = 1;
+  if (!ros1_bridge::get_command_option_number(args, "--shard-count", size_t{1}, shard_count) ||
+      !ros1_bridge::get_command_option_number(args, "--shard-index", size_t{0}, shard_index)) {
+    return false;
+  }
+  if (shard_count == 0 || shard_index >= shard_count) {
+    std::cerr << "The shard index must be smaller than the shard count" << std::endl;
+    return false;
+  }
+  if (!split_weights(get_command_option_value(args, "--shard-weights", ""), shard_weights)) {
+    return false;
+  }
+  shard_topic_weights_param =
+          get_command_option_value(args, "--shard-topic-weights", "shard_topic_weights");
+  if (!ros1_bridge::get_command_option_number(args, "--shard-timeout", 5.0, shard_timeout) ||
+      !ros1_bridge::get_command_option_number(args, "--metrics-port", uint16_t{0}, metrics_port)) {
+    return false;
+  }
+  exit_code = 0;
+  metrics_socket = get_command_option_value(args, "--metrics-socket", "");
+
+  traffic_trace = get_command_option_value(args, "--record-traffic", "");
+  record_traffic_payloads = find_command_option(args, "--record-traffic-payloads");
 
   return true;
 }
@@ -182,8 +239,9 @@ void update_bridge(
         std::map <std::string, Bridge2to1HandlesAndMessageTypes> &bridges_2to1,
         std::map <std::string, ros1_bridge::ServiceBridge1to2> &service_bridges_1_to_2,
         std::map <std::string, ros1_bridge::ServiceBridge2to1> &service_bridges_2_to_1,
-        bool bridge_all_1to2_topics, bool bridge_all_2to1_topics) {
-  std::lock_guard <std::mutex> lock(g_bridge_mutex);
+        bool bridge_all_1to2_topics, bool bridge_all_2to1_topics,
+        const ros1_bridge::TopicSharding &sharding) {
+  ros1_bridge::InstrumentedLockGuard lock(g_bridge_mutex, "update_bridge");
 
   // create 1to2 bridges
   for (const auto& ros1_publisher : ros1_publishers) {
@@ -192,6 +250,11 @@ void update_bridge(
     std::string ros1_type_name = ros1_publisher.second;
     std::string ros2_type_name;
 
+    // skip the statistics of the bridges and topics bridged by another shard
+    if (ros1_bridge::is_statistics_topic(topic_name) || !sharding.is_local(topic_name)) {
+      continue;
+    }
+
     auto ros2_subscriber = ros2_subscribers.find(topic_name);
     if (ros2_subscriber == ros2_subscribers.end()) {
       if (!bridge_all_1to2_topics) {
@@ -211,6 +274,7 @@ void update_bridge(
     }
 
     // check if 1to2 bridge for the topic exists
+    auto lifecycle_event = ros1_bridge::BridgeLifecycleEvent::CREATED;
     auto it = bridges_1to2.find(topic_name);
     if (it != bridges_1to2.end()) {
       const auto& bridge = it->second;
@@ -220,6 +284,7 @@ void update_bridge(
       }
       // remove existing bridge with previous types
       bridges_1to2.erase(it);
+      lifecycle_event = ros1_bridge::BridgeLifecycleEvent::REPLACED;
       RCUTILS_LOG_INFO("replace 1to2 bridge for topic '%s'\n", topic_name.c_str());
     }
 
@@ -227,12 +292,16 @@ void update_bridge(
     bridge.ros1_type_name = ros1_type_name;
     bridge.ros2_type_name = ros2_type_name;
 
+    auto creation_start = std::chrono::steady_clock::now();
     try {
       bridge.bridge_handles = ros1_bridge::create_bridge_from_1_to_2(
               ros1_node, ros2_node,
               bridge.ros1_type_name, topic_name, 10,
               bridge.ros2_type_name, topic_name, 10);
     } catch (const std::runtime_error &e) {
+      ros1_bridge::add_bridge_lifecycle_event(
+              "topic", "1to2", ros1_bridge::BridgeLifecycleEvent::FAILED,
+              std::chrono::steady_clock::now() - creation_start);
       RCUTILS_LOG_ERROR(
               "failed to create 1to2 bridge for topic '%s' "
               "with ROS 1 type '%s' and ROS 2 type '%s': %s\n",
@@ -243,6 +312,8 @@ void update_bridge(
       continue;
     }
 
+    ros1_bridge::add_bridge_lifecycle_event(
+            "topic", "1to2", lifecycle_event, std::chrono::steady_clock::now() - creation_start);
     bridges_1to2[topic_name] = bridge;
     RCUTILS_LOG_INFO(
             "created 1to2 bridge for topic '%s' with ROS 1 type '%s' and ROS 2 type '%s'\n",
@@ -256,6 +327,11 @@ void update_bridge(
     std::string ros2_type_name = ros2_publisher.second;
     std::string ros1_type_name;
 
+    // skip the statistics of the bridges and topics bridged by another shard
+    if (ros1_bridge::is_statistics_topic(topic_name) || !sharding.is_local(topic_name)) {
+      continue;
+    }
+
     auto ros1_subscriber = ros1_subscribers.find(topic_name);
     if (ros1_subscriber == ros1_subscribers.end()) {
       if (!bridge_all_2to1_topics) {
@@ -275,6 +351,7 @@ void update_bridge(
     }
 
     // check if 2to1 bridge for the topic exists
+    auto lifecycle_event = ros1_bridge::BridgeLifecycleEvent::CREATED;
     auto it = bridges_2to1.find(topic_name);
     if (it != bridges_2to1.end()) {
       const auto& bridge = it->second;
@@ -285,6 +362,7 @@ void update_bridge(
       }
       // remove existing bridge with previous types
       bridges_2to1.erase(it);
+      lifecycle_event = ros1_bridge::BridgeLifecycleEvent::REPLACED;
       RCUTILS_LOG_INFO("replace 2to1 bridge for topic '%s'\n", topic_name.c_str());
     }
 
@@ -292,12 +370,16 @@ void update_bridge(
     bridge.ros1_type_name = ros1_type_name;
     bridge.ros2_type_name = ros2_type_name;
 
+    auto creation_start = std::chrono::steady_clock::now();
     try {
       bridge.bridge_handles = ros1_bridge::create_bridge_from_2_to_1(
               ros2_node, ros1_node,
               bridge.ros2_type_name, topic_name, 10,
               bridge.ros1_type_name, topic_name, 10);
     } catch (const std::runtime_error &e) {
+      ros1_bridge::add_bridge_lifecycle_event(
+              "topic", "2to1", ros1_bridge::BridgeLifecycleEvent::FAILED,
+              std::chrono::steady_clock::now() - creation_start);
       RCUTILS_LOG_ERROR(
               "failed to create 2to1 bridge for topic '%s' "
               "with ROS 2 type '%s' and ROS 1 type '%s': %s\n",
@@ -308,12 +390,43 @@ void update_bridge(
       continue;
     }
 
+    ros1_bridge::add_bridge_lifecycle_event(
+            "topic", "2to1", lifecycle_event, std::chrono::steady_clock::now() - creation_start);
     bridges_2to1[topic_name] = bridge;
     RCUTILS_LOG_INFO(
             "created 2to1 bridge for topic '%s' with ROS 2 type '%s' and ROS 1 type '%s'\n",
             topic_name.c_str(), bridge.ros2_type_name.c_str(), bridge.ros1_type_name.c_str());
   }
 
+  // remove bridges for topics which have been reassigned to another shard,
+  // e.g. a shard which was considered dead came back
+  // unlike the removal of obsolete bridges below this is deliberately enabled: without it a
+  // shard which came back and its stand-in would both bridge the topic forever, and the
+  // hand over only happens once the owner has been live for the shard timeout, so a flapping
+  // shard doesn't tear down the bridges on an unreliable network
+  for (auto it = bridges_1to2.begin(); it != bridges_1to2.end();) {
+    if (sharding.is_handed_over(it->first)) {
+      RCUTILS_LOG_INFO("removed 1to2 bridge for topic '%s' owned by shard %zu\n",
+                       it->first.c_str(), sharding.get_shard(it->first));
+      it = bridges_1to2.erase(it);
+      ros1_bridge::add_bridge_lifecycle_event(
+              "topic", "1to2", ros1_bridge::BridgeLifecycleEvent::REMOVED);
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = bridges_2to1.begin(); it != bridges_2to1.end();) {
+    if (sharding.is_handed_over(it->first)) {
+      RCUTILS_LOG_INFO("removed 2to1 bridge for topic '%s' owned by shard %zu\n",
+                       it->first.c_str(), sharding.get_shard(it->first));
+      it = bridges_2to1.erase(it);
+      ros1_bridge::add_bridge_lifecycle_event(
+              "topic", "2to1", ros1_bridge::BridgeLifecycleEvent::REMOVED);
+    } else {
+      ++it;
+    }
+  }
+
   // remove obsolete bridges
   //Below appears to cause stability issues on unreliable networks.
   /*
@@ -352,15 +465,23 @@ void update_bridge(
     auto &name = service.first;
     auto &details = service.second;
     if (
+            sharding.is_local(name) &&
             service_bridges_2_to_1.find(name) == service_bridges_2_to_1.end() &&
             service_bridges_1_to_2.find(name) == service_bridges_1_to_2.end()) {
       auto factory = ros1_bridge::get_service_factory(
               "ros1", details.at("package"), details.at("name"));
       if (factory) {
+        auto creation_start = std::chrono::steady_clock::now();
         try {
           service_bridges_2_to_1[name] = factory->service_bridge_2_to_1(ros1_node, ros2_node, name);
+          ros1_bridge::add_bridge_lifecycle_event(
+                  "service", "2to1", ros1_bridge::BridgeLifecycleEvent::CREATED,
+                  std::chrono::steady_clock::now() - creation_start);
           RCUTILS_LOG_INFO("Created 2 to 1 bridge for service %s\n", name.data());
         } catch (const std::runtime_error &e) {
+          ros1_bridge::add_bridge_lifecycle_event(
+                  "service", "2to1", ros1_bridge::BridgeLifecycleEvent::FAILED,
+                  std::chrono::steady_clock::now() - creation_start);
           RCUTILS_LOG_ERROR("Failed to created a bridge: %s\n", e.what());
         }
       } else {
@@ -376,15 +497,23 @@ void update_bridge(
     auto &name = service.first;
     auto &details = service.second;
     if (
+            sharding.is_local(name) &&
             service_bridges_1_to_2.find(name) == service_bridges_1_to_2.end() &&
             service_bridges_2_to_1.find(name) == service_bridges_2_to_1.end()) {
       auto factory = ros1_bridge::get_service_factory(
               "ros2", details.at("package"), details.at("name"));
       if (factory) {
+        auto creation_start = std::chrono::steady_clock::now();
         try {
           service_bridges_1_to_2[name] = factory->service_bridge_1_to_2(ros1_node, ros2_node, name);
+          ros1_bridge::add_bridge_lifecycle_event(
+                  "service", "1to2", ros1_bridge::BridgeLifecycleEvent::CREATED,
+                  std::chrono::steady_clock::now() - creation_start);
           RCUTILS_LOG_INFO("Created 1 to 2 bridge for service %s\n", name.data());
         } catch (const std::runtime_error &e) {
+          ros1_bridge::add_bridge_lifecycle_event(
+                  "service", "1to2", ros1_bridge::BridgeLifecycleEvent::FAILED,
+                  std::chrono::steady_clock::now() - creation_start);
           RCUTILS_LOG_ERROR("Failed to created a bridge: %s\n", e.what());
         }
       } else {
@@ -397,10 +526,13 @@ void update_bridge(
 
   // remove obsolete ros1 services
   for (auto it = service_bridges_2_to_1.begin(); it != service_bridges_2_to_1.end();) {
-    if (ros1_services.find(it->first) == ros1_services.end()) {
+    if (ros1_services.find(it->first) == ros1_services.end() ||
+        sharding.is_handed_over(it->first)) {
       RCUTILS_LOG_INFO("Removed 2 to 1 bridge for service %s\n", it->first.data());
       try {
         it = service_bridges_2_to_1.erase(it);
+        ros1_bridge::add_bridge_lifecycle_event(
+                "service", "2to1", ros1_bridge::BridgeLifecycleEvent::REMOVED);
       } catch (const std::runtime_error &e) {
         RCUTILS_LOG_ERROR("There was an error while removing 2 to 1 bridge: %s\n", e.what());
       }
@@ -411,11 +543,14 @@ void update_bridge(
 
   // remove obsolete ros2 services
   for (auto it = service_bridges_1_to_2.begin(); it != service_bridges_1_to_2.end();) {
-    if (ros2_services.find(it->first) == ros2_services.end()) {
+    if (ros2_services.find(it->first) == ros2_services.end() ||
+        sharding.is_handed_over(it->first)) {
       RCUTILS_LOG_INFO("Removed 1 to 2 bridge for service %s\n", it->first.data());
       try {
         it->second.server.shutdown();
         it = service_bridges_1_to_2.erase(it);
+        ros1_bridge::add_bridge_lifecycle_event(
+                "service", "1to2", ros1_bridge::BridgeLifecycleEvent::REMOVED);
       } catch (const std::runtime_error &e) {
         RCUTILS_LOG_ERROR("There was an error while removing 1 to 2 bridge: %s\n", e.what());
       }
@@ -434,6 +569,7 @@ void get_ros1_service_info(
   // ros::HeaderReceivedFunc f(callback);
   // ros::ConnectionPtr connection(new ros::Connection);
   // connection->initialize(transport, false, ros::HeaderReceivedFunc());
+  ros1_bridge::DiscoveryCallTimer call_timer("ros1_service_info");
   ros::ServiceManager manager;
   std::string host;
   std::uint32_t port;
@@ -505,20 +641,74 @@ int main(int argc, char *argv[]) {
   std::string topic_rgxp_list_param;
   std::string srv_rgxp_list_param;
   std::string node_suffix;
+  size_t shard_count;
+  size_t shard_index;
+  std::vector<double> shard_weights;
+  std::string shard_topic_weights_param;
+  double shard_timeout;
+  uint16_t metrics_port;
+  std::string metrics_socket;
+  std::string traffic_trace;
+  bool record_traffic_payloads;
+  int exit_code;
 
   if (!parse_command_options(
           argc, argv, output_topic_introspection, bridge_all_1to2_topics, bridge_all_2to1_topics,
-          topic_rgxp_list_param, srv_rgxp_list_param, node_suffix)) {
-    return 0;
+          topic_rgxp_list_param, srv_rgxp_list_param, node_suffix,
+          shard_count, shard_index, shard_weights, shard_topic_weights_param, shard_timeout,
+          metrics_port, metrics_socket, traffic_trace, record_traffic_payloads, exit_code)) {
+    return exit_code;
+  }
+
+  // all shards of a group share the node name prefix so they can find each other
+  std::string node_name = "ros12_bridge_" + node_suffix;
+  std::string shard_name_prefix = node_name + "_shard_";
+  if (shard_count > 1) {
+    node_name = shard_name_prefix + std::to_string(shard_index);
   }
 
   // ROS 1 node
-  ros::init(argc, argv, "ros12_bridge_" + node_suffix);
+  ros::init(argc, argv, node_name);
   ros::NodeHandle ros1_node;
 
   // ROS 2 node
   rclcpp::init(argc, argv);
-  auto ros2_node = rclcpp::Node::make_shared("ros12_bridge_" + node_suffix);
+  auto ros2_node = rclcpp::Node::make_shared(node_name);
+
+  ros1_bridge::TopicSharding sharding(shard_count, shard_index);
+  if (shard_count > 1) {
+    sharding.set_shard_weights(shard_weights);
+    std::map <std::string, double> topic_weights;
+    XmlRpc::XmlRpcValue weights;
+    if (
+            ros1_node.getParam(shard_topic_weights_param, weights) &&
+            weights.getType() == XmlRpc::XmlRpcValue::TypeArray) {
+      for (size_t i = 0; i < static_cast<size_t>(weights.size()); ++i) {
+        XmlRpc::XmlRpcValue &entry = weights[i];
+        if (
+                !entry.hasMember("topic") || !entry.hasMember("weight") ||
+                entry["topic"].getType() != XmlRpc::XmlRpcValue::TypeString) {
+          RCUTILS_LOG_ERROR("The entry %zu of '%s' needs a 'topic' string and a 'weight'. Ignoring it\n",
+                  i, shard_topic_weights_param.c_str());
+          continue;
+        }
+        std::string topic_name = static_cast<std::string>(entry["topic"]);
+        XmlRpc::XmlRpcValue &weight = entry["weight"];
+        // YAML yields an integer for a weight like 2
+        if (weight.getType() == XmlRpc::XmlRpcValue::TypeInt) {
+          topic_weights[topic_name] = static_cast<int>(weight);
+        } else if (weight.getType() == XmlRpc::XmlRpcValue::TypeDouble) {
+          topic_weights[topic_name] = static_cast<double>(weight);
+        } else {
+          RCUTILS_LOG_ERROR("The weight of '%s' in '%s' isn't a number. Ignoring it\n",
+                  topic_name.c_str(), shard_topic_weights_param.c_str());
+        }
+      }
+    }
+    sharding.set_topic_weights(topic_weights);
+    RCUTILS_LOG_INFO("bridging shard %zu of %zu (%zu explicitly weighted topics)\n",
+                     shard_index, shard_count, topic_weights.size());
+  }
 
   // mapping of available topic names to type names
   std::map <std::string, std::string> ros1_publishers;
@@ -571,15 +761,24 @@ int main(int argc, char *argv[]) {
           &bridge_all_1to2_topics, &bridge_all_2to1_topics,
           &topic_rgxp_list_param, &srv_rgxp_list_param,
           &already_ignored_ros1_topics, &already_ignored_ros1_services,
-          &whitelist_map, &valid_ros1_topics, &valid_ros1_services
+          &whitelist_map, &valid_ros1_topics, &valid_ros1_services,
+          &sharding
   ](const ros::TimerEvent &) -> void {
+      ROS1_BRIDGE_TRACEPOINT_DISCOVERY_START("ros1");
+      auto discovery_start = std::chrono::steady_clock::now();
+
       // collect all topics names which have at least one publisher or subscriber beside this bridge
       std::set <std::string> active_publishers;
       std::set <std::string> active_subscribers;
 
       XmlRpc::XmlRpcValue args, result, payload;
       args[0] = ros::this_node::getName();
-      if (!ros::master::execute("getSystemState", args, result, payload, true)) {
+      bool got_system_state;
+      {
+        ros1_bridge::DiscoveryCallTimer call_timer("ros1_get_system_state");
+        got_system_state = ros::master::execute("getSystemState", args, result, payload, true);
+      }
+      if (!got_system_state) {
         RCUTILS_LOG_ERROR("failed to get system state from ROS 1 master\n");
         return;
       }
@@ -640,6 +839,10 @@ int main(int argc, char *argv[]) {
         for (int j = 0; j < payload[2].size(); ++j) {
           if (payload[2][j][0].getType() == XmlRpc::XmlRpcValue::TypeString) {
             std::string name = payload[2][j][0];
+            // the services of this bridge are never bridged
+            if (ros1_bridge::is_bridge_service(name)) {
+              continue;
+            }
             if (already_ignored_ros1_services.count(name) == 0) {
               if (check_inregex_list(whitelist_map[srv_rgxp_list_param], name, valid_ros1_services)) {
                 get_ros1_service_info(name, active_ros1_services);
@@ -655,13 +858,17 @@ int main(int argc, char *argv[]) {
         }
       }
       {
-        std::lock_guard <std::mutex> lock(g_bridge_mutex);
+        ros1_bridge::InstrumentedLockGuard lock(g_bridge_mutex, "ros1_poll_services");
         ros1_services = active_ros1_services;
       }
 
       // get message types for all topics
       ros::master::V_TopicInfo topics;
-      bool success = ros::master::getTopics(topics);
+      bool success;
+      {
+        ros1_bridge::DiscoveryCallTimer call_timer("ros1_get_topics");
+        success = ros::master::getTopics(topics);
+      }
       if (!success) {
         RCUTILS_LOG_ERROR("failed to poll ROS 1 master\n");
         return;
@@ -705,10 +912,12 @@ int main(int argc, char *argv[]) {
       }
 
       {
-        std::lock_guard <std::mutex> lock(g_bridge_mutex);
+        ros1_bridge::InstrumentedLockGuard lock(g_bridge_mutex, "ros1_poll_topics");
         ros1_publishers = current_ros1_publishers;
         ros1_subscribers = current_ros1_subscribers;
       }
+      ROS1_BRIDGE_TRACEPOINT_DISCOVERY_END(
+              "ros1", current_ros1_publishers.size() + current_ros1_subscribers.size());
 
       update_bridge(
               ros1_node, ros2_node,
@@ -717,7 +926,9 @@ int main(int argc, char *argv[]) {
               ros1_services, ros2_services,
               bridges_1to2, bridges_2to1,
               service_bridges_1_to_2, service_bridges_2_to_1,
-              bridge_all_1to2_topics, bridge_all_2to1_topics);
+              bridge_all_1to2_topics, bridge_all_2to1_topics,
+              sharding);
+      ros1_bridge::add_discovery_cycle("ros1", std::chrono::steady_clock::now() - discovery_start);
   };
 
   auto ros1_poll_timer = ros1_node.createTimer(ros::Duration(1.0), ros1_poll);
@@ -741,9 +952,41 @@ int main(int argc, char *argv[]) {
           &bridge_all_1to2_topics, &bridge_all_2to1_topics,
           &already_ignored_topics, &already_ignored_services,
           &topic_rgxp_list_param, &srv_rgxp_list_param,
-          &whitelist_map, &valid_ros2_topics, &valid_ros2_services
+          &whitelist_map, &valid_ros2_topics, &valid_ros2_services,
+          &sharding, &shard_name_prefix, &shard_timeout
   ]() -> void {
-      auto ros2_topics = ros2_node->get_topic_names_and_types();
+      ROS1_BRIDGE_TRACEPOINT_DISCOVERY_START("ros2");
+      auto discovery_start = std::chrono::steady_clock::now();
+
+      if (sharding.get_shard_count() > 1) {
+        // the shards are alive as long as their ROS 2 node is part of the graph
+        std::set <size_t> seen_shards;
+        for (const auto &name : ros2_node->get_node_names()) {
+          auto pos = name.rfind(shard_name_prefix);
+          if (pos == std::string::npos || pos + shard_name_prefix.size() >= name.size()) {
+            continue;
+          }
+          size_t index;
+          if (ros1_bridge::parse_number(name.substr(pos + shard_name_prefix.size()), index)) {
+            seen_shards.insert(index);
+          }
+        }
+        if (sharding.update_live_shards(
+                seen_shards, std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(shard_timeout)))) {
+          std::stringstream live;
+          for (auto shard : sharding.get_live_shards()) {
+            live << shard << " ";
+          }
+          RCUTILS_LOG_WARN("live shards changed, reassigning topics: [ %s]\n", live.str().c_str());
+        }
+      }
+
+      std::map <std::string, std::vector<std::string>> ros2_topics;
+      {
+        ros1_bridge::DiscoveryCallTimer call_timer("ros2_get_topic_names_and_types");
+        ros2_topics = ros2_node->get_topic_names_and_types();
+      }
 
       std::set <std::string> ignored_topics;
       ignored_topics.insert("parameter_events");
@@ -788,8 +1031,16 @@ int main(int argc, char *argv[]) {
           continue;
         }
 
-        auto publisher_count = ros2_node->count_publishers(topic_name);
-        auto subscriber_count = ros2_node->count_subscribers(topic_name);
+        size_t publisher_count;
+        {
+          ros1_bridge::DiscoveryCallTimer call_timer("ros2_count_publishers");
+          publisher_count = ros2_node->count_publishers(topic_name);
+        }
+        size_t subscriber_count;
+        {
+          ros1_bridge::DiscoveryCallTimer call_timer("ros2_count_subscribers");
+          subscriber_count = ros2_node->count_subscribers(topic_name);
+        }
 
         // ignore publishers from the bridge itself
         if (bridges_1to2.find(topic_name) != bridges_1to2.end()) {
@@ -818,12 +1069,21 @@ int main(int argc, char *argv[]) {
         }
       }
 
-      auto ros2_services_and_types = ros2_node->get_service_names_and_types();
+      std::map <std::string, std::vector<std::string>> ros2_services_and_types;
+      {
+        ros1_bridge::DiscoveryCallTimer call_timer("ros2_get_service_names_and_types");
+        ros2_services_and_types = ros2_node->get_service_names_and_types();
+      }
       std::map <std::string, std::map<std::string, std::string>> active_ros2_services;
       for (const auto &service_and_types : ros2_services_and_types) {
         auto &service_name = service_and_types.first;
         auto &service_type = service_and_types.second[0];  // explicitly take the first
 
+        // the services of this bridge are never bridged
+        if (ros1_bridge::is_bridge_service(service_name)) {
+          continue;
+        }
+
         // explicitly avoid services with more than one type
         if (service_and_types.second.size() > 1) {
           if (already_ignored_services.count(service_name) == 0) {
@@ -868,7 +1128,7 @@ int main(int argc, char *argv[]) {
       }
 
       {
-        std::lock_guard <std::mutex> lock(g_bridge_mutex);
+        ros1_bridge::InstrumentedLockGuard lock(g_bridge_mutex, "ros2_poll_services");
         ros2_services = active_ros2_services;
       }
 
@@ -877,10 +1137,12 @@ int main(int argc, char *argv[]) {
       }
 
       {
-        std::lock_guard <std::mutex> lock(g_bridge_mutex);
+        ros1_bridge::InstrumentedLockGuard lock(g_bridge_mutex, "ros2_poll_topics");
         ros2_publishers = current_ros2_publishers;
         ros2_subscribers = current_ros2_subscribers;
       }
+      ROS1_BRIDGE_TRACEPOINT_DISCOVERY_END(
+              "ros2", current_ros2_publishers.size() + current_ros2_subscribers.size());
 
       update_bridge(
               ros1_node, ros2_node,
@@ -889,12 +1151,32 @@ int main(int argc, char *argv[]) {
               ros1_services, ros2_services,
               bridges_1to2, bridges_2to1,
               service_bridges_1_to_2, service_bridges_2_to_1,
-              bridge_all_1to2_topics, bridge_all_2to1_topics);
+              bridge_all_1to2_topics, bridge_all_2to1_topics,
+              sharding);
+      ros1_bridge::add_discovery_cycle("ros2", std::chrono::steady_clock::now() - discovery_start);
   };
 
   auto ros2_poll_timer = ros2_node->create_wall_timer(
           std::chrono::seconds(1), ros2_poll);
 
+  ros1_bridge::StatisticsPublisher statistics_publisher(ros1_node, ros2_node);
+  ros1_bridge::PhaseTimingService phase_timing_service(ros2_node);
+  ros1_bridge::FlightRecorderService flight_recorder_service(ros2_node);
+  ros1_bridge::install_flight_recorder_signal_handler(SIGUSR1);
+  std::unique_ptr <ros1_bridge::MetricsExporter> metrics_exporter;
+  try {
+    if (metrics_port > 0) {
+      metrics_exporter.reset(new ros1_bridge::MetricsExporter(metrics_port));
+    } else if (!metrics_socket.empty()) {
+      metrics_exporter.reset(new ros1_bridge::MetricsExporter(metrics_socket));
+    }
+    if (!traffic_trace.empty()) {
+      ros1_bridge::start_traffic_recording(traffic_trace, record_traffic_payloads);
+    }
+  } catch (std::runtime_error &e) {
+    RCUTILS_LOG_ERROR("%s\n", e.what());
+    return 1;
+  }
 
   // ROS 1 asynchronous spinner
   ros::AsyncSpinner async_spinner(1);
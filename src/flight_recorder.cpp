@@ -0,0 +1,261 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <signal.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ros1_bridge/flight_recorder.hpp"
+
+namespace ros1_bridge
+{
+
+namespace
+{
+
+constexpr size_t words_per_event = 4;
+
+// every slot is guarded by a sequence number which is odd while the slot is being written,
+// so a dump can skip slots which are overwritten concurrently
+struct Slot
+{
+  std::atomic<uint64_t> sequence;
+  std::array<std::atomic<uint64_t>, words_per_event> words;
+};
+
+std::array<Slot, flight_recorder_capacity> g_slots;
+std::atomic<uint64_t> g_next_event(0);
+
+std::atomic<int64_t> g_latency_threshold(0);
+std::atomic<bool> g_dump_requested(false);
+std::atomic<bool> g_latency_exceeded(false);
+
+// bridges are created rarely, so their names are kept in a plain map
+constexpr size_t max_names = 4096;
+std::mutex g_names_mutex;
+std::map<uint64_t, FlightRecordName> g_names;
+
+uint64_t
+get_steady_time()
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void
+handle_signal(int)
+{
+  request_flight_recorder_dump();
+}
+
+void
+write_string(FILE * file, const std::string & value)
+{
+  uint16_t length = static_cast<uint16_t>(value.size() < UINT16_MAX ? value.size() : UINT16_MAX);
+  fwrite(&length, sizeof(length), 1, file);
+  fwrite(value.data(), 1, length, file);
+}
+
+}  // namespace
+
+const char *
+get_flight_event_type_name(FlightEventType type)
+{
+  switch (type) {
+    case FlightEventType::MESSAGE:
+      return "message";
+    case FlightEventType::DROP:
+      return "drop";
+    case FlightEventType::LOOPBACK:
+      return "loopback";
+    case FlightEventType::BRIDGE_CREATED:
+      return "bridge_created";
+    case FlightEventType::BRIDGE_DESTROYED:
+      return "bridge_destroyed";
+    case FlightEventType::SERVICE_CALL:
+      return "service_call";
+    case FlightEventType::DISCOVERY:
+      return "discovery";
+    default:
+      return "unknown";
+  }
+}
+
+void
+record_flight_event(
+  FlightEventType type, const void * id, uint32_t value0, uint32_t value1, uint32_t value2)
+{
+  uint64_t index = g_next_event.fetch_add(1, std::memory_order_relaxed);
+  Slot & slot = g_slots[index % flight_recorder_capacity];
+  slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.words[0].store(get_steady_time(), std::memory_order_relaxed);
+  slot.words[1].store(reinterpret_cast<uintptr_t>(id), std::memory_order_relaxed);
+  slot.words[2].store(
+    static_cast<uint64_t>(value0) << 32 | value1, std::memory_order_relaxed);
+  slot.words[3].store(
+    static_cast<uint64_t>(value2) << 32 | static_cast<uint8_t>(type), std::memory_order_relaxed);
+  slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+  if (type == FlightEventType::MESSAGE) {
+    int64_t threshold = g_latency_threshold.load(std::memory_order_relaxed);
+    if (threshold > 0 && static_cast<int64_t>(value1) + value2 > threshold) {
+      g_latency_exceeded.store(true, std::memory_order_relaxed);
+    }
+  }
+}
+
+void
+record_flight_bridge_created(
+  const void * id, uint8_t kind, const std::string & direction, const std::string & name,
+  const std::string & type)
+{
+  record_flight_event(FlightEventType::BRIDGE_CREATED, id);
+  FlightRecordName record_name {reinterpret_cast<uintptr_t>(id), kind, direction, name, type};
+  std::lock_guard<std::mutex> lock(g_names_mutex);
+  if (g_names.size() >= max_names) {
+    // the oldest bridges have most likely left the ring buffer already
+    g_names.clear();
+  }
+  // the address of a destroyed bridge may be reused by a later one
+  g_names[record_name.id] = record_name;
+}
+
+std::vector<FlightEvent>
+get_flight_events()
+{
+  std::vector<FlightEvent> events;
+  uint64_t end = g_next_event.load(std::memory_order_acquire);
+  uint64_t begin = end > flight_recorder_capacity ? end - flight_recorder_capacity : 0;
+  events.reserve(end - begin);
+  for (uint64_t index = begin; index < end; ++index) {
+    const Slot & slot = g_slots[index % flight_recorder_capacity];
+    uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * index + 2) {
+      // still being written or already overwritten
+      continue;
+    }
+    std::array<uint64_t, words_per_event> words;
+    for (size_t i = 0; i < words_per_event; ++i) {
+      words[i] = slot.words[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+      continue;
+    }
+    FlightEvent event;
+    event.time = words[0];
+    event.id = words[1];
+    event.value0 = static_cast<uint32_t>(words[2] >> 32);
+    event.value1 = static_cast<uint32_t>(words[2]);
+    event.value2 = static_cast<uint32_t>(words[3] >> 32);
+    event.type = static_cast<FlightEventType>(words[3] & 0xff);
+    events.push_back(event);
+  }
+  return events;
+}
+
+void
+set_flight_recorder_latency_threshold(std::chrono::nanoseconds threshold)
+{
+  g_latency_threshold.store(threshold.count(), std::memory_order_relaxed);
+}
+
+void
+request_flight_recorder_dump()
+{
+  g_dump_requested.store(true, std::memory_order_relaxed);
+}
+
+bool
+take_flight_recorder_dump_request(bool & latency_exceeded)
+{
+  bool requested = g_dump_requested.exchange(false, std::memory_order_relaxed);
+  latency_exceeded = g_latency_exceeded.exchange(false, std::memory_order_relaxed);
+  return requested || latency_exceeded;
+}
+
+void
+write_flight_recorder_dump(const std::string & path)
+{
+  // take the events first, so the names of all bridges created until then are available
+  std::vector<FlightEvent> events = get_flight_events();
+  std::vector<FlightRecordName> names;
+  {
+    std::lock_guard<std::mutex> lock(g_names_mutex);
+    for (const auto & name : g_names) {
+      names.push_back(name.second);
+    }
+  }
+
+  FILE * file = fopen(path.c_str(), "wb");
+  if (!file) {
+    throw std::runtime_error("failed to open flight record '" + path + "'");
+  }
+  fwrite(flight_record_magic, 1, sizeof(flight_record_magic), file);
+  uint64_t steady_time = get_steady_time();
+  uint64_t system_time = static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count());
+  fwrite(&steady_time, sizeof(steady_time), 1, file);
+  fwrite(&system_time, sizeof(system_time), 1, file);
+
+  uint32_t name_count = static_cast<uint32_t>(names.size());
+  fwrite(&name_count, sizeof(name_count), 1, file);
+  for (const auto & name : names) {
+    fwrite(&name.id, sizeof(name.id), 1, file);
+    fwrite(&name.kind, sizeof(name.kind), 1, file);
+    write_string(file, name.direction);
+    write_string(file, name.name);
+    write_string(file, name.type);
+  }
+
+  uint32_t event_count = static_cast<uint32_t>(events.size());
+  fwrite(&event_count, sizeof(event_count), 1, file);
+  for (const auto & event : events) {
+    uint64_t words[words_per_event] = {
+      event.time,
+      event.id,
+      static_cast<uint64_t>(event.value0) << 32 | event.value1,
+      static_cast<uint64_t>(event.value2) << 32 | static_cast<uint8_t>(event.type)
+    };
+    fwrite(words, sizeof(words), 1, file);
+  }
+
+  bool failed = ferror(file) != 0;
+  if (fclose(file) != 0 || failed) {
+    throw std::runtime_error("failed to write flight record '" + path + "'");
+  }
+}
+
+void
+install_flight_recorder_signal_handler(int signal_number)
+{
+  struct sigaction action;
+  action.sa_handler = &handle_signal;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  sigaction(signal_number, &action, nullptr);
+}
+
+}  // namespace ros1_bridge
@@ -0,0 +1,115 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <unistd.h>
+
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "ros1_bridge/bridge_services.hpp"
+#include "ros1_bridge/flight_recorder.hpp"
+#include "ros1_bridge/flight_recorder_service.hpp"
+
+namespace ros1_bridge
+{
+
+FlightRecorderService::FlightRecorderService(rclcpp::Node::SharedPtr ros2_node)
+: node_name_(ros2_node->get_name()),
+  logger_(ros2_node->get_logger()),
+  dump_count_(0),
+  stopping_(false)
+{
+  double latency_threshold_ms;
+  ros2_node->get_parameter_or<std::string>("flight_recorder_directory", directory_, "/tmp");
+  ros2_node->get_parameter_or<double>(
+    "flight_recorder_latency_threshold_ms", latency_threshold_ms, 0.0);
+  set_flight_recorder_latency_threshold(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double, std::milli>(latency_threshold_ms)));
+
+  service_ = ros2_node->create_service<diagnostic_msgs::srv::SelfTest>(
+    node_name_ + "/" + flight_recorder_service_name,
+    std::bind(
+      &FlightRecorderService::handle_request, this, std::placeholders::_1,
+      std::placeholders::_2));
+  register_bridge_service(service_->get_service_name());
+
+  // the requests of the signal handler and the message callbacks are only flags,
+  // so the file is written by this thread
+  thread_ = std::thread(
+    [this]() -> void
+    {
+      auto last_automatic_dump = std::chrono::steady_clock::time_point();
+      while (!stopping_) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        bool latency_exceeded;
+        if (!take_flight_recorder_dump_request(latency_exceeded)) {
+          continue;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (!latency_exceeded) {
+          dump("requested");
+        } else if (now - last_automatic_dump > std::chrono::seconds(10)) {
+          last_automatic_dump = now;
+          dump("latency threshold exceeded");
+        }
+      }
+    });
+}
+
+FlightRecorderService::~FlightRecorderService()
+{
+  unregister_bridge_service(service_->get_service_name());
+  stopping_ = true;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void
+FlightRecorderService::handle_request(
+  const std::shared_ptr<diagnostic_msgs::srv::SelfTest::Request>,
+  std::shared_ptr<diagnostic_msgs::srv::SelfTest::Response> response)
+{
+  response->id = dump("service call");
+  response->passed = !response->id.empty();
+}
+
+std::string
+FlightRecorderService::dump(const char * reason)
+{
+  std::time_t now = std::time(nullptr);
+  std::tm local_time;
+  localtime_r(&now, &local_time);
+  char timestamp[32];
+  std::strftime(timestamp, sizeof(timestamp), "%Y%m%d-%H%M%S", &local_time);
+
+  std::lock_guard<std::mutex> lock(dump_mutex_);
+  // the pid keeps the files of several bridges with the same name apart
+  std::string path = directory_ + "/" + node_name_ + "_" + timestamp + "_" +
+    std::to_string(getpid()) + "_" + std::to_string(dump_count_++) + ".frec";
+  try {
+    write_flight_recorder_dump(path);
+  } catch (std::runtime_error & e) {
+    RCLCPP_ERROR(logger_, "Failed to dump the flight recorder (%s): %s", reason, e.what());
+    return "";
+  }
+  RCLCPP_INFO(logger_, "Dumped the flight recorder (%s) to '%s'", reason, path.c_str());
+  return path;
+}
+
+}  // namespace ros1_bridge
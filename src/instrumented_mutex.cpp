@@ -0,0 +1,133 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ros1_bridge/instrumented_mutex.hpp"
+
+namespace ros1_bridge
+{
+
+namespace
+{
+
+// function local, so mutexes defined at namespace scope can register themselves
+std::mutex &
+get_registry_mutex()
+{
+  static std::mutex registry_mutex;
+  return registry_mutex;
+}
+
+std::list<const InstrumentedMutex *> &
+get_registry()
+{
+  static std::list<const InstrumentedMutex *> registry;
+  return registry;
+}
+
+}  // namespace
+
+InstrumentedMutex::InstrumentedMutex(const std::string & name)
+: name_(name),
+  holder_site_(nullptr)
+{
+  std::lock_guard<std::mutex> lock(get_registry_mutex());
+  get_registry().push_back(this);
+}
+
+InstrumentedMutex::~InstrumentedMutex()
+{
+  std::lock_guard<std::mutex> lock(get_registry_mutex());
+  get_registry().remove(this);
+}
+
+void
+InstrumentedMutex::lock(const char * site)
+{
+  auto start = std::chrono::steady_clock::now();
+  bool contended = !mutex_.try_lock();
+  if (contended) {
+    mutex_.lock();
+  }
+  holder_start_ = std::chrono::steady_clock::now();
+
+  auto it = sites_.find(site);
+  if (it == sites_.end()) {
+    std::lock_guard<std::mutex> lock(sites_mutex_);
+    it = sites_.emplace(site, std::unique_ptr<Site>(new Site())).first;
+  }
+  holder_site_ = it->second.get();
+  holder_site_->acquisitions.fetch_add(1, std::memory_order_relaxed);
+  if (contended) {
+    holder_site_->contentions.fetch_add(1, std::memory_order_relaxed);
+  }
+  holder_site_->wait_time.add(holder_start_ - start);
+}
+
+void
+InstrumentedMutex::lock()
+{
+  lock("unknown");
+}
+
+void
+InstrumentedMutex::unlock()
+{
+  holder_site_->hold_time.add(std::chrono::steady_clock::now() - holder_start_);
+  mutex_.unlock();
+}
+
+const std::string &
+InstrumentedMutex::get_name() const
+{
+  return name_;
+}
+
+std::vector<LockStatistics>
+InstrumentedMutex::get_statistics() const
+{
+  std::vector<LockStatistics> all_statistics;
+  std::lock_guard<std::mutex> lock(sites_mutex_);
+  for (const auto & site : sites_) {
+    LockStatistics statistics;
+    statistics.lock = name_;
+    statistics.site = site.first;
+    statistics.acquisitions = site.second->acquisitions.load(std::memory_order_relaxed);
+    statistics.contentions = site.second->contentions.load(std::memory_order_relaxed);
+    statistics.wait_time = site.second->wait_time.get_buckets();
+    statistics.wait_time_sum = site.second->wait_time.get_sum();
+    statistics.hold_time = site.second->hold_time.get_buckets();
+    statistics.hold_time_sum = site.second->hold_time.get_sum();
+    all_statistics.push_back(statistics);
+  }
+  return all_statistics;
+}
+
+std::vector<LockStatistics>
+get_all_lock_statistics()
+{
+  std::vector<LockStatistics> all_statistics;
+  std::lock_guard<std::mutex> lock(get_registry_mutex());
+  for (const auto mutex : get_registry()) {
+    auto statistics = mutex->get_statistics();
+    all_statistics.insert(all_statistics.end(), statistics.begin(), statistics.end());
+  }
+  return all_statistics;
+}
+
+}  // namespace ros1_bridge
@@ -0,0 +1,97 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "ros1_bridge/loopback_filter.hpp"
+
+namespace ros1_bridge
+{
+
+namespace
+{
+
+// the released messages are forgotten at least after this many messages
+constexpr size_t min_compact_size = 64;
+
+std::atomic<bool> g_filters_enabled(false);
+std::mutex g_filters_mutex;
+std::map<std::string, std::weak_ptr<Ros1LoopbackFilter>> g_filters;
+
+}  // namespace
+
+void
+Ros1LoopbackFilter::add_published(const boost::shared_ptr<void const> & ros1_msg)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (published_.size() >= compact_size_) {
+    for (auto it = published_.begin(); it != published_.end(); ) {
+      if (it->second.expired()) {
+        it = published_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    // messages still held e.g. by a latched publisher or a slow subscriber stay, so the map
+    // is only compacted again when it has doubled
+    compact_size_ = std::max(min_compact_size, 2 * published_.size());
+  }
+  published_[ros1_msg.get()] = ros1_msg;
+}
+
+bool
+Ros1LoopbackFilter::is_published(const boost::shared_ptr<void const> & ros1_msg)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = published_.find(ros1_msg.get());
+  // the message isn't forgotten yet since the bridges of other nodelets may receive it as well
+  return it != published_.end() &&
+         !it->second.owner_before(ros1_msg) && !ros1_msg.owner_before(it->second);
+}
+
+void
+enable_ros1_loopback_filters()
+{
+  g_filters_enabled = true;
+}
+
+std::shared_ptr<Ros1LoopbackFilter>
+get_ros1_loopback_filter(const std::string & ros1_topic_name)
+{
+  if (!g_filters_enabled) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(g_filters_mutex);
+  auto filter = g_filters[ros1_topic_name].lock();
+  if (!filter) {
+    filter = std::make_shared<Ros1LoopbackFilter>();
+    g_filters[ros1_topic_name] = filter;
+  }
+  // forget the topics which aren't bridged anymore
+  for (auto it = g_filters.begin(); it != g_filters.end(); ) {
+    if (it->second.expired()) {
+      it = g_filters.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return filter;
+}
+
+}  // namespace ros1_bridge
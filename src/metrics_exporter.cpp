@@ -0,0 +1,531 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ros1_bridge/allocation_accounting.hpp"
+#include "ros1_bridge/discovery_statistics.hpp"
+#include "ros1_bridge/instrumented_mutex.hpp"
+#include "ros1_bridge/metrics_exporter.hpp"
+#include "ros1_bridge/service_statistics.hpp"
+#include "ros1_bridge/topic_statistics.hpp"
+
+namespace ros1_bridge
+{
+
+namespace
+{
+
+std::string
+escape_label_value(const std::string & value)
+{
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (char c : value) {
+    if (c == '\\') {
+      escaped += "\\\\";
+    } else if (c == '"') {
+      escaped += "\\\"";
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+std::string
+format_seconds(std::chrono::nanoseconds duration)
+{
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.9g", std::chrono::duration<double>(duration).count());
+  return buffer;
+}
+
+void
+add_family(
+  std::ostream & out, const std::string & name, const char * type, const char * help,
+  const char * unit = nullptr)
+{
+  out << "# TYPE " << name << " " << type << "\n";
+  if (unit) {
+    out << "# UNIT " << name << " " << unit << "\n";
+  }
+  out << "# HELP " << name << " " << help << "\n";
+}
+
+void
+add_histogram(
+  std::ostream & out, const std::string & name, const std::string & labels,
+  const DurationHistogram::Buckets & buckets, std::chrono::nanoseconds sum)
+{
+  // bucket i counts durations below 2^(i+1) ns, the last one is unbounded
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i + 1 < DurationHistogram::bucket_count; ++i) {
+    cumulative += buckets[i];
+    out << name << "_bucket{" << labels << ",le=\"" <<
+      format_seconds(std::chrono::nanoseconds(static_cast<int64_t>(1) << (i + 1))) << "\"} " <<
+      cumulative << "\n";
+  }
+  cumulative += buckets[DurationHistogram::bucket_count - 1];
+  out << name << "_bucket{" << labels << ",le=\"+Inf\"} " << cumulative << "\n";
+  out << name << "_count{" << labels << "} " << cumulative << "\n";
+  out << name << "_sum{" << labels << "} " << format_seconds(sum) << "\n";
+}
+
+void
+send_all(int fd, const std::string & data)
+{
+#ifdef MSG_NOSIGNAL
+  const int flags = MSG_NOSIGNAL;
+#else
+  const int flags = 0;
+#endif
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, flags);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return;
+    }
+    sent += static_cast<size_t>(n);
+  }
+}
+
+}  // namespace
+
+MetricsExporter::MetricsExporter(uint16_t port)
+: listen_fd_(-1),
+  stopping_(false),
+  snapshot_requested_(false),
+  snapshot_ready_(false)
+{
+  listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) {
+    throw std::runtime_error(std::string("failed to create metrics socket: ") + strerror(errno));
+  }
+  int reuse = 1;
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  // the statistics are only exposed locally, a scraper on another host needs a proxy
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+    std::string error = strerror(errno);
+    close(listen_fd_);
+    throw std::runtime_error(
+      "failed to bind metrics port " + std::to_string(port) + ": " + error);
+  }
+  start();
+}
+
+MetricsExporter::MetricsExporter(const std::string & socket_path)
+: listen_fd_(-1),
+  socket_path_(socket_path),
+  stopping_(false),
+  snapshot_requested_(false),
+  snapshot_ready_(false)
+{
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    throw std::runtime_error("metrics socket path too long: " + socket_path);
+  }
+  strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) {
+    throw std::runtime_error(std::string("failed to create metrics socket: ") + strerror(errno));
+  }
+  // remove a stale socket of a previous run
+  unlink(socket_path.c_str());
+  if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+    std::string error = strerror(errno);
+    close(listen_fd_);
+    throw std::runtime_error("failed to bind metrics socket " + socket_path + ": " + error);
+  }
+  start();
+}
+
+MetricsExporter::~MetricsExporter()
+{
+  {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    stopping_ = true;
+  }
+  snapshot_condition_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (snapshot_thread_.joinable()) {
+    snapshot_thread_.join();
+  }
+  close(listen_fd_);
+  if (!socket_path_.empty()) {
+    unlink(socket_path_.c_str());
+  }
+}
+
+void
+MetricsExporter::start()
+{
+  if (listen(listen_fd_, 4) < 0) {
+    std::string error = strerror(errno);
+    close(listen_fd_);
+    throw std::runtime_error("failed to listen on metrics socket: " + error);
+  }
+  snapshot_thread_ = std::thread([this]() -> void {collect();});
+  thread_ = std::thread([this]() -> void {serve();});
+}
+
+void
+MetricsExporter::serve()
+{
+#ifdef SCHED_IDLE
+  // scraping must never delay the bridge, the thread only runs when a core is idle
+  // and doesn't take any mutex of the bridge, see collect()
+  sched_param param;
+  param.sched_priority = 0;
+  pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+
+  pollfd listen_poll;
+  listen_poll.fd = listen_fd_;
+  listen_poll.events = POLLIN;
+  while (!stopping_) {
+    // wake up regularly to notice the destruction
+    int ready = poll(&listen_poll, 1, 100);
+    if (ready <= 0 || !(listen_poll.revents & POLLIN)) {
+      continue;
+    }
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) {
+      continue;
+    }
+    handle_connection(fd);
+    close(fd);
+  }
+}
+
+void
+MetricsExporter::collect()
+{
+  // keeps the priority of the bridge, so it never holds the mutexes of the registries
+  // while being starved by busy cores
+  std::unique_lock<std::mutex> lock(snapshot_mutex_);
+  while (true) {
+    snapshot_condition_.wait(lock, [this]() {return snapshot_requested_ || stopping_;});
+    if (stopping_) {
+      return;
+    }
+    snapshot_requested_ = false;
+    lock.unlock();
+    MetricsSnapshot snapshot = take_snapshot();
+    lock.lock();
+    snapshot_ = std::move(snapshot);
+    snapshot_ready_ = true;
+    snapshot_condition_.notify_all();
+  }
+}
+
+MetricsSnapshot
+MetricsExporter::request_snapshot()
+{
+  std::unique_lock<std::mutex> lock(snapshot_mutex_);
+  snapshot_ready_ = false;
+  snapshot_requested_ = true;
+  snapshot_condition_.notify_all();
+  snapshot_condition_.wait(lock, [this]() {return snapshot_ready_ || stopping_;});
+  snapshot_ready_ = false;
+  return std::move(snapshot_);
+}
+
+void
+MetricsExporter::handle_connection(int fd)
+{
+  // read the request head, the request itself doesn't matter beside its method
+  std::string request;
+  char buffer[1024];
+  pollfd connection_poll;
+  connection_poll.fd = fd;
+  connection_poll.events = POLLIN;
+  while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+    if (poll(&connection_poll, 1, 1000) <= 0) {
+      return;
+    }
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) {
+      return;
+    }
+    request.append(buffer, static_cast<size_t>(n));
+  }
+
+  if (request.compare(0, 4, "GET ") != 0) {
+    send_all(
+      fd, "HTTP/1.0 405 Method Not Allowed\r\nAllow: GET\r\nContent-Length: 0\r\n"
+      "Connection: close\r\n\r\n");
+    return;
+  }
+
+  std::string body = render_metrics(request_snapshot());
+  std::stringstream response;
+  response << "HTTP/1.0 200 OK\r\n";
+  response << "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n";
+  response << "Content-Length: " << body.size() << "\r\n";
+  response << "Connection: close\r\n\r\n";
+  response << body;
+  send_all(fd, response.str());
+}
+
+MetricsSnapshot
+MetricsExporter::take_snapshot()
+{
+  MetricsSnapshot snapshot;
+  snapshot.topics = get_all_topic_statistics();
+  snapshot.services = get_all_service_statistics();
+  snapshot.discovery = get_discovery_statistics();
+  snapshot.discovery_calls = get_discovery_call_statistics();
+  snapshot.lifecycles = get_bridge_lifecycle_statistics();
+  snapshot.locks = get_all_lock_statistics();
+  if (allocation_accounting_enabled) {
+    snapshot.memory_usage = get_memory_usage();
+  }
+  return snapshot;
+}
+
+std::string
+MetricsExporter::render_metrics()
+{
+  return render_metrics(take_snapshot());
+}
+
+std::string
+MetricsExporter::render_metrics(const MetricsSnapshot & snapshot)
+{
+  const auto & topics = snapshot.topics;
+  const auto & services = snapshot.services;
+  const auto & discovery = snapshot.discovery;
+  const auto & discovery_calls = snapshot.discovery_calls;
+  const auto & lifecycles = snapshot.lifecycles;
+  const auto & locks = snapshot.locks;
+
+  std::vector<std::string> topic_labels;
+  for (const auto & topic : topics) {
+    topic_labels.push_back(
+      "direction=\"" + escape_label_value(topic.direction) +
+      "\",topic=\"" + escape_label_value(topic.topic_name) +
+      "\",type=\"" + escape_label_value(topic.type_name) +
+      "\",domain=\"" + escape_label_value(topic.domain) + "\"");
+  }
+
+  std::stringstream out;
+  add_family(out, "ros1_bridge_messages", "counter", "Messages passed to the other side.");
+  for (size_t i = 0; i < topics.size(); ++i) {
+    out << "ros1_bridge_messages_total{" << topic_labels[i] << "} " << topics[i].messages << "\n";
+  }
+  add_family(
+    out, "ros1_bridge_bytes", "counter", "ROS 1 serialized size of the passed messages.",
+    "bytes");
+  for (size_t i = 0; i < topics.size(); ++i) {
+    out << "ros1_bridge_bytes_total{" << topic_labels[i] << "} " << topics[i].bytes << "\n";
+  }
+  add_family(out, "ros1_bridge_drops", "counter", "Messages which couldn't be passed on.");
+  for (size_t i = 0; i < topics.size(); ++i) {
+    out << "ros1_bridge_drops_total{" << topic_labels[i] << "} " << topics[i].drops << "\n";
+  }
+  add_family(
+    out, "ros1_bridge_loopbacks", "counter", "Messages published by the bridge itself.");
+  for (size_t i = 0; i < topics.size(); ++i) {
+    out << "ros1_bridge_loopbacks_total{" << topic_labels[i] << "} " <<
+      topics[i].loopbacks << "\n";
+  }
+  if (allocation_accounting_enabled) {
+    add_family(
+      out, "ros1_bridge_allocations", "counter",
+      "Heap allocations made while passing the messages.");
+    for (size_t i = 0; i < topics.size(); ++i) {
+      out << "ros1_bridge_allocations_total{" << topic_labels[i] << "} " <<
+        topics[i].allocations << "\n";
+    }
+    add_family(
+      out, "ros1_bridge_allocated_bytes", "counter",
+      "Heap memory allocated while passing the messages.", "bytes");
+    for (size_t i = 0; i < topics.size(); ++i) {
+      out << "ros1_bridge_allocated_bytes_total{" << topic_labels[i] << "} " <<
+        topics[i].allocated_bytes << "\n";
+    }
+    add_family(
+      out, "ros1_bridge_held_bytes", "gauge",
+      "Heap memory held by the allocations attributed to the bridges of a topic.", "bytes");
+    for (const auto & usage : snapshot.memory_usage) {
+      out << "ros1_bridge_held_bytes{direction=\"" << escape_label_value(usage.direction) <<
+        "\",topic=\"" << escape_label_value(usage.topic_name) << "\"} " <<
+        usage.held_bytes << "\n";
+    }
+  }
+  add_family(
+    out, "ros1_bridge_conversion_seconds", "histogram", "Time to convert a message.", "seconds");
+  for (size_t i = 0; i < topics.size(); ++i) {
+    add_histogram(
+      out, "ros1_bridge_conversion_seconds", topic_labels[i],
+      topics[i].conversion_time, topics[i].conversion_time_sum);
+  }
+  add_family(
+    out, "ros1_bridge_publish_seconds", "histogram", "Time to publish a converted message.",
+    "seconds");
+  for (size_t i = 0; i < topics.size(); ++i) {
+    add_histogram(
+      out, "ros1_bridge_publish_seconds", topic_labels[i],
+      topics[i].publish_time, topics[i].publish_time_sum);
+  }
+  add_family(
+    out, "ros1_bridge_scheduling_delay_seconds", "histogram",
+    "Time from the arrival of a message until its callback started.", "seconds");
+  for (size_t i = 0; i < topics.size(); ++i) {
+    add_histogram(
+      out, "ros1_bridge_scheduling_delay_seconds", topic_labels[i],
+      topics[i].scheduling_delay, topics[i].scheduling_delay_sum);
+  }
+
+  std::vector<std::string> service_labels;
+  for (const auto & service : services) {
+    service_labels.push_back(
+      "direction=\"" + escape_label_value(service.direction) +
+      "\",service=\"" + escape_label_value(service.service_name) +
+      "\",type=\"" + escape_label_value(service.type_name) + "\"");
+  }
+  add_family(out, "ros1_bridge_service_calls", "counter", "Service calls forwarded.");
+  for (size_t i = 0; i < services.size(); ++i) {
+    out << "ros1_bridge_service_calls_total{" << service_labels[i] << "} " <<
+      services[i].calls << "\n";
+  }
+  add_family(
+    out, "ros1_bridge_service_failures", "counter", "Forwarded service calls which failed.");
+  for (size_t i = 0; i < services.size(); ++i) {
+    out << "ros1_bridge_service_failures_total{" << service_labels[i] << "} " <<
+      services[i].failures << "\n";
+  }
+  add_family(
+    out, "ros1_bridge_service_call_seconds", "histogram",
+    "Time until the response of a forwarded service call was available.", "seconds");
+  for (size_t i = 0; i < services.size(); ++i) {
+    add_histogram(
+      out, "ros1_bridge_service_call_seconds", service_labels[i],
+      services[i].call_time, services[i].call_time_sum);
+  }
+
+  add_family(
+    out, "ros1_bridge_discovery_cycle_seconds", "histogram",
+    "Time to poll the ROS 1 master or the ROS 2 graph and update the bridges.", "seconds");
+  for (const auto & statistics : discovery) {
+    add_histogram(
+      out, "ros1_bridge_discovery_cycle_seconds",
+      "side=\"" + escape_label_value(statistics.side) + "\"",
+      statistics.cycle_time, statistics.cycle_time_sum);
+  }
+  add_family(
+    out, "ros1_bridge_discovery_call_seconds", "histogram",
+    "Time of a single call to the ROS 1 master or the ROS 2 graph.", "seconds");
+  for (const auto & statistics : discovery_calls) {
+    add_histogram(
+      out, "ros1_bridge_discovery_call_seconds",
+      "call=\"" + escape_label_value(statistics.call) + "\"",
+      statistics.call_time, statistics.call_time_sum);
+  }
+
+  std::vector<std::string> lifecycle_labels;
+  for (const auto & statistics : lifecycles) {
+    lifecycle_labels.push_back(
+      "kind=\"" + escape_label_value(statistics.kind) +
+      "\",direction=\"" + escape_label_value(statistics.direction) + "\"");
+  }
+  add_family(
+    out, "ros1_bridge_bridge_events", "counter",
+    "Bridges created, replaced, failed to be created and removed by the dynamic bridges.");
+  for (size_t i = 0; i < lifecycles.size(); ++i) {
+    for (size_t event = 0; event < lifecycles[i].events.size(); ++event) {
+      out << "ros1_bridge_bridge_events_total{" << lifecycle_labels[i] << ",event=\"" <<
+        get_bridge_lifecycle_event_name(static_cast<BridgeLifecycleEvent>(event)) << "\"} " <<
+        lifecycles[i].events[event] << "\n";
+    }
+  }
+  add_family(
+    out, "ros1_bridge_bridge_creation_seconds", "histogram",
+    "Time to create a bridge including its ROS 1 and ROS 2 entities.", "seconds");
+  for (size_t i = 0; i < lifecycles.size(); ++i) {
+    add_histogram(
+      out, "ros1_bridge_bridge_creation_seconds", lifecycle_labels[i],
+      lifecycles[i].creation_time, lifecycles[i].creation_time_sum);
+  }
+
+  std::vector<std::string> lock_labels;
+  for (const auto & statistics : locks) {
+    lock_labels.push_back(
+      "lock=\"" + escape_label_value(statistics.lock) +
+      "\",site=\"" + escape_label_value(statistics.site) + "\"");
+  }
+  add_family(
+    out, "ros1_bridge_lock_contentions", "counter",
+    "Acquisitions of an instrumented mutex which had to wait for another holder.");
+  for (size_t i = 0; i < locks.size(); ++i) {
+    out << "ros1_bridge_lock_contentions_total{" << lock_labels[i] << "} " <<
+      locks[i].contentions << "\n";
+  }
+  add_family(
+    out, "ros1_bridge_lock_wait_seconds", "histogram",
+    "Time to acquire an instrumented mutex.", "seconds");
+  for (size_t i = 0; i < locks.size(); ++i) {
+    add_histogram(
+      out, "ros1_bridge_lock_wait_seconds", lock_labels[i],
+      locks[i].wait_time, locks[i].wait_time_sum);
+  }
+  add_family(
+    out, "ros1_bridge_lock_hold_seconds", "histogram",
+    "Time an instrumented mutex was held.", "seconds");
+  for (size_t i = 0; i < locks.size(); ++i) {
+    add_histogram(
+      out, "ros1_bridge_lock_hold_seconds", lock_labels[i],
+      locks[i].hold_time, locks[i].hold_time_sum);
+  }
+
+  out << "# EOF\n";
+  return out.str();
+}
+
+}  // namespace ros1_bridge
@@ -12,8 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <list>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 // include ROS 1
 #ifdef __clang__
@@ -29,63 +36,122 @@
 #include "rclcpp/rclcpp.hpp"
 
 #include "ros1_bridge/bridge.hpp"
+#include "ros1_bridge/command_options.hpp"
+#include "ros1_bridge/flight_recorder.hpp"
+#include "ros1_bridge/flight_recorder_service.hpp"
+#include "ros1_bridge/metrics_exporter.hpp"
+#include "ros1_bridge/phase_timing_service.hpp"
+#include "ros1_bridge/statistics_publisher.hpp"
+#include "ros1_bridge/traffic_recorder.hpp"
 
 
+// the highest domain id for which the default RTPS port mapping yields valid ports
+const size_t max_domain_id = 232;
+
+bool parse_domains(const std::string & value, std::vector<size_t> & domains)
+{
+  std::stringstream ss(value);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    size_t domain = 0;
+    if (!ros1_bridge::parse_number(item, domain) || domain > max_domain_id) {
+      return false;
+    }
+    domains.push_back(domain);
+  }
+  return !domains.empty();
+}
+
 int main(int argc, char * argv[])
 {
   // ROS 1 node
   ros::init(argc, argv, "ros_bridge");
   ros::NodeHandle ros1_node;
 
-  // ROS 2 node
-  rclcpp::init(argc, argv);
-  auto ros2_node = rclcpp::Node::make_shared("ros_bridge");
-
-  std::list<ros1_bridge::BridgeHandles> all_handles;
-
+  std::vector<std::string> args(argv, argv + argc);
   // bridge all topics listed in a ROS 1 parameter
   // the parameter needs to be an array
   // and each item needs to be a dictionary with the following keys;
   // topic: the name of the topic to bridge
   // type: the type of the topic to bridge
   // queue_size: the queue size to use (default: 100)
-  const char * parameter_name = "topics";
-  if (argc > 1) {
-    parameter_name = argv[1];
+  // ros2_topics: the names of the ROS 2 topics to bridge to (default: topic)
+  std::string parameter_name = "topics";
+  if (argc > 1 && args[1].compare(0, 2, "--") != 0) {
+    parameter_name = args[1];
+  }
+  // --ros2-domains: comma separated list of ROS 2 domain ids to bridge to
+  std::vector<size_t> domains;
+  std::string domain_list = ros1_bridge::get_command_option_value(args, "--ros2-domains", "");
+  if (!domain_list.empty() && !parse_domains(domain_list, domains)) {
+    fprintf(stderr, "Invalid list of ROS 2 domain ids: %s\n", domain_list.c_str());
+    return 1;
   }
+  // --metrics-port / --metrics-socket: serve OpenMetrics on a local port or Unix domain socket
+  uint16_t metrics_port = 0;
+  if (!ros1_bridge::get_command_option_number(args, "--metrics-port", uint16_t{0}, metrics_port)) {
+    return 1;
+  }
+  std::string metrics_socket =
+    ros1_bridge::get_command_option_value(args, "--metrics-socket", "");
+  // --record-traffic / --record-traffic-payloads: record the shape of the traffic to a trace file
+  std::string traffic_trace = ros1_bridge::get_command_option_value(args, "--record-traffic", "");
+  bool record_traffic_payloads =
+    ros1_bridge::find_command_option(args, "--record-traffic-payloads");
 
-  XmlRpc::XmlRpcValue topics;
-  if (
-    ros1_node.getParam(parameter_name, topics) &&
-    topics.getType() == XmlRpc::XmlRpcValue::TypeArray)
-  {
-    for (size_t i = 0; i < static_cast<size_t>(topics.size()); ++i) {
-      std::string topic_name = static_cast<std::string>(topics[i]["topic"]);
-      std::string type_name = static_cast<std::string>(topics[i]["type"]);
-      size_t queue_size = static_cast<int>(topics[i]["queue_size"]);
-      if (!queue_size) {
-        queue_size = 100;
+  // ROS 2 nodes, one per domain
+  rclcpp::init(argc, argv);
+  std::vector<rclcpp::Node::SharedPtr> ros2_nodes;
+  if (domains.empty()) {
+    ros2_nodes.push_back(rclcpp::Node::make_shared("ros_bridge"));
+  } else {
+    // the domain id of a node is read from the environment when the node is created
+    // the environment is global to the process, so this happens before any other thread
+    // of the bridge has been started and the original value is restored in any case
+    const char * original_domain_id = getenv("ROS_DOMAIN_ID");
+    bool has_original_value = original_domain_id != nullptr;
+    std::string original_value = has_original_value ? original_domain_id : "";
+    auto restore_domain_id = [has_original_value, &original_value]() -> void
+      {
+        if (has_original_value) {
+          setenv("ROS_DOMAIN_ID", original_value.c_str(), 1);
+        } else {
+          unsetenv("ROS_DOMAIN_ID");
+        }
+      };
+    try {
+      for (size_t domain : domains) {
+        setenv("ROS_DOMAIN_ID", std::to_string(domain).c_str(), 1);
+        ros2_nodes.push_back(rclcpp::Node::make_shared("ros_bridge"));
       }
-      printf(
-        "Trying to create bidirectional bridge for topic ''%s' "
-        "with ROS 1 type '%s' and ROS 2 type '%s'\n",
-        topic_name.c_str(), type_name.c_str(), type_name.c_str());
+    } catch (...) {
+      restore_domain_id();
+      throw;
+    }
+    restore_domain_id();
+  }
 
-      try {
-        ros1_bridge::BridgeHandles handles = ros1_bridge::create_bidirectional_bridge(
-          ros1_node, ros2_node, type_name, type_name, topic_name, queue_size);
-        all_handles.push_back(handles);
-      } catch (std::runtime_error & e) {
-        fprintf(
-          stderr,
-          "failed to create bidirectional bridge for topic '%s' "
-          "with ROS 1 type '%s' and ROS 2 type '%s': %s\n",
-          topic_name.c_str(), type_name.c_str(), type_name.c_str(), e.what());
-      }
+  // every ROS 1 message is converted only once for all domains and names
+  auto all_handles = ros1_bridge::create_fan_out_bridges_from_parameter(
+    ros1_node, ros2_nodes, parameter_name);
+
+  ros1_bridge::StatisticsPublisher statistics_publisher(ros1_node, ros2_nodes.front());
+  ros1_bridge::PhaseTimingService phase_timing_service(ros2_nodes.front());
+  ros1_bridge::FlightRecorderService flight_recorder_service(ros2_nodes.front());
+  ros1_bridge::install_flight_recorder_signal_handler(SIGUSR1);
+  std::unique_ptr<ros1_bridge::MetricsExporter> metrics_exporter;
+  try {
+    if (metrics_port > 0) {
+      metrics_exporter.reset(new ros1_bridge::MetricsExporter(metrics_port));
+    } else if (!metrics_socket.empty()) {
+      metrics_exporter.reset(new ros1_bridge::MetricsExporter(metrics_socket));
     }
-  } else {
-    fprintf(
-      stderr, "The parameter '%s' either doesn't exist or isn't an array\n", parameter_name);
+    if (!traffic_trace.empty()) {
+      ros1_bridge::start_traffic_recording(traffic_trace, record_traffic_payloads);
+    }
+  } catch (std::runtime_error & e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
   }
 
   // ROS 1 asynchronous spinner
@@ -94,8 +160,11 @@ int main(int argc, char * argv[])
 
   // ROS 2 spinning loop
   rclcpp::executors::SingleThreadedExecutor executor;
+  for (auto & ros2_node : ros2_nodes) {
+    executor.add_node(ros2_node);
+  }
   while (ros1_node.ok() && rclcpp::ok()) {
-    executor.spin_node_once(ros2_node, std::chrono::milliseconds(1000));
+    executor.spin_once(std::chrono::milliseconds(1000));
   }
 
   return 0;
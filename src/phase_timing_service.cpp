@@ -0,0 +1,145 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "ros1_bridge/bridge_services.hpp"
+#include "ros1_bridge/phase_timing_service.hpp"
+#include "ros1_bridge/topic_statistics.hpp"
+
+namespace ros1_bridge
+{
+
+namespace
+{
+
+void
+add_value(
+  diagnostic_msgs::msg::DiagnosticStatus & status, const std::string & key,
+  const std::string & value)
+{
+  diagnostic_msgs::msg::KeyValue key_value;
+  key_value.key = key;
+  key_value.value = value;
+  status.values.push_back(key_value);
+}
+
+std::string
+to_us(std::chrono::nanoseconds duration)
+{
+  return std::to_string(std::chrono::duration<double, std::micro>(duration).count());
+}
+
+}  // namespace
+
+PhaseTimingService::PhaseTimingService(rclcpp::Node::SharedPtr ros2_node)
+: stopping_(false)
+{
+  std::string bridge_name = ros2_node->get_name();
+  node_ = rclcpp::Node::make_shared(bridge_name + "_phase_timing", ros2_node->get_namespace());
+  service_ = node_->create_service<diagnostic_msgs::srv::SelfTest>(
+    bridge_name + "/" + phase_timing_service_name,
+    std::bind(
+      &PhaseTimingService::handle_request, this, std::placeholders::_1, std::placeholders::_2));
+  register_bridge_service(service_->get_service_name());
+  executor_.add_node(node_);
+  thread_ = std::thread([this]() -> void {executor_.spin();});
+}
+
+PhaseTimingService::~PhaseTimingService()
+{
+  unregister_bridge_service(service_->get_service_name());
+  stopping_ = true;
+  executor_.cancel();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void
+PhaseTimingService::handle_request(
+  const std::shared_ptr<diagnostic_msgs::srv::SelfTest::Request>,
+  std::shared_ptr<diagnostic_msgs::srv::SelfTest::Response> response)
+{
+  std::string topics_pattern;
+  double window;
+  node_->get_parameter_or<std::string>("topics", topics_pattern, ".*");
+  node_->get_parameter_or<double>("window", window, 5.0);
+  response->id = topics_pattern;
+
+  std::regex topics_regex;
+  try {
+    topics_regex = std::regex(topics_pattern);
+  } catch (std::regex_error & e) {
+    RCLCPP_ERROR(
+      node_->get_logger(), "Invalid regular expression for topics '%s': %s",
+      topics_pattern.c_str(), e.what());
+    response->passed = false;
+    return;
+  }
+
+  std::vector<std::shared_ptr<TopicStatistics>> selected;
+  for (auto & statistics : get_registered_topic_statistics()) {
+    if (std::regex_match(statistics->get_topic_name(), topics_regex)) {
+      selected.push_back(statistics);
+    }
+  }
+  RCLCPP_INFO(
+    node_->get_logger(), "Timing the phases of %zu bridges for %f seconds",
+    selected.size(), window);
+
+  for (auto & statistics : selected) {
+    statistics->set_phase_timing_enabled(true);
+  }
+  auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(window);
+  while (!stopping_ && rclcpp::ok() && std::chrono::steady_clock::now() < end) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  for (auto & statistics : selected) {
+    statistics->set_phase_timing_enabled(false);
+  }
+
+  for (auto & statistics : selected) {
+    diagnostic_msgs::msg::DiagnosticStatus status;
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+    status.name = "ros1_bridge: " + statistics->get_direction() + " " +
+      statistics->get_topic_name();
+    status.hardware_id = node_->get_name();
+    for (int i = 0; i < TopicStatistics::PHASE_COUNT; ++i) {
+      auto phase = static_cast<TopicStatistics::Phase>(i);
+      auto buckets = statistics->get_phase_buckets(phase);
+      uint64_t count = 0;
+      for (uint64_t bucket : buckets) {
+        count += bucket;
+      }
+      std::string prefix = TopicStatistics::get_phase_name(phase);
+      add_value(status, prefix + "_count", std::to_string(count));
+      if (!count) {
+        continue;
+      }
+      add_value(status, prefix + "_p50_us", to_us(DurationHistogram::get_quantile(buckets, 0.5)));
+      add_value(status, prefix + "_p90_us", to_us(DurationHistogram::get_quantile(buckets, 0.9)));
+      add_value(status, prefix + "_p99_us", to_us(DurationHistogram::get_quantile(buckets, 0.99)));
+      add_value(status, prefix + "_max_us", to_us(DurationHistogram::get_max(buckets)));
+    }
+    response->status.push_back(status);
+  }
+  response->passed = true;
+}
+
+}  // namespace ros1_bridge
@@ -0,0 +1,350 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "ros/ros.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+
+#include "ros1_bridge/bridge.hpp"
+#include "ros1_bridge/command_options.hpp"
+#include "ros1_bridge/traffic_recorder.hpp"
+
+// Publish the traffic of a trace recorded by a bridge (see ros1_bridge/traffic_recorder.hpp)
+// again with the same timing, e.g. to evaluate a local bridge with a production-like load.
+// The messages which passed a bridge from ROS 1 to ROS 2 are published in ROS 1 and the ones
+// which passed from ROS 2 to ROS 1 in ROS 2, so a bridge bridging all topics
+// (e.g. `dynamic_bridge --bridge-all-topics`) passes them the same way again.
+// Messages recorded without their payload are replayed with the first payload of their topic.
+// A serialized message can't be resized without knowing its type, so the replay warns about the
+// topics whose recorded sizes differ from their first payload and reports both byte volumes.
+
+namespace
+{
+
+struct TraceTopic
+{
+  std::string direction;
+  std::string topic_name;
+  std::string ros1_type_name;
+  std::string ros2_type_name;
+  std::vector<uint8_t> payload;
+  uint64_t messages = 0;
+  uint64_t bytes = 0;
+  // messages recorded without a payload and with another size than the first payload
+  uint64_t resized_messages = 0;
+  uint64_t first_time = 0;
+  uint64_t last_time = 0;
+};
+
+struct TraceMessage
+{
+  uint32_t id;
+  uint64_t time;
+  uint32_t size;
+  std::vector<uint8_t> payload;
+};
+
+struct Trace
+{
+  uint64_t start_system_time;
+  bool payloads;
+  std::map<uint32_t, TraceTopic> topics;
+  std::vector<TraceMessage> messages;
+};
+
+template<typename T>
+bool read_value(std::ifstream & in, T & value)
+{
+  return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+bool read_string(std::ifstream & in, std::string & value)
+{
+  uint16_t length;
+  if (!read_value(in, length)) {
+    return false;
+  }
+  value.resize(length);
+  return length == 0 || static_cast<bool>(in.read(&value[0], length));
+}
+
+bool read_payload(std::ifstream & in, std::vector<uint8_t> & payload)
+{
+  uint32_t length;
+  if (!read_value(in, length)) {
+    return false;
+  }
+  payload.resize(length);
+  return length == 0 || static_cast<bool>(in.read(reinterpret_cast<char *>(&payload[0]), length));
+}
+
+/// Read a trace, a trace which was cut off (e.g. when the bridge was killed) is read until the
+/// last complete record.
+/**
+ * \throws std::runtime_error if the file isn't a trace
+ */
+Trace
+read_trace(const std::string & path)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("failed to open '" + path + "'");
+  }
+  char magic[sizeof(ros1_bridge::traffic_trace_magic)];
+  Trace trace;
+  uint8_t payloads;
+  if (
+    !in.read(magic, sizeof(magic)) ||
+    memcmp(magic, ros1_bridge::traffic_trace_magic, sizeof(magic)) != 0 ||
+    !read_value(in, trace.start_system_time) || !read_value(in, payloads))
+  {
+    throw std::runtime_error("'" + path + "' isn't a traffic trace of the bridge");
+  }
+  trace.payloads = payloads != 0;
+
+  uint8_t kind;
+  while (read_value(in, kind)) {
+    uint32_t id;
+    if (!read_value(in, id)) {
+      break;
+    }
+    if (kind == static_cast<uint8_t>(ros1_bridge::TrafficRecordKind::TOPIC)) {
+      TraceTopic topic;
+      if (
+        !read_string(in, topic.direction) || !read_string(in, topic.topic_name) ||
+        !read_string(in, topic.ros1_type_name) || !read_string(in, topic.ros2_type_name) ||
+        !read_payload(in, topic.payload))
+      {
+        break;
+      }
+      trace.topics[id] = topic;
+    } else if (kind == static_cast<uint8_t>(ros1_bridge::TrafficRecordKind::MESSAGE)) {
+      TraceMessage message;
+      message.id = id;
+      if (
+        !read_value(in, message.time) || !read_value(in, message.size) ||
+        (trace.payloads && !read_payload(in, message.payload)))
+      {
+        break;
+      }
+      auto topic = trace.topics.find(id);
+      if (topic == trace.topics.end()) {
+        throw std::runtime_error("message of the unknown topic " + std::to_string(id));
+      }
+      if (topic->second.messages == 0) {
+        topic->second.first_time = message.time;
+      }
+      ++topic->second.messages;
+      topic->second.bytes += message.size;
+      if (!trace.payloads && message.size != topic->second.payload.size()) {
+        ++topic->second.resized_messages;
+      }
+      topic->second.last_time = message.time;
+      trace.messages.push_back(std::move(message));
+    } else {
+      throw std::runtime_error("unknown record kind " + std::to_string(kind));
+    }
+  }
+  return trace;
+}
+
+void
+print_summary(const Trace & trace)
+{
+  double duration = trace.messages.empty() ? 0.0 : trace.messages.back().time / 1e9;
+  printf(
+    "%zu topics, %zu messages in %.3f s, %s\n\n", trace.topics.size(), trace.messages.size(),
+    duration, trace.payloads ? "all payloads" : "first payload of every topic");
+  printf(
+    "%-5s %-40s %-30s %9s %9s %10s\n", "dir", "topic", "ROS 1 type", "messages", "rate hz",
+    "mean bytes");
+  for (const auto & entry : trace.topics) {
+    const TraceTopic & topic = entry.second;
+    double topic_duration = (topic.last_time - topic.first_time) / 1e9;
+    printf(
+      "%-5s %-40s %-30s %9" PRIu64 " %9.1f %10.1f\n", topic.direction.c_str(),
+      topic.topic_name.c_str(), topic.ros1_type_name.c_str(), topic.messages,
+      topic.messages > 1 && topic_duration > 0 ? (topic.messages - 1) / topic_duration : 0.0,
+      topic.messages ? static_cast<double>(topic.bytes) / topic.messages : 0.0);
+  }
+}
+
+/// The publisher of a topic on the side its messages came from.
+struct ReplayPublisher
+{
+  std::shared_ptr<ros1_bridge::FactoryInterface> factory;
+  ros::Publisher ros1_pub;
+  rclcpp::PublisherBase::SharedPtr ros2_pub;
+};
+
+int
+replay(
+  Trace & trace, int argc, char * argv[], double speed, double start_delay, size_t queue_size)
+{
+  ros::init(argc, argv, "replay_traffic");
+  ros::NodeHandle ros1_node;
+  rclcpp::init(argc, argv);
+  auto ros2_node = rclcpp::Node::make_shared("replay_traffic");
+
+  std::map<uint32_t, ReplayPublisher> publishers;
+  for (const auto & entry : trace.topics) {
+    const TraceTopic & topic = entry.second;
+    ReplayPublisher publisher;
+    try {
+      publisher.factory = ros1_bridge::get_factory(topic.ros1_type_name, topic.ros2_type_name);
+    } catch (std::runtime_error & e) {
+      fprintf(stderr, "skipping topic '%s': %s\n", topic.topic_name.c_str(), e.what());
+      continue;
+    }
+    if (topic.direction == "1to2") {
+      publisher.ros1_pub = publisher.factory->create_ros1_publisher(
+        ros1_node, topic.topic_name, queue_size);
+    } else {
+      publisher.ros2_pub = publisher.factory->create_ros2_publisher(
+        ros2_node, topic.topic_name, queue_size);
+    }
+    publishers[entry.first] = publisher;
+    if (topic.resized_messages) {
+      fprintf(
+        stderr, "warning: %" PRIu64 " of %" PRIu64 " messages of '%s' were recorded with another "
+        "size than the first payload of %zu bytes which replaces them\n", topic.resized_messages,
+        topic.messages, topic.topic_name.c_str(), topic.payload.size());
+    }
+  }
+
+  // give the bridge and the subscribers time to discover the publishers
+  std::this_thread::sleep_for(
+    std::chrono::milliseconds(static_cast<int64_t>(start_delay * 1e3)));
+
+  uint64_t published = 0;
+  uint64_t failed = 0;
+  uint64_t recorded_bytes = 0;
+  uint64_t replayed_bytes = 0;
+  std::chrono::nanoseconds max_lag(0);
+  auto start = std::chrono::steady_clock::now();
+  for (const auto & message : trace.messages) {
+    if (!ros::ok() || !rclcpp::ok()) {
+      break;
+    }
+    auto publisher = publishers.find(message.id);
+    if (publisher == publishers.end()) {
+      continue;
+    }
+    auto scheduled = start + std::chrono::nanoseconds(
+      static_cast<int64_t>(message.time / speed));
+    std::this_thread::sleep_until(scheduled);
+    max_lag = std::max(
+      max_lag, std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - scheduled));
+
+    const std::vector<uint8_t> & payload =
+      message.payload.empty() ? trace.topics[message.id].payload : message.payload;
+    try {
+      if (publisher->second.ros2_pub) {
+        publisher->second.factory->publish_serialized_ros1_to_ros2(
+          publisher->second.ros2_pub, payload);
+      } else {
+        publisher->second.factory->publish_serialized_ros1(publisher->second.ros1_pub, payload);
+      }
+      ++published;
+      recorded_bytes += message.size;
+      replayed_bytes += payload.size();
+    } catch (std::exception &) {
+      ++failed;
+    }
+  }
+  double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf(
+    "replayed %" PRIu64 " messages with %" PRIu64 " bytes (recorded %" PRIu64 " bytes) in %.3f s, "
+    "%" PRIu64 " failed, max lag behind the trace %.3f ms\n", published, replayed_bytes,
+    recorded_bytes, duration, failed, max_lag.count() / 1e6);
+
+  rclcpp::shutdown();
+  ros::shutdown();
+  return failed == 0 ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  using ros1_bridge::find_command_option;
+  using ros1_bridge::get_command_option_number;
+
+  std::vector<std::string> args(argv, argv + argc);
+  if (argc < 2 || find_command_option(args, "-h") || find_command_option(args, "--help")) {
+    std::stringstream ss;
+    ss << "Usage: replay_traffic <trace file> [options]" << std::endl;
+    ss << " -h, --help: This message." << std::endl;
+    ss << " --summary: Only print the topics of the trace and their rates and sizes.";
+    ss << std::endl;
+    ss << " --speed <factor>: Replay faster (> 1) or slower (< 1) than recorded (default: 1).";
+    ss << std::endl;
+    ss << " --start-delay <s>: Time to wait for the discovery before the first message ";
+    ss << "(default: 3)." << std::endl;
+    ss << " --queue-size <n>: Queue size of the publishers (default: 100)." << std::endl;
+    std::cout << ss.str();
+    return argc < 2 ? 1 : 0;
+  }
+
+  double speed;
+  double start_delay;
+  size_t queue_size;
+  if (
+    !get_command_option_number(args, "--speed", 1.0, speed) ||
+    !get_command_option_number(args, "--start-delay", 3.0, start_delay) ||
+    !get_command_option_number(args, "--queue-size", size_t{100}, queue_size))
+  {
+    return 1;
+  }
+  if (speed <= 0) {
+    fprintf(stderr, "the speed must be positive\n");
+    return 1;
+  }
+
+  try {
+    Trace trace = read_trace(argv[1]);
+    if (find_command_option(args, "--summary")) {
+      print_summary(trace);
+      return 0;
+    }
+    return replay(trace, argc, argv, speed, start_delay, queue_size);
+  } catch (std::exception & e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,443 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+
+#include "ros1_bridge/command_options.hpp"
+
+// Live view of the statistics which the bridges publish every second on the statistics topic.
+// It only subscribes to the ROS 2 side of the topic, so it works against every bridge
+// executable, the component and the nodelet, and shows the bridges of all processes at once.
+
+namespace
+{
+
+const char * const status_prefix = "ros1_bridge: ";
+
+// bridges which haven't been reported for a while are gone
+const std::chrono::seconds row_timeout(5);
+
+struct TopicRow
+{
+  std::string node;
+  std::string direction;
+  std::string topic;
+  std::string type;
+  double rate_hz = 0.0;
+  double bandwidth_bps = 0.0;
+  double conversion_p99_us = 0.0;
+  double delay_p99_us = 0.0;
+  double drops = 0.0;
+  std::chrono::steady_clock::time_point update_time;
+};
+
+struct DiscoveryRow
+{
+  std::string node;
+  std::string side;
+  double cycles = 0.0;
+  double cycle_p50_us = 0.0;
+  double cycle_p99_us = 0.0;
+  double cycle_max_us = 0.0;
+  std::chrono::steady_clock::time_point update_time;
+};
+
+enum class SortColumn
+{
+  TOPIC,
+  RATE,
+  BANDWIDTH,
+  CONVERSION,
+  DELAY,
+  DROPS
+};
+
+bool parse_sort_column(const std::string & name, SortColumn & column)
+{
+  static const std::map<std::string, SortColumn> columns = {
+    {"topic", SortColumn::TOPIC},
+    {"rate", SortColumn::RATE},
+    {"bandwidth", SortColumn::BANDWIDTH},
+    {"conversion", SortColumn::CONVERSION},
+    {"delay", SortColumn::DELAY},
+    {"drops", SortColumn::DROPS}
+  };
+  auto it = columns.find(name);
+  if (it == columns.end()) {
+    return false;
+  }
+  column = it->second;
+  return true;
+}
+
+double get_value(const diagnostic_msgs::msg::DiagnosticStatus & status, const std::string & key)
+{
+  for (const auto & key_value : status.values) {
+    if (key_value.key == key) {
+      return std::strtod(key_value.value.c_str(), nullptr);
+    }
+  }
+  return 0.0;
+}
+
+std::string format_bandwidth(double bytes_per_second)
+{
+  const char * units[] = {"B/s", "kB/s", "MB/s", "GB/s"};
+  size_t unit = 0;
+  while (bytes_per_second >= 1000.0 && unit + 1 < sizeof(units) / sizeof(units[0])) {
+    bytes_per_second /= 1000.0;
+    ++unit;
+  }
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.1f %s", bytes_per_second, units[unit]);
+  return buffer;
+}
+
+class StatisticsView
+{
+public:
+  explicit StatisticsView(SortColumn sort_column)
+  : sort_column_(sort_column)
+  {}
+
+  void
+  add(const diagnostic_msgs::msg::DiagnosticArray::SharedPtr msg)
+  {
+    auto now = std::chrono::steady_clock::now();
+    for (const auto & status : msg->status) {
+      if (status.name.compare(0, strlen(status_prefix), status_prefix) != 0) {
+        continue;
+      }
+      std::string name = status.name.substr(strlen(status_prefix));
+      size_t separator = name.find(' ');
+      if (separator == std::string::npos) {
+        continue;
+      }
+      std::string kind = name.substr(0, separator);
+      std::string rest = name.substr(separator + 1);
+
+      if (kind == "1to2" || kind == "2to1") {
+        TopicRow & row = topics_[status.hardware_id + " " + name];
+        row.node = status.hardware_id;
+        row.direction = kind;
+        row.topic = rest;
+        row.type = status.message;
+        row.rate_hz = get_value(status, "rate_hz");
+        row.bandwidth_bps = get_value(status, "bandwidth_bps");
+        row.conversion_p99_us = get_value(status, "conversion_time_p99_us");
+        row.delay_p99_us = get_value(status, "scheduling_delay_p99_us");
+        row.drops = get_value(status, "drops");
+        row.update_time = now;
+      } else if (kind == "discovery") {
+        DiscoveryRow & row = discovery_[status.hardware_id + " " + name];
+        row.node = status.hardware_id;
+        row.side = rest;
+        row.cycles = get_value(status, "cycles");
+        row.cycle_p50_us = get_value(status, "cycle_time_p50_us");
+        row.cycle_p99_us = get_value(status, "cycle_time_p99_us");
+        row.cycle_max_us = get_value(status, "cycle_time_max_us");
+        row.update_time = now;
+      }
+    }
+  }
+
+  void
+  set_sort_column(SortColumn sort_column)
+  {
+    sort_column_ = sort_column;
+  }
+
+  std::string
+  render(size_t width, size_t height)
+  {
+    remove_stale_rows();
+
+    std::vector<const TopicRow *> rows;
+    for (const auto & topic : topics_) {
+      rows.push_back(&topic.second);
+    }
+    std::stable_sort(rows.begin(), rows.end(), get_comparator());
+
+    std::stringstream out;
+    char line[512];
+    snprintf(
+      line, sizeof(line),
+      "ros1_bridge_top - %zu bridged topics, sort: [t]opic [r]ate [b]andwidth [c]onversion "
+      "[d]elay dr[o]ps, [q]uit\n\n", rows.size());
+    out << line;
+
+    // the topic column takes the remaining width
+    const size_t fixed_width = 4 + 1 + 10 + 1 + 12 + 1 + 11 + 1 + 11 + 1 + 9 + 1;
+    int topic_width = width > fixed_width + 20 ? static_cast<int>(width - fixed_width) : 20;
+    snprintf(
+      line, sizeof(line), "%-4s %10s %12s %11s %11s %9s %-*s\n",
+      "DIR", "RATE Hz", "BANDWIDTH", "CONV p99us", "DELAY p99us", "DROPS",
+      topic_width, "TOPIC (TYPE) @ NODE");
+    out << line;
+
+    // leave room for the header and the discovery section
+    size_t discovery_lines = discovery_.empty() ? 0 : discovery_.size() + 3;
+    size_t max_rows = height > 4 + discovery_lines ? height - 4 - discovery_lines : 1;
+    for (size_t i = 0; i < rows.size() && i < max_rows; ++i) {
+      const TopicRow & row = *rows[i];
+      std::string topic = row.topic + " (" + row.type + ") @ " + row.node;
+      if (topic.size() > static_cast<size_t>(topic_width)) {
+        topic = topic.substr(0, topic_width);
+      }
+      snprintf(
+        line, sizeof(line), "%-4s %10.1f %12s %11.1f %11.1f %9.0f %s\n",
+        row.direction.c_str(), row.rate_hz, format_bandwidth(row.bandwidth_bps).c_str(),
+        row.conversion_p99_us, row.delay_p99_us, row.drops, topic.c_str());
+      out << line;
+    }
+    if (rows.size() > max_rows) {
+      out << "... " << rows.size() - max_rows << " more\n";
+    }
+
+    if (!discovery_.empty()) {
+      out << "\n";
+      snprintf(
+        line, sizeof(line), "%-6s %8s %12s %12s %12s %s\n",
+        "SIDE", "CYCLES", "CYCLE p50us", "CYCLE p99us", "CYCLE maxus", "NODE");
+      out << line;
+      for (const auto & discovery : discovery_) {
+        const DiscoveryRow & row = discovery.second;
+        snprintf(
+          line, sizeof(line), "%-6s %8.0f %12.1f %12.1f %12.1f %s\n",
+          row.side.c_str(), row.cycles, row.cycle_p50_us, row.cycle_p99_us, row.cycle_max_us,
+          row.node.c_str());
+        out << line;
+      }
+    }
+    return out.str();
+  }
+
+private:
+  void
+  remove_stale_rows()
+  {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = topics_.begin(); it != topics_.end(); ) {
+      it = now - it->second.update_time > row_timeout ? topics_.erase(it) : std::next(it);
+    }
+    for (auto it = discovery_.begin(); it != discovery_.end(); ) {
+      it = now - it->second.update_time > row_timeout ? discovery_.erase(it) : std::next(it);
+    }
+  }
+
+  std::function<bool(const TopicRow *, const TopicRow *)>
+  get_comparator() const
+  {
+    // the topics are already ordered by node, direction and name, the numbers descending
+    switch (sort_column_) {
+      case SortColumn::RATE:
+        return [](const TopicRow * a, const TopicRow * b) {return a->rate_hz > b->rate_hz;};
+      case SortColumn::BANDWIDTH:
+        return [](const TopicRow * a, const TopicRow * b) {
+                 return a->bandwidth_bps > b->bandwidth_bps;
+               };
+      case SortColumn::CONVERSION:
+        return [](const TopicRow * a, const TopicRow * b) {
+                 return a->conversion_p99_us > b->conversion_p99_us;
+               };
+      case SortColumn::DELAY:
+        return [](const TopicRow * a, const TopicRow * b) {
+                 return a->delay_p99_us > b->delay_p99_us;
+               };
+      case SortColumn::DROPS:
+        return [](const TopicRow * a, const TopicRow * b) {return a->drops > b->drops;};
+      default:
+        return [](const TopicRow * a, const TopicRow * b) {return a->topic < b->topic;};
+    }
+  }
+
+  SortColumn sort_column_;
+  std::map<std::string, TopicRow> topics_;
+  std::map<std::string, DiscoveryRow> discovery_;
+};
+
+// puts the terminal into non canonical mode for single key presses as long as it exists
+class RawTerminal
+{
+public:
+  RawTerminal()
+  : enabled_(isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &original_) == 0)
+  {
+    if (enabled_) {
+      struct termios raw = original_;
+      raw.c_lflag &= ~(ICANON | ECHO);
+      raw.c_cc[VMIN] = 0;
+      raw.c_cc[VTIME] = 0;
+      tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    }
+  }
+
+  ~RawTerminal()
+  {
+    if (enabled_) {
+      tcsetattr(STDIN_FILENO, TCSANOW, &original_);
+    }
+  }
+
+  /// Wait up to the timeout for a key press, 0 if there was none.
+  char
+  read_key(std::chrono::milliseconds timeout)
+  {
+    if (!enabled_) {
+      rclcpp::sleep_for(timeout);
+      return 0;
+    }
+    struct pollfd fd = {STDIN_FILENO, POLLIN, 0};
+    char key = 0;
+    if (poll(&fd, 1, static_cast<int>(timeout.count())) > 0 && read(STDIN_FILENO, &key, 1) != 1) {
+      key = 0;
+    }
+    return key;
+  }
+
+private:
+  struct termios original_;
+  bool enabled_;
+};
+
+void get_terminal_size(size_t & width, size_t & height)
+{
+  struct winsize size;
+  if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0) {
+    width = size.ws_col;
+    height = size.ws_row;
+  } else {
+    width = 120;
+    height = 40;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  using ros1_bridge::find_command_option;
+  using ros1_bridge::get_command_option_value;
+
+  std::vector<std::string> args(argv, argv + argc);
+  if (find_command_option(args, "-h") || find_command_option(args, "--help")) {
+    std::stringstream ss;
+    ss << "Usage:" << std::endl;
+    ss << " -h, --help: This message." << std::endl;
+    ss << " --sort <column>: Initial sort column, one of topic, rate, bandwidth, conversion, ";
+    ss << "delay and drops (default: rate)" << std::endl;
+    ss << " --topic <name>: ROS 2 topic of the statistics (default: /ros1_bridge/statistics)";
+    ss << std::endl;
+    ss << " --once: Print the statistics once after the first period and exit." << std::endl;
+    std::cout << ss.str();
+    return 0;
+  }
+  SortColumn sort_column;
+  if (!parse_sort_column(get_command_option_value(args, "--sort", "rate"), sort_column)) {
+    fprintf(stderr, "unknown sort column, see --help\n");
+    return 1;
+  }
+  std::string topic = get_command_option_value(args, "--topic", "/ros1_bridge/statistics");
+  bool once = find_command_option(args, "--once");
+
+  rclcpp::init(argc, argv);
+  // several instances may watch the same bridges
+  auto node = rclcpp::Node::make_shared("ros1_bridge_top_" + std::to_string(getpid()));
+
+  StatisticsView view(sort_column);
+  bool received = false;
+  std::function<void(const diagnostic_msgs::msg::DiagnosticArray::SharedPtr)> callback =
+    [&view, &received](const diagnostic_msgs::msg::DiagnosticArray::SharedPtr msg) -> void
+    {
+      view.add(msg);
+      received = true;
+    };
+  auto subscription = node->create_subscription<diagnostic_msgs::msg::DiagnosticArray>(
+    topic, callback, rmw_qos_profile_default);
+
+  if (once) {
+    // the bridges publish every second, wait a little longer to hear from all of them
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(1500);
+    while (rclcpp::ok() && std::chrono::steady_clock::now() < deadline) {
+      rclcpp::spin_some(node);
+      rclcpp::sleep_for(std::chrono::milliseconds(50));
+    }
+    size_t width;
+    size_t height;
+    get_terminal_size(width, height);
+    printf("%s", view.render(width, SIZE_MAX).c_str());
+    rclcpp::shutdown();
+    return received ? 0 : 1;
+  }
+
+  const std::map<char, SortColumn> sort_keys = {
+    {'t', SortColumn::TOPIC},
+    {'r', SortColumn::RATE},
+    {'b', SortColumn::BANDWIDTH},
+    {'c', SortColumn::CONVERSION},
+    {'d', SortColumn::DELAY},
+    {'o', SortColumn::DROPS}
+  };
+  RawTerminal terminal;
+  // the statistics only change once per second, so redrawing more often is pointless
+  auto next_redraw = std::chrono::steady_clock::now();
+  while (rclcpp::ok()) {
+    rclcpp::spin_some(node);
+    char key = terminal.read_key(std::chrono::milliseconds(100));
+    if (key == 'q') {
+      break;
+    }
+    bool redraw = std::chrono::steady_clock::now() >= next_redraw;
+    auto sort_key = sort_keys.find(key);
+    if (sort_key != sort_keys.end()) {
+      view.set_sort_column(sort_key->second);
+      redraw = true;
+    }
+    if (redraw) {
+      size_t width;
+      size_t height;
+      get_terminal_size(width, height);
+      // move home and clear the screen
+      printf("\033[H\033[2J%s", view.render(width, height).c_str());
+      if (!received) {
+        printf("\nwaiting for statistics on '%s'\n", topic.c_str());
+      }
+      fflush(stdout);
+      next_redraw = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    }
+  }
+  rclcpp::shutdown();
+  return 0;
+}
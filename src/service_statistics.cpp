@@ -0,0 +1,107 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ros1_bridge/flight_recorder.hpp"
+#include "ros1_bridge/service_statistics.hpp"
+
+namespace ros1_bridge
+{
+
+ServiceStatistics::ServiceStatistics(
+  const std::string & direction, const std::string & service_name,
+  const std::string & type_name)
+: direction_(direction),
+  service_name_(service_name),
+  type_name_(type_name),
+  calls_(0),
+  failures_(0)
+{}
+
+ServiceStatistics::~ServiceStatistics()
+{
+  record_flight_event(FlightEventType::BRIDGE_DESTROYED, this);
+}
+
+void
+ServiceStatistics::add_call(bool success, std::chrono::nanoseconds call_time)
+{
+  calls_.fetch_add(1, std::memory_order_relaxed);
+  if (!success) {
+    failures_.fetch_add(1, std::memory_order_relaxed);
+  }
+  call_time_.add(call_time);
+  record_flight_event(
+    FlightEventType::SERVICE_CALL, this, success ? 1 : 0,
+    to_flight_value<std::chrono::microseconds>(call_time));
+}
+
+ServiceStatistics::Snapshot
+ServiceStatistics::get_snapshot() const
+{
+  Snapshot snapshot;
+  snapshot.direction = direction_;
+  snapshot.service_name = service_name_;
+  snapshot.type_name = type_name_;
+  snapshot.calls = calls_.load(std::memory_order_relaxed);
+  snapshot.failures = failures_.load(std::memory_order_relaxed);
+  snapshot.call_time = call_time_.get_buckets();
+  snapshot.call_time_sum = call_time_.get_sum();
+  return snapshot;
+}
+
+namespace
+{
+
+std::mutex g_service_registry_mutex;
+std::list<std::weak_ptr<ServiceStatistics>> g_service_registry;
+
+}  // namespace
+
+std::shared_ptr<ServiceStatistics>
+register_service_statistics(
+  const std::string & direction, const std::string & service_name,
+  const std::string & type_name)
+{
+  auto statistics = std::make_shared<ServiceStatistics>(direction, service_name, type_name);
+  record_flight_bridge_created(statistics.get(), 1, direction, service_name, type_name);
+  std::lock_guard<std::mutex> lock(g_service_registry_mutex);
+  g_service_registry.push_back(statistics);
+  return statistics;
+}
+
+std::vector<ServiceStatistics::Snapshot>
+get_all_service_statistics()
+{
+  std::vector<ServiceStatistics::Snapshot> snapshots;
+  std::lock_guard<std::mutex> lock(g_service_registry_mutex);
+  for (auto it = g_service_registry.begin(); it != g_service_registry.end(); ) {
+    auto statistics = it->lock();
+    if (!statistics) {
+      // the service bridge has been removed
+      it = g_service_registry.erase(it);
+      continue;
+    }
+    snapshots.push_back(statistics->get_snapshot());
+    ++it;
+  }
+  return snapshots;
+}
+
+}  // namespace ros1_bridge
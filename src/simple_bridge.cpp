@@ -32,6 +32,8 @@
 #include "rclcpp/rclcpp.hpp"
 #include "std_msgs/msg/string.hpp"
 
+#include "simple_bridge.hpp"
+
 
 ros::Publisher ros1_pub;
 
@@ -40,7 +42,7 @@ void ros2ChatterCallback(const std_msgs::msg::String::SharedPtr ros2_msg)
   printf("  I heard from ROS 2: [%s]\n", ros2_msg->data.c_str());
 
   std_msgs::String ros1_msg;
-  ros1_msg.data = ros2_msg->data;
+  simple_bridge::convert_2_to_1(*ros2_msg, ros1_msg);
   printf("  Passing along to ROS 1: [%s]\n", ros1_msg.data.c_str());
   ros1_pub.publish(ros1_msg);
 }
@@ -50,22 +52,19 @@ rclcpp::Publisher<std_msgs::msg::String>::SharedPtr ros2_pub;
 
 void ros1ChatterCallback(const ros::MessageEvent<std_msgs::String const> & ros1_msg_event)
 {
-  const boost::shared_ptr<ros::M_string> & connection_header =
-    ros1_msg_event.getConnectionHeaderPtr();
-  std::string key = "callerid";
-  if (connection_header->find(key) != connection_header->end()) {
-    if (connection_header->at(key) == "/ros_bridge") {
+  const std::string * callerid = simple_bridge::get_callerid(ros1_msg_event);
+  if (callerid) {
+    if (*callerid == simple_bridge::bridge_callerid) {
       printf("    I heard from ROS 1 from myself\n");
       return;
     }
-    printf("I heard from ROS 1 from: [%s]\n", connection_header->at(key).c_str());
+    printf("I heard from ROS 1 from: [%s]\n", callerid->c_str());
   }
 
   const boost::shared_ptr<std_msgs::String const> & ros1_msg = ros1_msg_event.getConstMessage();
   printf("I heard from ROS 1: [%s]\n", ros1_msg->data.c_str());
 
-  auto ros2_msg = std::make_shared<std_msgs::msg::String>();
-  ros2_msg->data = ros1_msg->data;
+  auto ros2_msg = simple_bridge::convert_1_to_2(*ros1_msg);
   printf("Passing along to ROS 2: [%s]\n", ros2_msg->data.c_str());
   ros2_pub->publish(ros2_msg);
 }
@@ -0,0 +1,74 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SIMPLE_BRIDGE_HPP_
+#define SIMPLE_BRIDGE_HPP_
+
+#include <memory>
+#include <string>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "ros/message_event.h"
+#include "std_msgs/String.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+// include ROS 2
+#include "std_msgs/msg/string.hpp"
+
+// The callbacks of the hand-written std_msgs/String bridges simple_bridge, simple_bridge_1_to_2
+// and simple_bridge_2_to_1, without their output, which benchmark_generic_overhead compares
+// with the callbacks of the generic Factory.
+
+namespace simple_bridge
+{
+
+/// The caller id of the simple_bridge in ROS 1.
+constexpr const char bridge_callerid[] = "/ros_bridge";
+
+/// Get the caller id from the connection header of a ROS 1 message, nullptr if it has none.
+inline const std::string *
+get_callerid(const ros::MessageEvent<std_msgs::String const> & ros1_msg_event)
+{
+  const boost::shared_ptr<ros::M_string> & connection_header =
+    ros1_msg_event.getConnectionHeaderPtr();
+  auto it = connection_header->find("callerid");
+  if (it == connection_header->end()) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+inline std_msgs::msg::String::SharedPtr
+convert_1_to_2(const std_msgs::String & ros1_msg)
+{
+  auto ros2_msg = std::make_shared<std_msgs::msg::String>();
+  ros2_msg->data = ros1_msg.data;
+  return ros2_msg;
+}
+
+inline void
+convert_2_to_1(const std_msgs::msg::String & ros2_msg, std_msgs::String & ros1_msg)
+{
+  ros1_msg.data = ros2_msg.data;
+}
+
+}  // namespace simple_bridge
+
+#endif  // SIMPLE_BRIDGE_HPP_
@@ -30,6 +30,8 @@
 #include "rclcpp/rclcpp.hpp"
 #include "std_msgs/msg/string.hpp"
 
+#include "simple_bridge.hpp"
+
 
 rclcpp::Publisher<std_msgs::msg::String>::SharedPtr pub;
 
@@ -37,8 +39,7 @@ void chatterCallback(const std_msgs::String::ConstPtr & ros1_msg)
 {
   std::cout << "I heard: [" << ros1_msg->data << "]" << std::endl;
 
-  auto ros2_msg = std::make_shared<std_msgs::msg::String>();
-  ros2_msg->data = ros1_msg->data;
+  auto ros2_msg = simple_bridge::convert_1_to_2(*ros1_msg);
   std::cout << "Passing along: [" << ros2_msg->data << "]" << std::endl;
   pub->publish(ros2_msg);
 }
@@ -29,6 +29,8 @@
 #include "rclcpp/rclcpp.hpp"
 #include "std_msgs/msg/string.hpp"
 
+#include "simple_bridge.hpp"
+
 
 ros::Publisher pub;
 
@@ -37,7 +39,7 @@ void chatterCallback(const std_msgs::msg::String::SharedPtr ros2_msg)
   std::cout << "I heard: [" << ros2_msg->data << "]" << std::endl;
 
   std_msgs::String ros1_msg;
-  ros1_msg.data = ros2_msg->data;
+  simple_bridge::convert_2_to_1(*ros2_msg, ros1_msg);
   std::cout << "Passing along: [" << ros1_msg.data << "]" << std::endl;
   pub.publish(ros1_msg);
 }
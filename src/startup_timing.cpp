@@ -0,0 +1,78 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "ros1_bridge/startup_timing.hpp"
+
+namespace ros1_bridge
+{
+
+const char * const startup_report_variable = "ROS1_BRIDGE_STARTUP_REPORT";
+
+namespace
+{
+
+// function local, so the phase can be recorded by a static object of the library
+const char *
+get_startup_report_path()
+{
+  static const char * path = getenv(startup_report_variable);
+  return path;
+}
+
+struct LibraryLoadedRecorder
+{
+  LibraryLoadedRecorder()
+  {
+    record_startup_phase("library_loaded");
+  }
+};
+
+LibraryLoadedRecorder g_library_loaded_recorder;
+
+}  // namespace
+
+void
+record_startup_phase(const char * phase)
+{
+  const char * path = get_startup_report_path();
+  if (!path || !path[0]) {
+    return;
+  }
+  uint64_t now = static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+
+  static std::mutex mutex;
+  static std::set<std::string> recorded_phases;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!recorded_phases.insert(phase).second) {
+    return;
+  }
+  FILE * file = fopen(path, "a");
+  if (!file) {
+    return;
+  }
+  fprintf(file, "%s %" PRIu64 "\n", phase, now);
+  fclose(file);
+}
+
+}  // namespace ros1_bridge
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <csignal>
 #include <string>
 
 // include ROS 1
@@ -28,6 +29,10 @@
 #include "rclcpp/rclcpp.hpp"
 
 #include "ros1_bridge/bridge.hpp"
+#include "ros1_bridge/flight_recorder.hpp"
+#include "ros1_bridge/flight_recorder_service.hpp"
+#include "ros1_bridge/phase_timing_service.hpp"
+#include "ros1_bridge/statistics_publisher.hpp"
 
 
 int main(int argc, char * argv[])
@@ -49,6 +54,11 @@ int main(int argc, char * argv[])
   auto handles = ros1_bridge::create_bidirectional_bridge(
     ros1_node, ros2_node, ros1_type_name, ros2_type_name, topic_name, queue_size);
 
+  ros1_bridge::StatisticsPublisher statistics_publisher(ros1_node, ros2_node);
+  ros1_bridge::PhaseTimingService phase_timing_service(ros2_node);
+  ros1_bridge::FlightRecorderService flight_recorder_service(ros2_node);
+  ros1_bridge::install_flight_recorder_signal_handler(SIGUSR1);
+
   // ROS 1 asynchronous spinner
   ros::AsyncSpinner async_spinner(1);
   async_spinner.start();
@@ -0,0 +1,222 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+#include <string>
+#include <vector>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "diagnostic_msgs/DiagnosticArray.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+#include "diagnostic_msgs_factories.hpp"
+
+#include "ros1_bridge/allocation_accounting.hpp"
+#include "ros1_bridge/statistics_publisher.hpp"
+
+using DiagnosticArrayFactory = ros1_bridge::Factory<
+  diagnostic_msgs::DiagnosticArray, diagnostic_msgs::msg::DiagnosticArray
+>;
+
+namespace ros1_bridge
+{
+
+namespace
+{
+
+void
+add_value(
+  diagnostic_msgs::msg::DiagnosticStatus & status, const std::string & key, double value)
+{
+  diagnostic_msgs::msg::KeyValue key_value;
+  key_value.key = key;
+  key_value.value = std::to_string(value);
+  status.values.push_back(key_value);
+}
+
+void
+add_value(
+  diagnostic_msgs::msg::DiagnosticStatus & status, const std::string & key, uint64_t value)
+{
+  diagnostic_msgs::msg::KeyValue key_value;
+  key_value.key = key;
+  key_value.value = std::to_string(value);
+  status.values.push_back(key_value);
+}
+
+void
+add_timing(
+  diagnostic_msgs::msg::DiagnosticStatus & status, const std::string & prefix,
+  const DurationHistogram::Buckets & current, const DurationHistogram::Buckets & previous)
+{
+  DurationHistogram::Buckets period;
+  for (size_t i = 0; i < DurationHistogram::bucket_count; ++i) {
+    period[i] = current[i] >= previous[i] ? current[i] - previous[i] : current[i];
+  }
+  auto to_us = [](std::chrono::nanoseconds duration) -> double
+    {
+      return std::chrono::duration<double, std::micro>(duration).count();
+    };
+  add_value(status, prefix + "_p50_us", to_us(DurationHistogram::get_quantile(period, 0.5)));
+  add_value(status, prefix + "_p99_us", to_us(DurationHistogram::get_quantile(period, 0.99)));
+  add_value(status, prefix + "_max_us", to_us(DurationHistogram::get_max(period)));
+}
+
+}  // namespace
+
+StatisticsPublisher::StatisticsPublisher(
+  ros::NodeHandle ros1_node,
+  rclcpp::Node::SharedPtr ros2_node,
+  std::chrono::nanoseconds period)
+: node_name_(ros2_node->get_name()),
+  clock_(ros2_node->get_clock()),
+  previous_time_(std::chrono::steady_clock::now())
+{
+  ros1_pub_ = ros1_node.advertise<diagnostic_msgs::DiagnosticArray>(statistics_topic_name, 10);
+  ros2_pub_ = ros2_node->create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
+    statistics_topic_name, rmw_qos_profile_default);
+  timer_ = ros2_node->create_wall_timer(period, [this]() -> void {publish();});
+}
+
+void
+StatisticsPublisher::publish()
+{
+  auto now = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(now - previous_time_).count();
+  previous_time_ = now;
+
+  diagnostic_msgs::msg::DiagnosticArray ros2_msg;
+  ros2_msg.header.stamp = clock_->now();
+
+  std::map<std::string, TopicStatistics::Snapshot> snapshots;
+  for (auto & snapshot : get_all_topic_statistics()) {
+    // the bridges of a topic to several ROS 2 domains differ only in the domain
+    std::string key = snapshot.direction + " " + get_statistics_name(snapshot);
+
+    TopicStatistics::Snapshot previous = {};
+    auto it = previous_snapshots_.find(key);
+    // a bridge which has been recreated starts counting from zero again
+    if (it != previous_snapshots_.end() && it->second.messages <= snapshot.messages) {
+      previous = it->second;
+    }
+
+    diagnostic_msgs::msg::DiagnosticStatus status;
+    uint64_t drops = snapshot.drops - previous.drops;
+    status.level = drops ?
+      diagnostic_msgs::msg::DiagnosticStatus::WARN : diagnostic_msgs::msg::DiagnosticStatus::OK;
+    status.name = "ros1_bridge: " + key;
+    status.message = snapshot.type_name;
+    status.hardware_id = node_name_;
+    add_value(status, "messages", snapshot.messages);
+    add_value(status, "bytes", snapshot.bytes);
+    add_value(status, "drops", snapshot.drops);
+    add_value(status, "loopbacks", snapshot.loopbacks);
+    if (elapsed > 0.0) {
+      add_value(status, "rate_hz", (snapshot.messages - previous.messages) / elapsed);
+      add_value(status, "bandwidth_bps", (snapshot.bytes - previous.bytes) / elapsed);
+    }
+    add_timing(status, "conversion_time", snapshot.conversion_time, previous.conversion_time);
+    add_timing(status, "publish_time", snapshot.publish_time, previous.publish_time);
+    add_timing(
+      status, "scheduling_delay", snapshot.scheduling_delay, previous.scheduling_delay);
+    if (allocation_accounting_enabled && snapshot.messages > previous.messages) {
+      double period_messages = static_cast<double>(snapshot.messages - previous.messages);
+      add_value(
+        status, "allocations_per_message",
+        (snapshot.allocations - previous.allocations) / period_messages);
+      add_value(
+        status, "allocated_bytes_per_message",
+        (snapshot.allocated_bytes - previous.allocated_bytes) / period_messages);
+    }
+    ros2_msg.status.push_back(status);
+
+    snapshots[key] = snapshot;
+  }
+  previous_snapshots_.swap(snapshots);
+
+  std::map<std::string, LockStatistics> locks;
+  for (auto & statistics : get_all_lock_statistics()) {
+    std::string key = statistics.lock + " at " + statistics.site;
+
+    LockStatistics previous = {};
+    auto it = previous_locks_.find(key);
+    if (it != previous_locks_.end() && it->second.acquisitions <= statistics.acquisitions) {
+      previous = it->second;
+    }
+
+    diagnostic_msgs::msg::DiagnosticStatus status;
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+    status.name = "ros1_bridge: lock " + key;
+    status.hardware_id = node_name_;
+    add_value(status, "acquisitions", statistics.acquisitions);
+    add_value(status, "contentions", statistics.contentions);
+    add_timing(status, "wait_time", statistics.wait_time, previous.wait_time);
+    add_timing(status, "hold_time", statistics.hold_time, previous.hold_time);
+    ros2_msg.status.push_back(status);
+
+    locks[key] = statistics;
+  }
+  previous_locks_.swap(locks);
+
+  std::map<std::string, DiscoveryStatistics> discovery;
+  for (auto & statistics : get_discovery_statistics()) {
+    DiscoveryStatistics previous = {};
+    auto it = previous_discovery_.find(statistics.side);
+    if (it != previous_discovery_.end()) {
+      previous = it->second;
+    }
+
+    diagnostic_msgs::msg::DiagnosticStatus status;
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+    status.name = "ros1_bridge: discovery " + statistics.side;
+    status.hardware_id = node_name_;
+    add_value(status, "cycles", statistics.cycles);
+    add_timing(status, "cycle_time", statistics.cycle_time, previous.cycle_time);
+    ros2_msg.status.push_back(status);
+
+    discovery[statistics.side] = statistics;
+  }
+  previous_discovery_.swap(discovery);
+
+  if (allocation_accounting_enabled) {
+    // one value per topic and direction, including the memory still held by destroyed bridges
+    diagnostic_msgs::msg::DiagnosticStatus status;
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+    status.name = "ros1_bridge: memory";
+    status.message = "heap bytes held per topic";
+    status.hardware_id = node_name_;
+    for (const auto & usage : get_memory_usage()) {
+      add_value(
+        status, usage.direction + " " + usage.topic_name,
+        static_cast<uint64_t>(usage.held_bytes > 0 ? usage.held_bytes : 0));
+    }
+    ros2_msg.status.push_back(status);
+  }
+
+  ros2_pub_->publish(ros2_msg);
+
+  if (ros1_pub_.getNumSubscribers() > 0) {
+    diagnostic_msgs::DiagnosticArray ros1_msg;
+    DiagnosticArrayFactory::convert_2_to_1(ros2_msg, ros1_msg);
+    ros1_pub_.publish(ros1_msg);
+  }
+}
+
+}  // namespace ros1_bridge
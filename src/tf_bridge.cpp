@@ -0,0 +1,248 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "ros/ros.h"
+#include "tf2_msgs/TFMessage.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+#include "ros/this_node.h"
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+#include "tf2_msgs/msg/tf_message.hpp"
+
+#include "ros1_bridge/command_options.hpp"
+
+// generated conversion functions for tf2_msgs
+#include "tf2_msgs_factories.hpp"
+
+
+using TfFactory = ros1_bridge::Factory<tf2_msgs::TFMessage, tf2_msgs::msg::TFMessage>;
+
+using ros1_bridge::find_command_option;
+using ros1_bridge::get_command_option_number;
+
+bool parse_command_options(
+  int argc, char ** argv, int & coalesce_window_ms, bool & bridge_tf_static, int & exit_code)
+{
+  std::vector<std::string> args(argv, argv + argc);
+  exit_code = 0;
+
+  if (find_command_option(args, "-h") || find_command_option(args, "--help")) {
+    std::stringstream ss;
+    ss << "Usage:" << std::endl;
+    ss << " -h, --help: This message." << std::endl;
+    ss << " --coalesce-window-ms <ms>: Collect the /tf transforms arriving within this window ";
+    ss << "into a single ROS 2 message, 0 forwards every message (default: 10)." << std::endl;
+    ss << " --no-tf-static: Do not bridge /tf_static." << std::endl;
+    std::cout << ss.str();
+    return false;
+  }
+
+  if (!get_command_option_number(args, "--coalesce-window-ms", 10, coalesce_window_ms)) {
+    exit_code = 1;
+    return false;
+  }
+  if (coalesce_window_ms < 0) {
+    coalesce_window_ms = 0;
+  }
+  bridge_tf_static = !find_command_option(args, "--no-tf-static");
+  return true;
+}
+
+bool is_from_this_node(const ros::MessageEvent<tf2_msgs::TFMessage const> & ros1_msg_event)
+{
+  const boost::shared_ptr<ros::M_string> & connection_header =
+    ros1_msg_event.getConnectionHeaderPtr();
+  if (!connection_header) {
+    return false;
+  }
+  const auto caller = connection_header->find("callerid");
+  return caller != connection_header->end() && caller->second == ros::this_node::getName();
+}
+
+bool is_same_static_transform(
+  const geometry_msgs::TransformStamped & a, const geometry_msgs::TransformStamped & b)
+{
+  // the stamp is deliberately ignored, static transforms are republished with new stamps
+  // by many publishers without changing their value
+  return
+    a.header.frame_id == b.header.frame_id &&
+    a.child_frame_id == b.child_frame_id &&
+    a.transform.translation.x == b.transform.translation.x &&
+    a.transform.translation.y == b.transform.translation.y &&
+    a.transform.translation.z == b.transform.translation.z &&
+    a.transform.rotation.x == b.transform.rotation.x &&
+    a.transform.rotation.y == b.transform.rotation.y &&
+    a.transform.rotation.z == b.transform.rotation.z &&
+    a.transform.rotation.w == b.transform.rotation.w;
+}
+
+int main(int argc, char * argv[])
+{
+  int coalesce_window_ms;
+  bool bridge_tf_static;
+  int exit_code;
+  if (!parse_command_options(argc, argv, coalesce_window_ms, bridge_tf_static, exit_code)) {
+    return exit_code;
+  }
+
+  // ROS 1 node
+  ros::init(argc, argv, "ros_bridge_tf");
+  ros::NodeHandle ros1_node;
+
+  // ROS 2 node
+  rclcpp::init(argc, argv);
+  auto ros2_node = rclcpp::Node::make_shared("ros_bridge_tf");
+
+  // /tf uses the same profile as the tf2_ros broadcaster
+  rmw_qos_profile_t tf_qos_profile = rmw_qos_profile_default;
+  tf_qos_profile.depth = 100;
+  auto tf_pub = ros2_node->create_publisher<tf2_msgs::msg::TFMessage>("/tf", tf_qos_profile);
+
+  // transforms received from ROS 1 which have not been passed to ROS 2 yet
+  std::mutex pending_tf_mutex;
+  tf2_msgs::TFMessage pending_tf;
+
+  auto publish_tf = [&tf_pub](const tf2_msgs::TFMessage & ros1_msg)
+    {
+      auto ros2_msg = std::make_shared<tf2_msgs::msg::TFMessage>();
+      TfFactory::convert_1_to_2(ros1_msg, *ros2_msg);
+      tf_pub->publish(ros2_msg);
+    };
+
+  boost::function<void(const ros::MessageEvent<tf2_msgs::TFMessage const> &)> tf_callback =
+    [coalesce_window_ms, &pending_tf_mutex, &pending_tf, &publish_tf](
+    const ros::MessageEvent<tf2_msgs::TFMessage const> & ros1_msg_event)
+    {
+      if (is_from_this_node(ros1_msg_event)) {
+        return;
+      }
+      const auto & ros1_msg = ros1_msg_event.getConstMessage();
+      if (coalesce_window_ms == 0) {
+        publish_tf(*ros1_msg);
+        return;
+      }
+      std::lock_guard<std::mutex> lock(pending_tf_mutex);
+      pending_tf.transforms.insert(
+        pending_tf.transforms.end(), ros1_msg->transforms.begin(), ros1_msg->transforms.end());
+    };
+  auto tf_sub = ros1_node.subscribe<tf2_msgs::TFMessage>("/tf", 100, tf_callback);
+
+  // pass all transforms collected within one window along as a single message
+  rclcpp::TimerBase::SharedPtr coalesce_timer;
+  if (coalesce_window_ms > 0) {
+    coalesce_timer = ros2_node->create_wall_timer(
+      std::chrono::milliseconds(coalesce_window_ms),
+      [&pending_tf_mutex, &pending_tf, &publish_tf]() -> void
+      {
+        tf2_msgs::TFMessage batch;
+        {
+          std::lock_guard<std::mutex> lock(pending_tf_mutex);
+          if (pending_tf.transforms.empty()) {
+            return;
+          }
+          // keep the capacity of the pending buffer for the next window
+          batch.transforms.reserve(pending_tf.transforms.size());
+          batch.transforms.swap(pending_tf.transforms);
+        }
+        publish_tf(batch);
+      });
+  }
+
+  // /tf_static is latched in ROS 1, the equivalent in ROS 2 is a transient local publisher
+  // which always carries the aggregate of all static frames received so far
+  rclcpp::Publisher<tf2_msgs::msg::TFMessage>::SharedPtr tf_static_pub;
+  ros::Subscriber tf_static_sub;
+  std::mutex static_transforms_mutex;
+  std::map<std::string, geometry_msgs::TransformStamped> static_transforms;
+  if (bridge_tf_static) {
+    rmw_qos_profile_t tf_static_qos_profile = rmw_qos_profile_default;
+    tf_static_qos_profile.depth = 1;
+    tf_static_qos_profile.durability = RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL;
+    tf_static_pub = ros2_node->create_publisher<tf2_msgs::msg::TFMessage>(
+      "/tf_static", tf_static_qos_profile);
+
+    boost::function<void(const ros::MessageEvent<tf2_msgs::TFMessage const> &)>
+    tf_static_callback =
+      [&tf_static_pub, &static_transforms_mutex, &static_transforms](
+      const ros::MessageEvent<tf2_msgs::TFMessage const> & ros1_msg_event)
+      {
+        if (is_from_this_node(ros1_msg_event)) {
+          return;
+        }
+        const auto & ros1_msg = ros1_msg_event.getConstMessage();
+
+        tf2_msgs::TFMessage aggregate;
+        {
+          std::lock_guard<std::mutex> lock(static_transforms_mutex);
+          bool changed = false;
+          for (const auto & transform : ros1_msg->transforms) {
+            auto it = static_transforms.find(transform.child_frame_id);
+            if (it != static_transforms.end() && is_same_static_transform(it->second, transform)) {
+              continue;
+            }
+            static_transforms[transform.child_frame_id] = transform;
+            changed = true;
+          }
+          if (!changed) {
+            // every latched publisher resends its frames to each new subscriber
+            return;
+          }
+          aggregate.transforms.reserve(static_transforms.size());
+          for (const auto & static_transform : static_transforms) {
+            aggregate.transforms.push_back(static_transform.second);
+          }
+        }
+
+        auto ros2_msg = std::make_shared<tf2_msgs::msg::TFMessage>();
+        TfFactory::convert_1_to_2(aggregate, *ros2_msg);
+        tf_static_pub->publish(ros2_msg);
+      };
+    tf_static_sub = ros1_node.subscribe<tf2_msgs::TFMessage>(
+      "/tf_static", 100, tf_static_callback);
+  }
+
+  printf(
+    "bridging /tf from ROS 1 to ROS 2 (coalesce window: %d ms)%s\n", coalesce_window_ms,
+    bridge_tf_static ? " and /tf_static as transient local" : "");
+
+  // ROS 1 asynchronous spinner
+  ros::AsyncSpinner async_spinner(1);
+  async_spinner.start();
+
+  // ROS 2 spinning loop
+  rclcpp::executors::SingleThreadedExecutor executor;
+  while (ros1_node.ok() && rclcpp::ok()) {
+    executor.spin_node_once(ros2_node, std::chrono::milliseconds(1000));
+  }
+
+  return 0;
+}
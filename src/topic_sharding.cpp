@@ -0,0 +1,234 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ros1_bridge/topic_sharding.hpp"
+
+namespace ros1_bridge
+{
+
+uint64_t
+stable_hash(const std::string & value)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : value) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+namespace
+{
+
+// the FNV-1a hashes of names which only differ in the last character are correlated, which
+// skews the weighted scores, so their bits are mixed with the finalizer of MurmurHash3
+uint64_t
+mix_hash(uint64_t hash)
+{
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+}  // namespace
+
+TopicSharding::TopicSharding(size_t shard_count, size_t shard_index)
+: shard_count_(shard_count),
+  shard_index_(shard_index),
+  shard_weights_(shard_count, 1.0),
+  last_seen_(shard_count, std::chrono::steady_clock::now()),
+  live_since_(last_seen_),
+  timeout_(std::chrono::steady_clock::duration::zero())
+{
+  if (shard_count_ == 0 || shard_index_ >= shard_count_) {
+    throw std::runtime_error(
+            "Invalid shard index " + std::to_string(shard_index) +
+            " for shard count " + std::to_string(shard_count));
+  }
+  for (size_t i = 0; i < shard_count_; ++i) {
+    live_shards_.insert(i);
+  }
+}
+
+size_t
+TopicSharding::get_shard_count() const
+{
+  return shard_count_;
+}
+
+size_t
+TopicSharding::get_shard_index() const
+{
+  return shard_index_;
+}
+
+void
+TopicSharding::set_shard_weights(const std::vector<double> & shard_weights)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < shard_count_; ++i) {
+    shard_weights_[i] = i < shard_weights.size() && shard_weights[i] > 0.0 ?
+      shard_weights[i] : 1.0;
+  }
+  assign_weighted_topics();
+}
+
+void
+TopicSharding::set_topic_weights(const std::map<std::string, double> & topic_weights)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  topic_weights_ = topic_weights;
+  assign_weighted_topics();
+}
+
+bool
+TopicSharding::update_live_shards(
+  const std::set<size_t> & seen_shards,
+  std::chrono::steady_clock::duration timeout)
+{
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  timeout_ = timeout;
+  std::set<size_t> live_shards;
+  for (size_t i = 0; i < shard_count_; ++i) {
+    if (i == shard_index_ || seen_shards.count(i)) {
+      last_seen_[i] = now;
+    }
+    if (now - last_seen_[i] <= timeout) {
+      live_shards.insert(i);
+      if (!live_shards_.count(i)) {
+        live_since_[i] = now;
+      }
+    }
+  }
+  if (live_shards == live_shards_) {
+    return false;
+  }
+  live_shards_.swap(live_shards);
+  return true;
+}
+
+std::set<size_t>
+TopicSharding::get_live_shards() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return live_shards_;
+}
+
+size_t
+TopicSharding::get_shard(const std::string & name) const
+{
+  if (shard_count_ == 1) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  return get_shard_locked(name);
+}
+
+bool
+TopicSharding::is_local(const std::string & name) const
+{
+  return get_shard(name) == shard_index_;
+}
+
+bool
+TopicSharding::is_handed_over(const std::string & name) const
+{
+  if (shard_count_ == 1) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t shard = get_shard_locked(name);
+  return shard != shard_index_ &&
+         std::chrono::steady_clock::now() - live_since_[shard] >= timeout_;
+}
+
+size_t
+TopicSharding::get_shard_locked(const std::string & name) const
+{
+  auto it = weighted_assignment_.find(name);
+  if (it != weighted_assignment_.end() && live_shards_.count(it->second)) {
+    return it->second;
+  }
+  // names without a weight and the weighted names of a dead shard
+  return get_hashed_shard(name);
+}
+
+size_t
+TopicSharding::get_hashed_shard(const std::string & name) const
+{
+  // weighted rendezvous hashing: the live shard with the highest score wins
+  size_t best_shard = shard_index_;
+  double best_score = -std::numeric_limits<double>::infinity();
+  for (size_t shard : live_shards_) {
+    uint64_t hash = mix_hash(stable_hash(name + '#' + std::to_string(shard)));
+    // map the hash into the open interval (0, 1)
+    double unit = (static_cast<double>(hash >> 11) + 0.5) / static_cast<double>(1ULL << 53);
+    double score = -shard_weights_[shard] / std::log(unit);
+    if (score > best_score) {
+      best_score = score;
+      best_shard = shard;
+    }
+  }
+  return best_shard;
+}
+
+void
+TopicSharding::assign_weighted_topics()
+{
+  // the assignment doesn't depend on the live shards, so a shard dying or returning doesn't
+  // move the weighted names between the other shards
+  weighted_assignment_.clear();
+
+  // heaviest first, ties are broken by the name to be independent of the map order
+  std::vector<std::pair<double, std::string>> topics;
+  for (const auto & topic_weight : topic_weights_) {
+    topics.emplace_back(topic_weight.second, topic_weight.first);
+  }
+  std::sort(
+    topics.begin(), topics.end(),
+    [](const std::pair<double, std::string> & a, const std::pair<double, std::string> & b) {
+      return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+
+  std::vector<double> load(shard_count_, 0.0);
+  for (const auto & topic : topics) {
+    size_t best_shard = 0;
+    double best_load = std::numeric_limits<double>::infinity();
+    for (size_t shard = 0; shard < shard_count_; ++shard) {
+      double relative_load = (load[shard] + topic.first) / shard_weights_[shard];
+      if (relative_load < best_load) {
+        best_load = relative_load;
+        best_shard = shard;
+      }
+    }
+    load[best_shard] += topic.first;
+    weighted_assignment_[topic.second] = best_shard;
+  }
+}
+
+}  // namespace ros1_bridge
@@ -0,0 +1,238 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ros1_bridge/flight_recorder.hpp"
+#include "ros1_bridge/topic_statistics.hpp"
+#include "ros1_bridge/tracepoints.hpp"
+
+namespace ros1_bridge
+{
+
+const char * const statistics_topic_name = "ros1_bridge/statistics";
+
+bool
+is_statistics_topic(const std::string & topic_name)
+{
+  return topic_name == statistics_topic_name ||
+         topic_name == std::string("/") + statistics_topic_name;
+}
+
+TopicStatistics::TopicStatistics(
+  const std::string & direction, const std::string & topic_name, const std::string & type_name,
+  const std::string & domain)
+: direction_(direction),
+  topic_name_(topic_name),
+  type_name_(type_name),
+  domain_(domain),
+  messages_(0),
+  bytes_(0),
+  drops_(0),
+  loopbacks_(0),
+  allocations_(0),
+  allocated_bytes_(0),
+  memory_account_(ros1_bridge::get_memory_account(direction, topic_name)),
+  phase_timing_enabled_(false)
+{}
+
+TopicStatistics::~TopicStatistics()
+{
+  // the statistics live as long as the subscription of the bridge
+  ROS1_BRIDGE_TRACEPOINT_BRIDGE_DESTROYED(this);
+  record_flight_event(FlightEventType::BRIDGE_DESTROYED, this);
+}
+
+const char *
+TopicStatistics::get_phase_name(Phase phase)
+{
+  switch (phase) {
+    case DESERIALIZATION:
+      return "deserialization";
+    case HEADER_CHECK:
+      return "header_check";
+    case ALLOCATION:
+      return "allocation";
+    case CONVERSION:
+      return "conversion";
+    case PUBLISH:
+      return "publish";
+    default:
+      return "unknown";
+  }
+}
+
+void
+TopicStatistics::add_message(
+  size_t bytes, std::chrono::nanoseconds conversion_time, std::chrono::nanoseconds publish_time)
+{
+  messages_.fetch_add(1, std::memory_order_relaxed);
+  bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  conversion_time_.add(conversion_time);
+  publish_time_.add(publish_time);
+  record_flight_event(
+    FlightEventType::MESSAGE, this, bytes < UINT32_MAX ? static_cast<uint32_t>(bytes) : UINT32_MAX,
+    to_flight_value<std::chrono::nanoseconds>(conversion_time),
+    to_flight_value<std::chrono::nanoseconds>(publish_time));
+}
+
+void
+TopicStatistics::add_drop()
+{
+  drops_.fetch_add(1, std::memory_order_relaxed);
+  record_flight_event(FlightEventType::DROP, this);
+}
+
+void
+TopicStatistics::add_loopback()
+{
+  loopbacks_.fetch_add(1, std::memory_order_relaxed);
+  record_flight_event(FlightEventType::LOOPBACK, this);
+}
+
+void
+TopicStatistics::add_allocations(uint64_t allocations, uint64_t bytes)
+{
+  allocations_.fetch_add(allocations, std::memory_order_relaxed);
+  allocated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void
+TopicStatistics::add_scheduling_delay(std::chrono::nanoseconds delay)
+{
+  scheduling_delay_.add(delay);
+}
+
+TopicStatistics::Snapshot
+TopicStatistics::get_snapshot() const
+{
+  Snapshot snapshot;
+  snapshot.direction = direction_;
+  snapshot.topic_name = topic_name_;
+  snapshot.type_name = type_name_;
+  snapshot.domain = domain_;
+  snapshot.messages = messages_.load(std::memory_order_relaxed);
+  snapshot.bytes = bytes_.load(std::memory_order_relaxed);
+  snapshot.drops = drops_.load(std::memory_order_relaxed);
+  snapshot.loopbacks = loopbacks_.load(std::memory_order_relaxed);
+  snapshot.conversion_time = conversion_time_.get_buckets();
+  snapshot.publish_time = publish_time_.get_buckets();
+  snapshot.conversion_time_sum = conversion_time_.get_sum();
+  snapshot.publish_time_sum = publish_time_.get_sum();
+  snapshot.allocations = allocations_.load(std::memory_order_relaxed);
+  snapshot.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+  snapshot.scheduling_delay = scheduling_delay_.get_buckets();
+  snapshot.scheduling_delay_sum = scheduling_delay_.get_sum();
+  return snapshot;
+}
+
+const std::string &
+TopicStatistics::get_direction() const
+{
+  return direction_;
+}
+
+const std::string &
+TopicStatistics::get_topic_name() const
+{
+  return topic_name_;
+}
+
+void
+TopicStatistics::set_phase_timing_enabled(bool enabled)
+{
+  if (enabled) {
+    for (auto & phase_time : phase_times_) {
+      phase_time.reset();
+    }
+  }
+  phase_timing_enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void
+TopicStatistics::add_phase_time(Phase phase, std::chrono::nanoseconds duration)
+{
+  phase_times_[phase].add(duration);
+}
+
+DurationHistogram::Buckets
+TopicStatistics::get_phase_buckets(Phase phase) const
+{
+  return phase_times_[phase].get_buckets();
+}
+
+namespace
+{
+
+std::mutex g_registry_mutex;
+std::list<std::weak_ptr<TopicStatistics>> g_registry;
+
+}  // namespace
+
+std::shared_ptr<TopicStatistics>
+register_topic_statistics(
+  const std::string & direction, const std::string & topic_name, const std::string & type_name,
+  const std::string & domain)
+{
+  auto statistics = std::make_shared<TopicStatistics>(direction, topic_name, type_name, domain);
+  record_flight_bridge_created(statistics.get(), 0, direction, topic_name, type_name);
+  std::lock_guard<std::mutex> lock(g_registry_mutex);
+  g_registry.push_back(statistics);
+  return statistics;
+}
+
+std::vector<std::shared_ptr<TopicStatistics>>
+get_registered_topic_statistics()
+{
+  std::vector<std::shared_ptr<TopicStatistics>> all_statistics;
+  std::lock_guard<std::mutex> lock(g_registry_mutex);
+  for (auto it = g_registry.begin(); it != g_registry.end(); ) {
+    auto statistics = it->lock();
+    if (!statistics) {
+      // the bridge has been removed
+      it = g_registry.erase(it);
+      continue;
+    }
+    all_statistics.push_back(statistics);
+    ++it;
+  }
+  return all_statistics;
+}
+
+std::vector<TopicStatistics::Snapshot>
+get_all_topic_statistics()
+{
+  std::vector<TopicStatistics::Snapshot> snapshots;
+  for (const auto & statistics : get_registered_topic_statistics()) {
+    snapshots.push_back(statistics->get_snapshot());
+  }
+  return snapshots;
+}
+
+std::string
+get_statistics_name(const TopicStatistics::Snapshot & snapshot)
+{
+  if (snapshot.domain.empty()) {
+    return snapshot.topic_name;
+  }
+  return snapshot.topic_name + " (domain " + snapshot.domain + ")";
+}
+
+}  // namespace ros1_bridge
@@ -0,0 +1,209 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ros1_bridge/traffic_recorder.hpp"
+
+namespace ros1_bridge
+{
+
+namespace
+{
+
+struct RecordedTopic
+{
+  std::string direction;
+  std::string topic_name;
+  std::string ros1_type_name;
+  std::string ros2_type_name;
+};
+
+std::atomic<bool> g_recording(false);
+
+// the records are written while holding the lock, so they are in the order of their times
+std::mutex g_mutex;
+FILE * g_file = nullptr;
+bool g_payloads = false;
+std::chrono::steady_clock::time_point g_start;
+// the id of a topic is its index, bridges of the same topic which are created again get the
+// same id as long as the types are the same
+std::vector<RecordedTopic> g_topics;
+// the statistics of a removed bridge may be reused by a later one, so the names are compared
+std::map<const TopicStatistics *, uint32_t> g_topic_ids;
+
+struct TraceCloser
+{
+  ~TraceCloser()
+  {
+    stop_traffic_recording();
+  }
+} g_trace_closer;
+
+bool
+is_same_topic(const RecordedTopic & topic, const TopicStatistics * statistics)
+{
+  return topic.direction == statistics->get_direction() &&
+         topic.topic_name == statistics->get_topic_name();
+}
+
+/// Find the id of the topic of a bridge, which must be called while holding the lock.
+bool
+find_topic_id(const TopicStatistics * statistics, uint32_t & id)
+{
+  auto it = g_topic_ids.find(statistics);
+  if (it == g_topic_ids.end() || !is_same_topic(g_topics[it->second], statistics)) {
+    return false;
+  }
+  id = it->second;
+  return true;
+}
+
+template<typename T>
+void
+write_value(const T & value)
+{
+  fwrite(&value, sizeof(value), 1, g_file);
+}
+
+void
+write_string(const std::string & value)
+{
+  uint16_t length = static_cast<uint16_t>(value.size() < UINT16_MAX ? value.size() : UINT16_MAX);
+  write_value(length);
+  fwrite(value.data(), 1, length, g_file);
+}
+
+void
+write_payload(const std::vector<uint8_t> & payload)
+{
+  uint32_t length = static_cast<uint32_t>(payload.size());
+  write_value(length);
+  fwrite(payload.data(), 1, length, g_file);
+}
+
+}  // namespace
+
+void
+start_traffic_recording(const std::string & path, bool payloads)
+{
+  stop_traffic_recording();
+  std::lock_guard<std::mutex> lock(g_mutex);
+  g_file = fopen(path.c_str(), "wb");
+  if (!g_file) {
+    throw std::runtime_error("failed to open traffic trace '" + path + "'");
+  }
+  g_payloads = payloads;
+  g_start = std::chrono::steady_clock::now();
+  g_topics.clear();
+  g_topic_ids.clear();
+
+  fwrite(traffic_trace_magic, 1, sizeof(traffic_trace_magic), g_file);
+  uint64_t system_time = static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count());
+  write_value(system_time);
+  write_value(static_cast<uint8_t>(payloads ? 1 : 0));
+  g_recording.store(true, std::memory_order_relaxed);
+}
+
+void
+stop_traffic_recording()
+{
+  g_recording.store(false, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(g_mutex);
+  if (g_file) {
+    fclose(g_file);
+    g_file = nullptr;
+  }
+}
+
+bool
+is_traffic_recording()
+{
+  return g_recording.load(std::memory_order_relaxed);
+}
+
+bool
+is_traffic_payload_needed(const TopicStatistics * statistics)
+{
+  if (!is_traffic_recording()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(g_mutex);
+  uint32_t id;
+  return g_payloads || !find_topic_id(statistics, id);
+}
+
+void
+record_traffic(
+  const TopicStatistics * statistics, const std::string & ros1_type_name,
+  const std::string & ros2_type_name, uint32_t size, const std::vector<uint8_t> & payload)
+{
+  if (!is_traffic_recording()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(g_mutex);
+  if (!g_file) {
+    return;
+  }
+  uint64_t time = static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - g_start).count());
+
+  uint32_t id;
+  if (!find_topic_id(statistics, id)) {
+    RecordedTopic topic {
+      statistics->get_direction(), statistics->get_topic_name(), ros1_type_name, ros2_type_name};
+    id = static_cast<uint32_t>(g_topics.size());
+    for (uint32_t i = 0; i < g_topics.size(); ++i) {
+      const auto & other = g_topics[i];
+      if (
+        is_same_topic(other, statistics) && other.ros1_type_name == ros1_type_name &&
+        other.ros2_type_name == ros2_type_name)
+      {
+        id = i;
+        break;
+      }
+    }
+    if (id == g_topics.size()) {
+      g_topics.push_back(topic);
+      write_value(static_cast<uint8_t>(TrafficRecordKind::TOPIC));
+      write_value(id);
+      write_string(topic.direction);
+      write_string(topic.topic_name);
+      write_string(topic.ros1_type_name);
+      write_string(topic.ros2_type_name);
+      write_payload(payload);
+    }
+    g_topic_ids[statistics] = id;
+  }
+
+  write_value(static_cast<uint8_t>(TrafficRecordKind::MESSAGE));
+  write_value(id);
+  write_value(time);
+  write_value(size);
+  if (g_payloads) {
+    write_payload(payload);
+  }
+}
+
+}  // namespace ros1_bridge
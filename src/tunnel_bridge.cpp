@@ -0,0 +1,464 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "ros/ros.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+#include "ros/subscription_callback_helper.h"
+#include "ros/this_node.h"
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+#include "std_msgs/msg/u_int8_multi_array.hpp"
+
+#include "ros1_bridge/command_options.hpp"
+
+
+// Tunneled messages are carried as the data of a std_msgs/UInt8MultiArray.
+// The envelope consists of the following little endian fields:
+//   uint32 version
+//   uint64 origin (random id of the sending tunnel endpoint)
+//   string topic, string datatype, string md5sum, string message_definition
+//   string payload (the ROS 1 serialized message without its length prefix)
+// where each string is a uint32 length followed by the bytes.
+// The message definition is only sent with the first message of a topic, after its type
+// changed and then at most every g_definition_period, otherwise it is empty.
+const uint32_t g_envelope_version = 2;
+
+// how often the message definition is repeated, so an endpoint which starts later learns it
+const std::chrono::seconds g_definition_period(1);
+
+struct TunnelMessage
+{
+  uint64_t origin;
+  std::string topic;
+  std::string datatype;
+  std::string md5sum;
+  std::string message_definition;
+  const uint8_t * payload;
+  uint32_t payload_length;
+};
+
+void write_uint(std::vector<uint8_t> & data, uint64_t value, size_t bytes)
+{
+  for (size_t i = 0; i < bytes; ++i) {
+    data.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+void write_bytes(std::vector<uint8_t> & data, const uint8_t * bytes, uint32_t length)
+{
+  write_uint(data, length, 4);
+  data.insert(data.end(), bytes, bytes + length);
+}
+
+void write_string(std::vector<uint8_t> & data, const std::string & value)
+{
+  write_bytes(
+    data, reinterpret_cast<const uint8_t *>(value.data()), static_cast<uint32_t>(value.size()));
+}
+
+bool read_uint(const std::vector<uint8_t> & data, size_t & offset, size_t bytes, uint64_t & value)
+{
+  if (offset + bytes > data.size()) {
+    return false;
+  }
+  value = 0;
+  for (size_t i = 0; i < bytes; ++i) {
+    value |= static_cast<uint64_t>(data[offset + i]) << (8 * i);
+  }
+  offset += bytes;
+  return true;
+}
+
+bool read_bytes(
+  const std::vector<uint8_t> & data, size_t & offset, const uint8_t *& bytes, uint32_t & length)
+{
+  uint64_t value;
+  if (!read_uint(data, offset, 4, value) || offset + value > data.size()) {
+    return false;
+  }
+  bytes = data.data() + offset;
+  length = static_cast<uint32_t>(value);
+  offset += length;
+  return true;
+}
+
+bool read_string(const std::vector<uint8_t> & data, size_t & offset, std::string & value)
+{
+  const uint8_t * bytes;
+  uint32_t length;
+  if (!read_bytes(data, offset, bytes, length)) {
+    return false;
+  }
+  value.assign(reinterpret_cast<const char *>(bytes), length);
+  return true;
+}
+
+void encode_envelope(const TunnelMessage & message, std::vector<uint8_t> & data)
+{
+  data.reserve(
+    28 + message.topic.size() + message.datatype.size() + message.md5sum.size() +
+    message.message_definition.size() + message.payload_length);
+  write_uint(data, g_envelope_version, 4);
+  write_uint(data, message.origin, 8);
+  write_string(data, message.topic);
+  write_string(data, message.datatype);
+  write_string(data, message.md5sum);
+  write_string(data, message.message_definition);
+  write_bytes(data, message.payload, message.payload_length);
+}
+
+bool decode_envelope(const std::vector<uint8_t> & data, TunnelMessage & message)
+{
+  size_t offset = 0;
+  uint64_t version;
+  if (!read_uint(data, offset, 4, version) || version != g_envelope_version) {
+    return false;
+  }
+  return
+    read_uint(data, offset, 8, message.origin) &&
+    read_string(data, offset, message.topic) &&
+    read_string(data, offset, message.datatype) &&
+    read_string(data, offset, message.md5sum) &&
+    read_string(data, offset, message.message_definition) &&
+    read_bytes(data, offset, message.payload, message.payload_length);
+}
+
+// A ROS 1 message which is kept in its serialized form
+struct RawMessage
+{
+  boost::shared_array<uint8_t> buffer;
+  uint32_t length;
+  boost::shared_ptr<ros::M_string> connection_header;
+};
+
+// Subscription helper which skips the deserialization and passes the raw bytes along
+class RawSubscriptionCallbackHelper : public ros::SubscriptionCallbackHelper
+{
+public:
+  typedef boost::function<void (const RawMessage &)> Callback;
+
+  explicit RawSubscriptionCallbackHelper(const Callback & callback)
+  : callback_(callback)
+  {}
+
+  ros::VoidConstPtr
+  deserialize(const ros::SubscriptionCallbackHelperDeserializeParams & params) override
+  {
+    boost::shared_ptr<RawMessage> message(new RawMessage);
+    message->buffer.reset(new uint8_t[params.length]);
+    std::memcpy(message->buffer.get(), params.buffer, params.length);
+    message->length = params.length;
+    message->connection_header = params.connection_header;
+    return message;
+  }
+
+  void
+  call(ros::SubscriptionCallbackHelperCallParams & params) override
+  {
+    callback_(*boost::static_pointer_cast<RawMessage const>(params.event.getMessage()));
+  }
+
+  const std::type_info &
+  getTypeInfo() override
+  {
+    return typeid(RawMessage);
+  }
+
+  bool
+  isConst() override
+  {
+    return true;
+  }
+
+  bool
+  hasHeader() override
+  {
+    return false;
+  }
+
+private:
+  Callback callback_;
+};
+
+std::string get_header_value(const ros::M_string & header, const std::string & key)
+{
+  auto it = header.find(key);
+  return it != header.end() ? it->second : std::string();
+}
+
+// Carries many ROS 1 topics in serialized form over a single ROS 2 topic
+// and republishes the topics of the remote endpoint in ROS 1.
+class TunnelEndpoint
+{
+public:
+  TunnelEndpoint(
+    ros::NodeHandle ros1_node, rclcpp::Node::SharedPtr ros2_node,
+    const std::string & tunnel_topic)
+  : ros1_node_(ros1_node),
+    ros2_node_(ros2_node)
+  {
+    std::random_device random_device;
+    origin_ = (static_cast<uint64_t>(random_device()) << 32) | random_device();
+
+    // many topics share the tunnel, therefore it is reliable with a deep queue
+    rmw_qos_profile_t qos_profile = rmw_qos_profile_default;
+    qos_profile.depth = 1000;
+    ros2_pub_ = ros2_node_->create_publisher<std_msgs::msg::UInt8MultiArray>(
+      tunnel_topic, qos_profile);
+    std::function<void(const std_msgs::msg::UInt8MultiArray::SharedPtr)> callback =
+      std::bind(&TunnelEndpoint::ros2_callback, this, std::placeholders::_1);
+    ros2_sub_ = ros2_node_->create_subscription<std_msgs::msg::UInt8MultiArray>(
+      tunnel_topic, callback, qos_profile);
+  }
+
+  void
+  add_ros1_topic(const std::string & topic_name, uint32_t queue_size)
+  {
+    ros::SubscribeOptions ops;
+    ops.topic = topic_name;
+    ops.queue_size = queue_size;
+    // accept any type, the actual type is taken from the connection header
+    ops.md5sum = "*";
+    ops.datatype = "*";
+    ops.helper = ros::SubscriptionCallbackHelperPtr(
+      new RawSubscriptionCallbackHelper(
+        boost::bind(&TunnelEndpoint::ros1_callback, this, topic_name, _1)));
+    ros1_subscribers_.push_back(ros1_node_.subscribe(ops));
+  }
+
+private:
+  struct TypedPublisher
+  {
+    std::string md5sum;
+    ros::Publisher publisher;
+  };
+
+  struct SentDefinition
+  {
+    std::string md5sum;
+    std::chrono::steady_clock::time_point time;
+  };
+
+  /// Check if the message definition has to be sent along with the message of a topic.
+  bool
+  is_definition_needed(const std::string & topic_name, const std::string & md5sum)
+  {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(sent_definitions_mutex_);
+    auto it = sent_definitions_.find(topic_name);
+    if (
+      it != sent_definitions_.end() && it->second.md5sum == md5sum &&
+      now - it->second.time < g_definition_period)
+    {
+      return false;
+    }
+    sent_definitions_[topic_name] = SentDefinition {md5sum, now};
+    return true;
+  }
+
+  void
+  ros1_callback(const std::string & topic_name, const RawMessage & raw_message)
+  {
+    if (!raw_message.connection_header) {
+      return;
+    }
+    const ros::M_string & header = *raw_message.connection_header;
+    // ignore messages republished by this endpoint
+    if (get_header_value(header, "callerid") == ros::this_node::getName()) {
+      return;
+    }
+
+    TunnelMessage message;
+    message.origin = origin_;
+    message.topic = topic_name;
+    message.datatype = get_header_value(header, "type");
+    message.md5sum = get_header_value(header, "md5sum");
+    if (is_definition_needed(topic_name, message.md5sum)) {
+      message.message_definition = get_header_value(header, "message_definition");
+    }
+    message.payload = raw_message.buffer.get();
+    message.payload_length = raw_message.length;
+
+    auto ros2_msg = std::make_shared<std_msgs::msg::UInt8MultiArray>();
+    encode_envelope(message, ros2_msg->data);
+    ros2_pub_->publish(ros2_msg);
+  }
+
+  void
+  ros2_callback(const std_msgs::msg::UInt8MultiArray::SharedPtr ros2_msg)
+  {
+    TunnelMessage message;
+    if (!decode_envelope(ros2_msg->data, message)) {
+      RCLCPP_WARN(ros2_node_->get_logger(), "Dropping malformed tunnel message");
+      return;
+    }
+    if (message.origin == origin_) {
+      return;
+    }
+
+    auto it = ros1_publishers_.find(message.topic);
+    if (it == ros1_publishers_.end() || it->second.md5sum != message.md5sum) {
+      if (message.message_definition.empty()) {
+        // wait for the definition, which is repeated periodically
+        return;
+      }
+      if (it != ros1_publishers_.end()) {
+        // ROS 1 refuses to advertise a topic again with another type while it is advertised
+        it->second.publisher.shutdown();
+        ros1_publishers_.erase(it);
+      }
+      ros::AdvertiseOptions ops(
+        message.topic, 10, message.md5sum, message.datatype, message.message_definition);
+      TypedPublisher publisher;
+      publisher.md5sum = message.md5sum;
+      publisher.publisher = ros1_node_.advertise(ops);
+      it = ros1_publishers_.insert(std::make_pair(message.topic, publisher)).first;
+      RCLCPP_INFO(
+        ros2_node_->get_logger(), "republishing tunneled topic '%s' with type '%s'",
+        message.topic.c_str(), message.datatype.c_str());
+    }
+
+    // the buffer is prefixed with the length like any ROS 1 serialized message
+    ros::SerializedMessage serialized;
+    serialized.num_bytes = message.payload_length + 4;
+    serialized.buf.reset(new uint8_t[serialized.num_bytes]);
+    std::memcpy(serialized.buf.get(), &message.payload_length, 4);
+    std::memcpy(serialized.buf.get() + 4, message.payload, message.payload_length);
+    serialized.message_start = serialized.buf.get() + 4;
+    it->second.publisher.publish(
+      boost::function<ros::SerializedMessage(void)>(
+        [serialized]() {return serialized;}), serialized);
+  }
+
+  ros::NodeHandle ros1_node_;
+  rclcpp::Node::SharedPtr ros2_node_;
+  uint64_t origin_;
+
+  rclcpp::Publisher<std_msgs::msg::UInt8MultiArray>::SharedPtr ros2_pub_;
+  rclcpp::SubscriptionBase::SharedPtr ros2_sub_;
+  std::list<ros::Subscriber> ros1_subscribers_;
+  std::map<std::string, TypedPublisher> ros1_publishers_;
+
+  std::mutex sent_definitions_mutex_;
+  std::map<std::string, SentDefinition> sent_definitions_;
+};
+
+using ros1_bridge::find_command_option;
+using ros1_bridge::get_command_option_value;
+
+bool parse_command_options(
+  int argc, char ** argv, std::string & node_name, std::string & tunnel_topic,
+  std::string & topics_parameter)
+{
+  std::vector<std::string> args(argv, argv + argc);
+
+  if (find_command_option(args, "-h") || find_command_option(args, "--help")) {
+    std::stringstream ss;
+    ss << "Usage:" << std::endl;
+    ss << " -h, --help: This message." << std::endl;
+    ss << " --node-name <name>: Name of the ROS 1 and ROS 2 node (default: ros_bridge_tunnel)";
+    ss << std::endl;
+    ss << " --tunnel-topic <name>: ROS 2 topic carrying the tunneled messages ";
+    ss << "(default: ros1_bridge_tunnel)" << std::endl;
+    ss << " --topics-parameter <name>: ROS 1 parameter holding the list of ROS 1 topics to send ";
+    ss << "through the tunnel (default: tunnel_topics)" << std::endl;
+    std::cout << ss.str();
+    return false;
+  }
+
+  node_name = get_command_option_value(args, "--node-name", "ros_bridge_tunnel");
+  tunnel_topic = get_command_option_value(args, "--tunnel-topic", "ros1_bridge_tunnel");
+  topics_parameter = get_command_option_value(args, "--topics-parameter", "tunnel_topics");
+  return true;
+}
+
+int main(int argc, char * argv[])
+{
+  std::string node_name;
+  std::string tunnel_topic;
+  std::string topics_parameter;
+  if (!parse_command_options(argc, argv, node_name, tunnel_topic, topics_parameter)) {
+    return 0;
+  }
+
+  // ROS 1 node
+  ros::init(argc, argv, node_name);
+  ros::NodeHandle ros1_node;
+
+  // ROS 2 node
+  rclcpp::init(argc, argv);
+  auto ros2_node = rclcpp::Node::make_shared(node_name);
+
+  TunnelEndpoint tunnel(ros1_node, ros2_node, tunnel_topic);
+
+  // send all topics listed in a ROS 1 parameter through the tunnel
+  // the parameter needs to be an array
+  // and each item needs to be a dictionary with the following keys;
+  // topic: the name of the topic to tunnel
+  // queue_size: the queue size to use (default: 10)
+  XmlRpc::XmlRpcValue topics;
+  if (
+    ros1_node.getParam(topics_parameter, topics) &&
+    topics.getType() == XmlRpc::XmlRpcValue::TypeArray)
+  {
+    for (size_t i = 0; i < static_cast<size_t>(topics.size()); ++i) {
+      std::string topic_name = static_cast<std::string>(topics[i]["topic"]);
+      int queue_size = 10;
+      if (topics[i].hasMember("queue_size")) {
+        queue_size = static_cast<int>(topics[i]["queue_size"]);
+      }
+      tunnel.add_ros1_topic(topic_name, queue_size);
+    }
+    printf(
+      "tunneling %d ROS 1 topics through the ROS 2 topic '%s'\n",
+      topics.size(), tunnel_topic.c_str());
+  } else {
+    printf(
+      "The parameter '%s' either doesn't exist or isn't an array, "
+      "only republishing topics from the remote endpoint\n", topics_parameter.c_str());
+  }
+
+  // ROS 1 asynchronous spinner
+  ros::AsyncSpinner async_spinner(1);
+  async_spinner.start();
+
+  // ROS 2 spinning loop
+  rclcpp::executors::SingleThreadedExecutor executor;
+  while (ros1_node.ok() && rclcpp::ok()) {
+    executor.spin_node_once(ros2_node, std::chrono::milliseconds(1000));
+  }
+
+  return 0;
+}
@@ -0,0 +1,297 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "diagnostic_msgs/DiagnosticArray.h"
+#include "ros/message_event.h"
+#include "std_msgs/Float64.h"
+#include "std_msgs/Header.h"
+#include "std_msgs/String.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+
+#include "diagnostic_msgs_factories.hpp"
+#include "std_msgs_factories.hpp"
+
+#include "ros1_bridge/allocation_accounting.hpp"
+#include "ros1_bridge/topic_statistics.hpp"
+
+// The callbacks of the bridge are driven with stand-in publishers, so only the allocations
+// of the bridge itself are measured and not the ones of the middlewares.
+// The budget of a message is one allocation for the message itself and one for every string
+// or array which doesn't fit into the message, i.e. the conversion must not allocate anything
+// beside the fields of the converted message.
+
+namespace
+{
+
+constexpr size_t warm_up_messages = 10;
+constexpr size_t measured_messages = 100;
+
+template<typename ROS2_T>
+class StandInRos2Publisher
+{
+public:
+  void publish(std::unique_ptr<ROS2_T> & msg)
+  {
+    msg.reset();
+    ++count;
+  }
+
+  void publish(const std::shared_ptr<const ROS2_T> &)
+  {
+    ++count;
+  }
+
+  size_t count = 0;
+};
+
+// keeps the last published message like a queue of the middleware would
+template<typename ROS2_T>
+class RetainingRos2Publisher
+{
+public:
+  void publish(std::unique_ptr<ROS2_T> & msg)
+  {
+    retained = std::move(msg);
+  }
+
+  void publish(const std::shared_ptr<const ROS2_T> &)
+  {
+  }
+
+  std::unique_ptr<ROS2_T> retained;
+};
+
+template<typename ROS1_T>
+class StandInRos1Publisher
+{
+public:
+  void publish(const boost::shared_ptr<ROS1_T> &) const
+  {
+    ++count;
+  }
+
+  mutable size_t count = 0;
+};
+
+template<typename ROS1_T, typename ROS2_T>
+class FactoryHarness : public ros1_bridge::Factory<ROS1_T, ROS2_T>
+{
+public:
+  using ros1_bridge::Factory<ROS1_T, ROS2_T>::ros1_callback_impl;
+  using ros1_bridge::Factory<ROS1_T, ROS2_T>::ros2_callback_impl;
+};
+
+// get the average allocations of the messages after the warm up, e.g. of one time logging
+template<typename SendT>
+double
+get_allocations_per_message(
+  const std::shared_ptr<ros1_bridge::TopicStatistics> & statistics, SendT send)
+{
+  for (size_t i = 0; i < warm_up_messages; ++i) {
+    send();
+  }
+  auto before = statistics->get_snapshot();
+  for (size_t i = 0; i < measured_messages; ++i) {
+    send();
+  }
+  auto after = statistics->get_snapshot();
+  EXPECT_EQ(measured_messages, after.messages - before.messages);
+  return static_cast<double>(after.allocations - before.allocations) / measured_messages;
+}
+
+template<typename ROS1_T, typename ROS2_T>
+void
+expect_allocation_budget_1_to_2(const ROS1_T & ros1_msg, size_t budget, size_t publisher_count)
+{
+  auto statistics = std::make_shared<ros1_bridge::TopicStatistics>("1to2", "/test", "test");
+  auto connection_header = boost::make_shared<ros::M_string>();
+  (*connection_header)["callerid"] = "/talker";
+  ros::MessageEvent<ROS1_T const> event(
+    boost::make_shared<ROS1_T const>(ros1_msg), connection_header, ros::Time());
+
+  std::vector<std::shared_ptr<StandInRos2Publisher<ROS2_T>>> ros2_pubs;
+  for (size_t i = 0; i < publisher_count; ++i) {
+    ros2_pubs.push_back(std::make_shared<StandInRos2Publisher<ROS2_T>>());
+  }
+  auto logger = rclcpp::get_logger("test_allocation_budget");
+  double allocations = get_allocations_per_message(
+    statistics, [&]() -> void
+    {
+      FactoryHarness<ROS1_T, ROS2_T>::ros1_callback_impl(
+        event, ros2_pubs, "ros1_type", "ros2_type", logger, statistics);
+    });
+  EXPECT_LE(allocations, budget);
+  for (const auto & ros2_pub : ros2_pubs) {
+    EXPECT_EQ(warm_up_messages + measured_messages, ros2_pub->count);
+  }
+}
+
+template<typename ROS1_T, typename ROS2_T>
+void
+expect_allocation_budget_2_to_1(const ROS2_T & ros2_msg, size_t budget)
+{
+  auto statistics = std::make_shared<ros1_bridge::TopicStatistics>("2to1", "/test", "test");
+  auto shared_ros2_msg = std::make_shared<ROS2_T>(ros2_msg);
+  rmw_message_info_t msg_info = {};
+  StandInRos1Publisher<ROS1_T> ros1_pub;
+
+  auto logger = rclcpp::get_logger("test_allocation_budget");
+  double allocations = get_allocations_per_message(
+    statistics, [&]() -> void
+    {
+      FactoryHarness<ROS1_T, ROS2_T>::ros2_callback_impl(
+        shared_ros2_msg, msg_info, ros1_pub, "ros1_type", "ros2_type", logger, nullptr,
+        statistics);
+    });
+  EXPECT_LE(allocations, budget);
+  EXPECT_EQ(warm_up_messages + measured_messages, ros1_pub.count);
+}
+
+// longer than the small string optimization of any standard library
+const std::string long_string(64, 'x');
+
+int64_t
+get_held_bytes(const std::string & direction, const std::string & topic_name)
+{
+  for (const auto & usage : ros1_bridge::get_memory_usage()) {
+    if (usage.direction == direction && usage.topic_name == topic_name) {
+      return usage.held_bytes;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+TEST(AllocationBudget, fixed_size_message)
+{
+  std_msgs::Float64 ros1_msg;
+  ros1_msg.data = 1.0;
+  expect_allocation_budget_1_to_2<std_msgs::Float64, std_msgs::msg::Float64>(ros1_msg, 1, 1);
+  std_msgs::msg::Float64 ros2_msg;
+  ros2_msg.data = 1.0;
+  expect_allocation_budget_2_to_1<std_msgs::Float64, std_msgs::msg::Float64>(ros2_msg, 1);
+}
+
+TEST(AllocationBudget, string_message)
+{
+  std_msgs::String ros1_msg;
+  ros1_msg.data = long_string;
+  expect_allocation_budget_1_to_2<std_msgs::String, std_msgs::msg::String>(ros1_msg, 2, 1);
+  std_msgs::msg::String ros2_msg;
+  ros2_msg.data = long_string;
+  expect_allocation_budget_2_to_1<std_msgs::String, std_msgs::msg::String>(ros2_msg, 2);
+}
+
+TEST(AllocationBudget, header_message)
+{
+  std_msgs::Header ros1_msg;
+  ros1_msg.stamp.sec = 1;
+  ros1_msg.frame_id = long_string;
+  expect_allocation_budget_1_to_2<std_msgs::Header, std_msgs::msg::Header>(ros1_msg, 2, 1);
+  std_msgs::msg::Header ros2_msg;
+  ros2_msg.stamp.sec = 1;
+  ros2_msg.frame_id = long_string;
+  expect_allocation_budget_2_to_1<std_msgs::Header, std_msgs::msg::Header>(ros2_msg, 2);
+}
+
+TEST(AllocationBudget, nested_array_message)
+{
+  // message, frame_id, status array, name, message, hardware_id, values array, 2 keys, 2 values
+  const size_t budget = 11;
+
+  diagnostic_msgs::DiagnosticArray ros1_msg;
+  ros1_msg.header.frame_id = long_string;
+  ros1_msg.status.resize(1);
+  ros1_msg.status[0].name = long_string;
+  ros1_msg.status[0].message = long_string;
+  ros1_msg.status[0].hardware_id = long_string;
+  ros1_msg.status[0].values.resize(2);
+  for (auto & value : ros1_msg.status[0].values) {
+    value.key = long_string;
+    value.value = long_string;
+  }
+  expect_allocation_budget_1_to_2<
+    diagnostic_msgs::DiagnosticArray, diagnostic_msgs::msg::DiagnosticArray>(ros1_msg, budget, 1);
+
+  diagnostic_msgs::msg::DiagnosticArray ros2_msg;
+  ros2_msg.header.frame_id = long_string;
+  ros2_msg.status.resize(1);
+  ros2_msg.status[0].name = long_string;
+  ros2_msg.status[0].message = long_string;
+  ros2_msg.status[0].hardware_id = long_string;
+  ros2_msg.status[0].values.resize(2);
+  for (auto & value : ros2_msg.status[0].values) {
+    value.key = long_string;
+    value.value = long_string;
+  }
+  expect_allocation_budget_2_to_1<
+    diagnostic_msgs::DiagnosticArray, diagnostic_msgs::msg::DiagnosticArray>(ros2_msg, budget);
+}
+
+TEST(AllocationBudget, fan_out)
+{
+  // the message is converted once and shared by all publishers
+  std_msgs::String ros1_msg;
+  ros1_msg.data = long_string;
+  expect_allocation_budget_1_to_2<std_msgs::String, std_msgs::msg::String>(ros1_msg, 2, 3);
+}
+
+TEST(MemoryAttribution, retained_message)
+{
+  // messages which outlive the callback stay attributed to the topic until they are freed
+  auto statistics = std::make_shared<ros1_bridge::TopicStatistics>("1to2", "/held", "test");
+  std_msgs::String ros1_msg;
+  ros1_msg.data = long_string;
+  ros::MessageEvent<std_msgs::String const> event(
+    boost::make_shared<std_msgs::String const>(ros1_msg),
+    boost::make_shared<ros::M_string>(), ros::Time());
+  std::vector<std::shared_ptr<RetainingRos2Publisher<std_msgs::msg::String>>> ros2_pubs {
+    std::make_shared<RetainingRos2Publisher<std_msgs::msg::String>>()};
+  auto logger = rclcpp::get_logger("test_allocation_budget");
+  auto send = [&]() -> void
+    {
+      FactoryHarness<std_msgs::String, std_msgs::msg::String>::ros1_callback_impl(
+        event, ros2_pubs, "ros1_type", "ros2_type", logger, statistics);
+    };
+
+  // the first message may allocate once for good, e.g. for logging
+  send();
+  ros2_pubs.front()->retained.reset();
+  int64_t baseline = get_held_bytes("1to2", "/held");
+
+  send();
+  EXPECT_GE(
+    get_held_bytes("1to2", "/held") - baseline,
+    static_cast<int64_t>(sizeof(std_msgs::msg::String) + long_string.size()));
+  ros2_pubs.front()->retained.reset();
+  EXPECT_EQ(baseline, get_held_bytes("1to2", "/held"));
+}
@@ -0,0 +1,157 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <boost/make_shared.hpp>
+
+// include ROS 1
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wunused-parameter"
+#endif
+#include "nodelet/nodelet.h"
+#include "ros/ros.h"
+#include "std_msgs/String.h"
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+// include ROS 2
+#include "rclcpp/rclcpp.hpp"
+#include "std_msgs/msg/string.hpp"
+
+#include "ros1_bridge/bridge_nodelet.hpp"
+
+// Host the bridge nodelet next to a publisher nodelet the way a nodelet manager does, so all
+// of them share the caller id of this process. The messages of the publisher nodelet must
+// reach ROS 2 and the messages from ROS 2 must reach ROS 1 without coming back to ROS 2.
+
+using namespace std::chrono_literals;
+
+const char * const topic_name = "/test_nodelet_loopback";
+
+class TalkerNodelet : public nodelet::Nodelet
+{
+private:
+  void onInit() override
+  {
+    publisher_ = getNodeHandle().advertise<std_msgs::String>(topic_name, 10);
+    timer_ = getNodeHandle().createWallTimer(
+      ros::WallDuration(0.1),
+      [this](const ros::WallTimerEvent &) -> void
+      {
+        // published as a shared pointer to be passed without serialization
+        auto msg = boost::make_shared<std_msgs::String>();
+        msg->data = "nodelet " + std::to_string(count_++);
+        publisher_.publish(msg);
+      });
+  }
+
+  ros::Publisher publisher_;
+  ros::WallTimer timer_;
+  size_t count_ = 0;
+};
+
+int main(int argc, char ** argv)
+{
+  ros::init(argc, argv, "test_nodelet_manager");
+  rclcpp::init(argc, argv);
+
+  XmlRpc::XmlRpcValue topics;
+  topics[0]["topic"] = topic_name;
+  topics[0]["type"] = "std_msgs/String";
+  topics[0]["queue_size"] = 10;
+  ros::param::set("/bridge/topics", topics);
+
+  // the manager passes messages between its nodelets on several threads
+  ros::AsyncSpinner ros1_spinner(2);
+  ros1_spinner.start();
+
+  ros1_bridge::BridgeNodelet bridge;
+  bridge.init("/bridge", ros::M_string(), ros::V_string());
+  TalkerNodelet talker;
+  talker.init("/talker", ros::M_string(), ros::V_string());
+
+  std::mutex received_mutex;
+  size_t ros1_received = 0;
+  std::map<std::string, size_t> ros2_received;
+
+  ros::NodeHandle ros1_node;
+  boost::function<void(const std_msgs::String::ConstPtr &)> ros1_callback =
+    [&received_mutex, &ros1_received](const std_msgs::String::ConstPtr & msg) -> void
+    {
+      if (msg->data.find("ros2 ") == 0) {
+        std::lock_guard<std::mutex> lock(received_mutex);
+        ++ros1_received;
+      }
+    };
+  auto ros1_sub = ros1_node.subscribe<std_msgs::String>(topic_name, 10, ros1_callback);
+
+  auto ros2_node = rclcpp::Node::make_shared("test_nodelet_loopback");
+  auto ros2_sub = ros2_node->create_subscription<std_msgs::msg::String>(
+    topic_name,
+    [&received_mutex, &ros2_received](const std_msgs::msg::String::SharedPtr msg) -> void
+    {
+      std::lock_guard<std::mutex> lock(received_mutex);
+      ++ros2_received[msg->data];
+    }, rmw_qos_profile_sensor_data);
+  // the bridge publishes and subscribes best effort
+  auto ros2_pub = ros2_node->create_publisher<std_msgs::msg::String>(
+    topic_name, rmw_qos_profile_sensor_data);
+  size_t ros2_count = 0;
+  auto ros2_timer = ros2_node->create_wall_timer(
+    100ms,
+    [&ros2_pub, &ros2_count]() -> void
+    {
+      auto msg = std::make_shared<std_msgs::msg::String>();
+      msg->data = "ros2 " + std::to_string(ros2_count++);
+      ros2_pub->publish(msg);
+    });
+
+  auto deadline = std::chrono::steady_clock::now() + 10s;
+  while (rclcpp::ok() && std::chrono::steady_clock::now() < deadline) {
+    rclcpp::spin_some(ros2_node);
+    std::this_thread::sleep_for(10ms);
+  }
+
+  std::lock_guard<std::mutex> lock(received_mutex);
+  size_t nodelet_received = 0;
+  for (const auto & received : ros2_received) {
+    if (received.second > 1) {
+      throw std::runtime_error(
+              "Received '" + received.first + "' " + std::to_string(received.second) +
+              " times in ROS 2, the bridge passed its own message back");
+    }
+    if (received.first.find("nodelet ") == 0) {
+      ++nodelet_received;
+    }
+  }
+  if (nodelet_received == 0) {
+    throw std::runtime_error("No message of the nodelet in the same manager reached ROS 2");
+  }
+  if (ros1_received == 0) {
+    throw std::runtime_error("No message from ROS 2 reached ROS 1");
+  }
+
+  ros1_spinner.stop();
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,191 @@
+// Copyright 2018 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ros1_bridge/topic_sharding.hpp"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr size_t name_count = 4000;
+
+std::vector<std::string>
+get_names()
+{
+  std::vector<std::string> names;
+  for (size_t i = 0; i < name_count; ++i) {
+    names.push_back("/topic_" + std::to_string(i));
+  }
+  return names;
+}
+
+std::vector<size_t>
+count_per_shard(const ros1_bridge::TopicSharding & sharding)
+{
+  std::vector<size_t> counts(sharding.get_shard_count(), 0);
+  for (const auto & name : get_names()) {
+    ++counts[sharding.get_shard(name)];
+  }
+  return counts;
+}
+
+// let every shard except the given ones miss the timeout
+void
+kill_other_shards(
+  ros1_bridge::TopicSharding & sharding, const std::set<size_t> & seen_shards,
+  std::chrono::steady_clock::duration timeout)
+{
+  std::this_thread::sleep_for(timeout + 10ms);
+  sharding.update_live_shards(seen_shards, timeout);
+}
+
+}  // namespace
+
+TEST(TopicSharding, rejects_invalid_index)
+{
+  EXPECT_THROW(ros1_bridge::TopicSharding(0, 0), std::runtime_error);
+  EXPECT_THROW(ros1_bridge::TopicSharding(2, 2), std::runtime_error);
+}
+
+TEST(TopicSharding, every_shard_agrees_on_a_balanced_assignment)
+{
+  const size_t shard_count = 4;
+  std::vector<std::unique_ptr<ros1_bridge::TopicSharding>> shards;
+  for (size_t i = 0; i < shard_count; ++i) {
+    shards.emplace_back(new ros1_bridge::TopicSharding(shard_count, i));
+  }
+
+  for (const auto & name : get_names()) {
+    size_t shard = shards.front()->get_shard(name);
+    size_t owners = 0;
+    for (const auto & sharding : shards) {
+      EXPECT_EQ(shard, sharding->get_shard(name)) << name;
+      owners += sharding->is_local(name) ? 1 : 0;
+    }
+    EXPECT_EQ(1u, owners) << name;
+  }
+
+  for (size_t count : count_per_shard(*shards.front())) {
+    EXPECT_NEAR(name_count / shard_count, count, name_count / shard_count / 5);
+  }
+}
+
+TEST(TopicSharding, hashing_respects_the_shard_weights)
+{
+  ros1_bridge::TopicSharding sharding(2, 0);
+  sharding.set_shard_weights({1.0, 3.0});
+
+  auto counts = count_per_shard(sharding);
+  EXPECT_NEAR(name_count / 4, counts[0], name_count / 20);
+  EXPECT_NEAR(name_count * 3 / 4, counts[1], name_count / 20);
+}
+
+TEST(TopicSharding, weighted_topics_are_balanced_by_capacity)
+{
+  ros1_bridge::TopicSharding sharding(2, 0);
+  sharding.set_shard_weights({1.0, 3.0});
+  std::map<std::string, double> topic_weights;
+  for (size_t i = 0; i < 8; ++i) {
+    topic_weights["/weighted_" + std::to_string(i)] = 10.0;
+  }
+  // heavier than all others together, so it fills the bigger shard alone
+  topic_weights["/camera"] = 60.0;
+  sharding.set_topic_weights(topic_weights);
+
+  std::vector<double> load(2, 0.0);
+  for (const auto & topic_weight : topic_weights) {
+    load[sharding.get_shard(topic_weight.first)] += topic_weight.second;
+  }
+  EXPECT_EQ(1u, sharding.get_shard("/camera"));
+  // the load per capacity differs by at most the weight of one topic
+  EXPECT_NEAR(load[0] / 1.0, load[1] / 3.0, 10.0);
+  EXPECT_DOUBLE_EQ(140.0, load[0] + load[1]);
+}
+
+TEST(TopicSharding, names_of_a_dead_shard_move_to_the_surviving_shards)
+{
+  const auto timeout = 50ms;
+  ros1_bridge::TopicSharding sharding(3, 0);
+  std::map<std::string, double> topic_weights;
+  for (size_t i = 0; i < 6; ++i) {
+    topic_weights["/weighted_" + std::to_string(i)] = 1.0;
+  }
+  sharding.set_topic_weights(topic_weights);
+
+  auto names = get_names();
+  for (const auto & topic_weight : topic_weights) {
+    names.push_back(topic_weight.first);
+  }
+  std::map<std::string, size_t> before;
+  for (const auto & name : names) {
+    before[name] = sharding.get_shard(name);
+  }
+
+  EXPECT_FALSE(sharding.update_live_shards({1, 2}, timeout));
+  kill_other_shards(sharding, {2}, timeout);
+  EXPECT_EQ(std::set<size_t>({0, 2}), sharding.get_live_shards());
+
+  size_t moved = 0;
+  for (const auto & name : names) {
+    size_t shard = sharding.get_shard(name);
+    if (before[name] == 1) {
+      EXPECT_NE(1u, shard) << name;
+      ++moved;
+    } else {
+      EXPECT_EQ(before[name], shard) << name;
+    }
+  }
+  EXPECT_GT(moved, 0u);
+}
+
+TEST(TopicSharding, a_recovering_shard_takes_its_names_back_after_the_timeout)
+{
+  const auto timeout = 100ms;
+  ros1_bridge::TopicSharding sharding(2, 0);
+  std::string name;
+  for (const auto & candidate : get_names()) {
+    if (sharding.get_shard(candidate) == 1) {
+      name = candidate;
+      break;
+    }
+  }
+  ASSERT_FALSE(name.empty());
+
+  // the other shard owns the name but isn't established right after the start
+  sharding.update_live_shards({1}, timeout);
+  EXPECT_FALSE(sharding.is_local(name));
+  EXPECT_FALSE(sharding.is_handed_over(name));
+
+  kill_other_shards(sharding, {}, timeout);
+  EXPECT_TRUE(sharding.is_local(name));
+
+  EXPECT_TRUE(sharding.update_live_shards({1}, timeout));
+  EXPECT_EQ(1u, sharding.get_shard(name));
+  // this shard keeps bridging the name until the recovered shard has been live for the timeout
+  EXPECT_FALSE(sharding.is_handed_over(name));
+  std::this_thread::sleep_for(timeout + 10ms);
+  sharding.update_live_shards({1}, timeout);
+  EXPECT_TRUE(sharding.is_handed_over(name));
+}